@@ -248,10 +248,7 @@ void Articulated_Vehicle::Update(double              time,
   m_steering->Update(time, 0.5 * steering);
 
   // Apply tire forces to spindle bodies.
-  m_suspensions[0]->ApplyTireForce(LEFT, tire_forces[FRONT_LEFT.id()]);
-  m_suspensions[0]->ApplyTireForce(RIGHT, tire_forces[FRONT_RIGHT.id()]);
-  m_suspensions[1]->ApplyTireForce(LEFT, tire_forces[REAR_LEFT.id()]);
-  m_suspensions[1]->ApplyTireForce(RIGHT, tire_forces[REAR_RIGHT.id()]);
+  ApplyTireForces(tire_forces);
 
   // Apply braking
   m_brakes[0]->ApplyBrakeModulation(braking);
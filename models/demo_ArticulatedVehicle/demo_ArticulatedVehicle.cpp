@@ -30,6 +30,7 @@
 #include "physics/ChLinkDistance.h"
 
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChVehicleSimulation.h"
 #include "subsys/terrain/RigidTerrain.h"
 #include "subsys/tire/ChPacejkaTire.h"
 
@@ -229,14 +230,16 @@ int main(int argc, char* argv[])
   vehicle.LogHardpointLocations();
 #endif
 
-  // Inter-module communication data
-  ChTireForces  tire_forces(4);
+  // Simulation driver (inter-module communication and module updates).
+  // The trailer is not managed by the simulation driver and is updated below.
+  ChVehicleSimulation sim(vehicle, driver, terrain, powertrain);
+  sim.SetTire(FRONT_LEFT, tire_front_left);
+  sim.SetTire(FRONT_RIGHT, tire_front_right);
+  sim.SetTire(REAR_LEFT, tire_rear_left);
+  sim.SetTire(REAR_RIGHT, tire_rear_right);
+
+  // Trailer inter-module communication data
   ChTireForces  tr_tire_forces(4);
-  ChWheelState  wheel_states[4];
-  double        driveshaft_speed;
-  double        powertrain_torque;
-  double        throttle_input;
-  double        steering_input;
   double        braking_input;
 
   // Number of simulation steps between two 3D view render frames
@@ -282,62 +285,25 @@ int main(int argc, char* argv[])
     }
 #endif
 
-    // Collect output data from modules (for inter-module communication)
-    throttle_input = driver.GetThrottle();
-    steering_input = driver.GetSteering();
+    // Collect trailer inputs (before the driver is updated)
     braking_input = driver.GetBraking();
 
-    powertrain_torque = powertrain.GetOutputTorque();
-
-    tire_forces[FRONT_LEFT.id()] = tire_front_left.GetTireForce();
-    tire_forces[FRONT_RIGHT.id()] = tire_front_right.GetTireForce();
-    tire_forces[REAR_LEFT.id()] = tire_rear_left.GetTireForce();
-    tire_forces[REAR_RIGHT.id()] = tire_rear_right.GetTireForce();
-
     tr_tire_forces[FRONT_LEFT.id()] = tr_tire_front_left.GetTireForce();
     tr_tire_forces[FRONT_RIGHT.id()] = tr_tire_front_right.GetTireForce();
     tr_tire_forces[REAR_LEFT.id()] = tr_tire_rear_left.GetTireForce();
     tr_tire_forces[REAR_RIGHT.id()] = tr_tire_rear_right.GetTireForce();
 
-    driveshaft_speed = vehicle.GetDriveshaftSpeed();
-
-    wheel_states[FRONT_LEFT.id()] = vehicle.GetWheelState(FRONT_LEFT);
-    wheel_states[FRONT_RIGHT.id()] = vehicle.GetWheelState(FRONT_RIGHT);
-    wheel_states[REAR_LEFT.id()] = vehicle.GetWheelState(REAR_LEFT);
-    wheel_states[REAR_RIGHT.id()] = vehicle.GetWheelState(REAR_RIGHT);
-
-    // Update modules (process inputs from other modules)
-    time = vehicle.GetSystem()->GetChTime();
-
-    driver.Update(time);
-
-    terrain.Update(time);
-
-    tire_front_left.Update(time, wheel_states[FRONT_LEFT.id()]);
-    tire_front_right.Update(time, wheel_states[FRONT_RIGHT.id()]);
-    tire_rear_left.Update(time, wheel_states[REAR_LEFT.id()]);
-    tire_rear_right.Update(time, wheel_states[REAR_RIGHT.id()]);
+    // Collect output data from modules and update all modules
+    sim.Update();
 
-    powertrain.Update(time, throttle_input, driveshaft_speed);
+    time = sim.GetTime();
 
-    vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
     trailer.Update(time, braking_input, tr_tire_forces);
 
     // Advance simulation for one timestep for all modules
     double step = realtime_timer.SuggestSimulationStep(step_size);
 
-    driver.Advance(step);
-
-    terrain.Advance(step);
-
-    tire_front_right.Advance(step);
-    tire_front_left.Advance(step);
-    tire_rear_right.Advance(step);
-    tire_rear_left.Advance(step);
-
-    powertrain.Advance(step);
-
-    vehicle.Advance(step);
+    sim.Advance(step);
 
     // Increment frame number
     step_number++;
@@ -374,54 +340,9 @@ int main(int argc, char* argv[])
       render_frame++;
     }
 
-    // Collect output data from modules (for inter-module communication)
-    throttle_input = driver.GetThrottle();
-    steering_input = driver.GetSteering();
-    braking_input = driver.GetBraking();
-
-    powertrain_torque = powertrain.GetOutputTorque();
-
-    tire_forces[FRONT_LEFT.id()] = tire_front_left.GetTireForce();
-    tire_forces[FRONT_RIGHT.id()] = tire_front_right.GetTireForce();
-    tire_forces[REAR_LEFT.id()] = tire_rear_left.GetTireForce();
-    tire_forces[REAR_RIGHT.id()] = tire_rear_right.GetTireForce();
-
-    driveshaft_speed = vehicle.GetDriveshaftSpeed();
-
-    wheel_states[FRONT_LEFT.id()] = vehicle.GetWheelState(FRONT_LEFT);
-    wheel_states[FRONT_RIGHT.id()] = vehicle.GetWheelState(FRONT_RIGHT);
-    wheel_states[REAR_LEFT.id()] = vehicle.GetWheelState(REAR_LEFT);
-    wheel_states[REAR_RIGHT.id()] = vehicle.GetWheelState(REAR_RIGHT);
-
-    // Update modules (process inputs from other modules)
-    time = vehicle.GetChTime();
-
-    driver.Update(time);
-
-    terrain.Update(time);
-
-    tire_front_left.Update(time, wheel_states[FRONT_LEFT.id()]);
-    tire_front_right.Update(time, wheel_states[FRONT_RIGHT.id()]);
-    tire_rear_left.Update(time, wheel_states[REAR_LEFT.id()]);
-    tire_rear_right.Update(time, wheel_states[REAR_RIGHT.id()]);
-
-    powertrain.Update(time, throttle_input, driveshaft_speed);
-
-    vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
-
-    // Advance simulation for one timestep for all modules
-    driver.Advance(step_size);
-
-    terrain.Advance(step_size);
-
-    tire_front_right.Advance(step_size);
-    tire_front_left.Advance(step_size);
-    tire_rear_right.Advance(step_size);
-    tire_rear_left.Advance(step_size);
-
-    powertrain.Advance(step_size);
-
-    vehicle.Advance(step_size);
+    // Update and advance simulation for one timestep for all modules
+    sim.Step(step_size);
+    time = sim.GetTime();
 
     // Increment frame number
     step_number++;
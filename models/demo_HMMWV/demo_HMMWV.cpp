@@ -31,6 +31,13 @@
 #include "physics/ChLinkDistance.h"
 
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChVehicleSimulation.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChPerfCounters.h"
+#include "subsys/ChTelemetryWriter.h"
+#include "subsys/ChSignalRegistry.h"
+#include "subsys/ChChannelLogger.h"
+#include "subsys/ChFlightRecorder.h"
 #include "subsys/terrain/RigidTerrain.h"
 #include "subsys/tire/ChPacejkaTire.h"
 
@@ -54,7 +61,8 @@
 # define USE_IRRLICHT
 #endif
 
-// DEBUGGING:  Uncomment the following line to print shock data
+// DEBUGGING:  Uncomment the following line to print shock data (with Irrlicht)
+// or to record the spring and shock channels to suspension.dat (without)
 //#define DEBUG_LOG
 
 using namespace chrono;
@@ -72,6 +80,9 @@ ChQuaternion<> initRot(1, 0, 0, 0);
 //ChQuaternion<> initRot(0.25882, 0, 0, 0.965926);
 //ChQuaternion<> initRot(0, 0, 0, 1);
 
+// Bring the vehicle to static equilibrium before starting the simulation
+bool settle = false;
+
 // Type of powertrain model (SHAFTS, SIMPLE)
 PowertrainModelType powertrain_model = SHAFTS;
 
@@ -100,6 +111,13 @@ double output_step_size = 1.0 / 1;    // once a second
 
   const std::string out_dir = "../HMMWV";
   const std::string pov_dir = out_dir + "/POVRAY";
+
+  // Optional output and diagnostics (all disabled by default)
+  bool use_telemetry = false;        // record driver inputs from a background thread
+  bool log_channels = false;         // stream selected vehicle channels to binary files
+  bool use_termination = false;      // stop early on rollover or when leaving the terrain
+  bool use_flight_recorder = false;  // dump the last 2 s of full-rate data on termination
+  bool write_profile = false;        // write profiling, tracing, and counter output (if enabled)
 #endif
 
 // =============================================================================
@@ -291,14 +309,15 @@ int main(int argc, char* argv[])
   vehicle.LogHardpointLocations();
 #endif
 
-  // Inter-module communication data
-  ChTireForces  tire_forces(4);
-  ChWheelState  wheel_states[4];
-  double        driveshaft_speed;
-  double        powertrain_torque;
-  double        throttle_input;
-  double        steering_input;
-  double        braking_input;
+  // Simulation driver (inter-module communication and module updates)
+  ChVehicleSimulation sim(vehicle, driver, terrain, powertrain);
+  sim.SetTire(FRONT_LEFT, tire_front_left);
+  sim.SetTire(FRONT_RIGHT, tire_front_right);
+  sim.SetTire(REAR_LEFT, tire_rear_left);
+  sim.SetTire(REAR_RIGHT, tire_rear_right);
+
+  if (settle)
+    sim.Settle();
 
   // Number of simulation steps between two 3D view render frames
   int render_steps = (int)std::ceil(render_step_size / step_size);
@@ -343,58 +362,17 @@ int main(int argc, char* argv[])
     }
 #endif
 
-    // Collect output data from modules (for inter-module communication)
-    throttle_input = driver.GetThrottle();
-    steering_input = driver.GetSteering();
-    braking_input = driver.GetBraking();
-
-    powertrain_torque = powertrain->GetOutputTorque();
-
-    tire_forces[FRONT_LEFT.id()] = tire_front_left->GetTireForce();
-    tire_forces[FRONT_RIGHT.id()] = tire_front_right->GetTireForce();
-    tire_forces[REAR_LEFT.id()] = tire_rear_left->GetTireForce();
-    tire_forces[REAR_RIGHT.id()] = tire_rear_right->GetTireForce();
-
-    driveshaft_speed = vehicle.GetDriveshaftSpeed();
-
-    wheel_states[FRONT_LEFT.id()] = vehicle.GetWheelState(FRONT_LEFT);
-    wheel_states[FRONT_RIGHT.id()] = vehicle.GetWheelState(FRONT_RIGHT);
-    wheel_states[REAR_LEFT.id()] = vehicle.GetWheelState(REAR_LEFT);
-    wheel_states[REAR_RIGHT.id()] = vehicle.GetWheelState(REAR_RIGHT);
-
-    // Update modules (process inputs from other modules)
-    time = vehicle.GetSystem()->GetChTime();
+    // Collect output data from modules and update all modules
+    sim.Update();
 
-    driver.Update(time);
+    time = sim.GetTime();
     if (step_number % output_steps == 0)
       driver.Log(time);
 
-    terrain.Update(time);
-
-    tire_front_left->Update(time, wheel_states[FRONT_LEFT.id()]);
-    tire_front_right->Update(time, wheel_states[FRONT_RIGHT.id()]);
-    tire_rear_left->Update(time, wheel_states[REAR_LEFT.id()]);
-    tire_rear_right->Update(time, wheel_states[REAR_RIGHT.id()]);
-
-    powertrain->Update(time, throttle_input, driveshaft_speed);
-
-    vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
-
     // Advance simulation for one timestep for all modules
     double step = realtime_timer.SuggestSimulationStep(step_size);
 
-    driver.Advance(step);
-
-    terrain.Advance(step);
-
-    tire_front_left->Advance(step);
-    tire_front_right->Advance(step);
-    tire_rear_right->Advance(step);
-    tire_rear_left->Advance(step);
-
-    powertrain->Advance(step);
-
-    vehicle.Advance(step);
+    sim.Advance(step);
 
     // Increment frame number
     step_number++;
@@ -417,13 +395,69 @@ int main(int argc, char* argv[])
 
   vehicle.ExportMeshPovray(out_dir);
 
+  // Record driver inputs (optionally from a background thread)
+  ChTelemetryWriter telemetry;
+  if (use_telemetry)
+    telemetry.Start();
+  driver.LogInit(out_dir + "/driver_inputs.out", use_telemetry ? &telemetry : NULL);
+
+  // Sample selected vehicle channels
+  bool debug_log = false;
+#ifdef DEBUG_LOG
+  debug_log = true;
+#endif
+
+  ChSignalRegistry signals;
+  if (log_channels || use_flight_recorder || debug_log)
+    signals.AddSimulationChannels(sim);
+
+  ChChannelLogger logger(signals);
+  if (log_channels) {
+    logger.AddChannels("chassis.", 100);
+    logger.AddChannels("tire", 100);
+    logger.AddChannels("powertrain.", 10);
+    logger.Open(out_dir + "/channels");
+  }
+
+  // Spring and shock channels at the output rate, written at the end of the run
+  ChChannelLogger susp_logger(signals);
+  if (debug_log) {
+    susp_logger.AddChannels("axle", 1 / output_step_size);
+    susp_logger.Reserve(tend, step_size);
+  }
+
+  // Keep the last 2 s of full-rate data, written only if the run is terminated
+  ChFlightRecorder recorder(signals);
+  if (use_flight_recorder) {
+    recorder.AddChannels("chassis.");
+    recorder.AddChannels("tire");
+    recorder.AddChannels("driver.");
+    recorder.SetOutputPrefix(out_dir + "/event");
+    if (!recorder.Initialize(2.0, 0.5, step_size))
+      use_flight_recorder = false;
+  }
+
   char filename[100];
 
+#if PROFILING_ENABLED
+  if (write_profile) {
+    ChTracer::GetInstance().Enable();
+    ChPerfCounters::GetInstance().Enable();
+  }
+#endif
+
+  // Stop early if the vehicle rolls over or leaves the terrain
+  ChVehicleTermination termination;
+  termination.SetRollLimit(CH_C_PI / 3);
+  termination.SetPitchLimit(CH_C_PI / 3);
+  termination.SetTerrainSize(terrainLength, terrainWidth);
+
   while (time < tend)
   {
     if (step_number % render_steps == 0) {
       // Output render data
       sprintf(filename, "%s/data_%03d.dat", pov_dir.c_str(), render_frame + 1);
+      CH_PROFILE_SCOPE("Output::Povray");
       utils::WriteShapesPovray(vehicle.GetSystem(), filename);
       std::cout << "Output frame:   " << render_frame << std::endl;
       std::cout << "Sim frame:      " << step_number << std::endl;
@@ -433,66 +467,52 @@ int main(int argc, char* argv[])
       render_frame++;
     }
 
-#ifdef DEBUG_LOG
-    if (step_number % output_steps == 0) {
-      GetLog() << "\n\n============ System Information ============\n";
-      GetLog() << "Time = " << time << "\n\n";
-      vehicle.DebugLog(DBG_SHOCKS);
-    }
-#endif
-
-    // Collect output data from modules (for inter-module communication)
-    throttle_input = driver.GetThrottle();
-    steering_input = driver.GetSteering();
-    braking_input = driver.GetBraking();
-
-    powertrain_torque = powertrain->GetOutputTorque();
-
-    tire_forces[FRONT_LEFT.id()] = tire_front_left->GetTireForce();
-    tire_forces[FRONT_RIGHT.id()] = tire_front_right->GetTireForce();
-    tire_forces[REAR_LEFT.id()] = tire_rear_left->GetTireForce();
-    tire_forces[REAR_RIGHT.id()] = tire_rear_right->GetTireForce();
-
-    driveshaft_speed = vehicle.GetDriveshaftSpeed();
-
-    wheel_states[FRONT_LEFT.id()] = vehicle.GetWheelState(FRONT_LEFT);
-    wheel_states[FRONT_RIGHT.id()] = vehicle.GetWheelState(FRONT_RIGHT);
-    wheel_states[REAR_LEFT.id()] = vehicle.GetWheelState(REAR_LEFT);
-    wheel_states[REAR_RIGHT.id()] = vehicle.GetWheelState(REAR_RIGHT);
-
-    // Update modules (process inputs from other modules)
-    time = vehicle.GetSystem()->GetChTime();
-
-    driver.Update(time);
-
-    terrain.Update(time);
+    // Update and advance simulation for one timestep for all modules
+    sim.Step(step_size);
+    time = sim.GetTime();
 
-    tire_front_left->Update(time, wheel_states[FRONT_LEFT.id()]);
-    tire_front_right->Update(time, wheel_states[FRONT_RIGHT.id()]);
-    tire_rear_left->Update(time, wheel_states[REAR_LEFT.id()]);
-    tire_rear_right->Update(time, wheel_states[REAR_RIGHT.id()]);
-
-    powertrain->Update(time, throttle_input, driveshaft_speed);
-
-    vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
-
-    // Advance simulation for one timestep for all modules
-    driver.Advance(step_size);
-
-    terrain.Advance(step_size);
+    if (step_number % output_steps == 0)
+      driver.Log(time);
+    if (log_channels)
+      logger.Sample(time);
+    if (debug_log)
+      susp_logger.Sample(time);
+    if (use_flight_recorder)
+      recorder.Record(time);
 
-    tire_front_right->Advance(step_size);
-    tire_front_left->Advance(step_size);
-    tire_rear_right->Advance(step_size);
-    tire_rear_left->Advance(step_size);
+    // Increment frame number
+    step_number++;
 
-    powertrain->Advance(step_size);
+    if (use_termination && termination.Check(vehicle, time) != ChVehicleTermination::NONE) {
+      if (use_flight_recorder)
+        recorder.Fire(time, ChVehicleTermination::GetReasonName(termination.GetReason()));
+      std::cout << "Simulation stopped at t = " << time << " (" << ChVehicleTermination::GetReasonName(termination.GetReason()) << ")" << std::endl;
+      break;
+    }
+  }
 
-    vehicle.Advance(step_size);
+  if (use_telemetry) {
+    telemetry.Stop();
+    telemetry.LogStats();
+  }
 
-    // Increment frame number
-    step_number++;
+  if (log_channels)
+    logger.Close();
+  if (debug_log)
+    susp_logger.Write(out_dir + "/suspension.dat");
+  if (use_flight_recorder)
+    recorder.Finalize();
+
+#if PROFILING_ENABLED
+  if (write_profile) {
+    ChProfiler::GetInstance().LogSummary();
+    ChProfiler::GetInstance().WriteCSV(out_dir + "/profile.csv");
+    ChProfiler::GetInstance().WriteJSON(out_dir + "/profile.json");
+    ChTracer::GetInstance().WriteChromeTrace(out_dir + "/trace.json");
+    ChPerfCounters::GetInstance().LogSummary();
+    ChPerfCounters::GetInstance().WriteCSV(out_dir + "/counters.csv");
   }
+#endif
 
 #endif
 
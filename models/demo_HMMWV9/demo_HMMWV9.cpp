@@ -31,6 +31,8 @@
 #include "physics/ChLinkDistance.h"
 
 #include "subsys/ChVehicleModelData.h"
+#include "subsys/ChVehicleSimulation.h"
+#include "subsys/ChTelemetryWriter.h"
 #include "subsys/terrain/RigidTerrain.h"
 #include "subsys/tire/ChPacejkaTire.h"
 
@@ -104,6 +106,7 @@ double pac_step_size = step_size;
 std::string pac_ofilename_base = "test_HMMWV9_pacTire";
 double pac_out_step_size = 0.01;
 int pac_out_steps = (int)std::ceil(pac_out_step_size / step_size);
+bool pac_use_telemetry = false;   // write the tire data from a background thread
 
 // =============================================================================
 
@@ -158,6 +161,9 @@ int main(int argc, char* argv[])
   ChSharedPtr<ChTire> tire_rear_right;
   ChSharedPtr<ChTire> tire_rear_left;
 
+  // Asynchronous writer for the Pacejka tire data (if pac_use_telemetry)
+  ChTelemetryWriter pac_telemetry;
+
   switch (tire_model) {
   case RIGID:
   {
@@ -216,6 +222,14 @@ int main(int argc, char* argv[])
     tire_RL->SetStepsize(pac_step_size);
     tire_RR->SetStepsize(pac_step_size);
 
+    if (save_pactire_data && pac_use_telemetry) {
+      pac_telemetry.Start();
+      tire_FL->SetTelemetryWriter(&pac_telemetry);
+      tire_FR->SetTelemetryWriter(&pac_telemetry);
+      tire_RL->SetTelemetryWriter(&pac_telemetry);
+      tire_RR->SetTelemetryWriter(&pac_telemetry);
+    }
+
     tire_front_left = tire_FL;
     tire_front_right = tire_FR;
     tire_rear_left = tire_RL;
@@ -291,17 +305,12 @@ int main(int argc, char* argv[])
   // Simulation loop
   // ---------------
 
-  // Inter-module communication data
-  ChTireForces  tire_forces(4);
-  ChWheelState  wheel_states[4];
-  double        driveshaft_speed;
-  double        powertrain_torque;
-  double        throttle_input;
-  double        steering_input;
-  double        braking_input;
-
-  // DEBUGGING
-  ChTireForces pac_forces(4);
+  // Simulation driver (inter-module communication and module updates)
+  ChVehicleSimulation sim(vehicle, driver, terrain, powertrain);
+  sim.SetTire(FRONT_LEFT, tire_front_left);
+  sim.SetTire(FRONT_RIGHT, tire_front_right);
+  sim.SetTire(REAR_LEFT, tire_rear_left);
+  sim.SetTire(REAR_RIGHT, tire_rear_right);
 
   // Number of simulation steps between two 3D view render frames
   int render_steps = (int)std::ceil(render_step_size / step_size);
@@ -340,52 +349,15 @@ int main(int argc, char* argv[])
       application.GetVideoDriver()->endScene();
     }
 
-    // Collect output data from modules (for inter-module communication)
-    throttle_input = driver.GetThrottle();
-    steering_input = driver.GetSteering();
-    braking_input = driver.GetBraking();
-
-    powertrain_torque = powertrain->GetOutputTorque();
-
-    tire_forces[FRONT_LEFT.id()] = tire_front_left->GetTireForce();
-    tire_forces[FRONT_RIGHT.id()] = tire_front_right->GetTireForce();
-    tire_forces[REAR_LEFT.id()] = tire_rear_left->GetTireForce();
-    tire_forces[REAR_RIGHT.id()] = tire_rear_right->GetTireForce();
-
-    driveshaft_speed = vehicle.GetDriveshaftSpeed();
-
-    wheel_states[FRONT_LEFT.id()] = vehicle.GetWheelState(FRONT_LEFT);
-    wheel_states[FRONT_RIGHT.id()] = vehicle.GetWheelState(FRONT_RIGHT);
-    wheel_states[REAR_LEFT.id()] = vehicle.GetWheelState(REAR_LEFT);
-    wheel_states[REAR_RIGHT.id()] = vehicle.GetWheelState(REAR_RIGHT);
-
-    // Update modules (process inputs from other modules)
-    time = vehicle.GetSystem()->GetChTime();
+    // Collect output data from modules and update all modules
+    sim.Update();
 
-    driver.Update(time);
-
-    terrain.Update(time);
-
-    tire_front_left->Update(time, wheel_states[FRONT_LEFT.id()]);
-    tire_front_right->Update(time, wheel_states[FRONT_RIGHT.id()]);
-    tire_rear_left->Update(time, wheel_states[REAR_LEFT.id()]);
-    tire_rear_right->Update(time, wheel_states[REAR_RIGHT.id()]);
-
-    powertrain->Update(time, throttle_input, driveshaft_speed);
-
-    vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
+    time = sim.GetTime();
 
     // Advance simulation for one timestep for all modules
     double step = realtime_timer.SuggestSimulationStep(step_size);
 
-    driver.Advance(step);
-
-    terrain.Advance(step);
-
-    tire_front_left->Advance(step);
-    tire_front_right->Advance(step);
-    tire_rear_left->Advance(step);
-    tire_rear_right->Advance(step);
+    sim.Advance(step);
 
     // write output data if useing PACEJKA tire
     if(tire_model == PACEJKA && save_pactire_data && time > time_start_output)
@@ -398,10 +370,6 @@ int main(int argc, char* argv[])
       }
     }
 
-    powertrain->Advance(step);
-
-    vehicle.Advance(step);
-
     // Increment frame number, timer
     step_number++;
     step_time.stop();
@@ -422,6 +390,11 @@ int main(int argc, char* argv[])
 
   application.GetDevice()->drop();
 
+  if (pac_telemetry.IsRunning()) {
+    pac_telemetry.Stop();
+    pac_telemetry.LogStats();
+  }
+
 #else
 
   int render_frame = 0;
@@ -453,54 +426,9 @@ int main(int argc, char* argv[])
       render_frame++;
     }
 
-    // Collect output data from modules (for inter-module communication)
-    throttle_input = driver.GetThrottle();
-    steering_input = driver.GetSteering();
-    braking_input = driver.GetBraking();
-
-    powertrain_torque = powertrain->GetOutputTorque();
-
-    tire_forces[FRONT_LEFT.id()] = tire_front_left->GetTireForce();
-    tire_forces[FRONT_RIGHT.id()] = tire_front_right->GetTireForce();
-    tire_forces[REAR_LEFT.id()] = tire_rear_left->GetTireForce();
-    tire_forces[REAR_RIGHT.id()] = tire_rear_right->GetTireForce();
-
-    driveshaft_speed = vehicle.GetDriveshaftSpeed();
-
-    wheel_states[FRONT_LEFT.id()] = vehicle.GetWheelState(FRONT_LEFT);
-    wheel_states[FRONT_RIGHT.id()] = vehicle.GetWheelState(FRONT_RIGHT);
-    wheel_states[REAR_LEFT.id()] = vehicle.GetWheelState(REAR_LEFT);
-    wheel_states[REAR_RIGHT.id()] = vehicle.GetWheelState(REAR_RIGHT);
-
-    // Update modules (process inputs from other modules)
-    time = vehicle.GetSystem()->GetChTime();
-
-    driver.Update(time);
-
-    terrain.Update(time);
-
-    tire_front_left->Update(time, wheel_states[FRONT_LEFT.id()]);
-    tire_front_right->Update(time, wheel_states[FRONT_RIGHT.id()]);
-    tire_rear_left->Update(time, wheel_states[REAR_LEFT.id()]);
-    tire_rear_right->Update(time, wheel_states[REAR_RIGHT.id()]);
-
-    powertrain->Update(time, throttle_input, driveshaft_speed);
-
-    vehicle.Update(time, steering_input, braking_input, powertrain_torque, tire_forces);
-
-    // Advance simulation for one timestep for all modules
-    driver.Advance(step_size);
-
-    terrain.Advance(step_size);
-
-    tire_front_left->Advance(step_size);
-    tire_front_right->Advance(step_size);
-    tire_rear_right->Advance(step_size);
-    tire_rear_left->Advance(step_size);
-
-    powertrain->Advance(step_size);
-
-    vehicle.Advance(step_size);
+    // Update and advance simulation for one timestep for all modules
+    sim.Step(step_size);
+    time = sim.GetTime();
 
     // Increment frame number
     step_number++;
@@ -41,6 +41,7 @@
 #include "subsys/tire/RigidTire.h"
 #include "subsys/terrain/FlatTerrain.h"
 #include "subsys/driver/ChDataDriver.h"
+#include "subsys/ChTelemetryWriter.h"
 
 // Irrlicht includes
 #if IRRLICHT_ENABLED
@@ -66,6 +67,9 @@ double step_size = 0.001;
 double render_step_size = 1.0 / 50;   // Time interval between two render frames
 double output_step_size = 1.0 / 1;    // Time interval between two output frames
 
+// Write the test rig log from a background thread
+bool use_telemetry = false;
+
 #ifdef USE_IRRLICHT
   // Point on chassis tracked by the camera
   ChVector<> trackPoint(1.65, 0.0, 0);
@@ -103,7 +107,10 @@ int main(int argc, char* argv[])
   SuspensionTest tester(suspensionTest_file);
   tester.Initialize(ChCoordsys<>(initLoc, initRot));
   // tester.Save_DebugLog(DBG_SPRINGS | DBG_SHOCKS | DBG_CONSTRAINTS | DBG_SUSPENSIONTEST,"log_test_SuspensionTester.csv");
-  tester.Save_DebugLog(DBG_SUSPENSIONTEST,"log_test_SuspensionTester.csv");
+  ChTelemetryWriter telemetry;
+  if (use_telemetry)
+    telemetry.Start();
+  tester.Save_DebugLog(DBG_SUSPENSIONTEST,"log_test_SuspensionTester.csv", use_telemetry ? &telemetry : NULL);
 
   // Create and initialize two rigid wheels
   ChSharedPtr<ChTire> tire_front_right;
@@ -290,6 +297,11 @@ int main(int argc, char* argv[])
 
   application.GetDevice()->drop();
 
+  if (use_telemetry) {
+    telemetry.Stop();
+    telemetry.LogStats();
+  }
+
 #else
 
   int render_frame = 0;
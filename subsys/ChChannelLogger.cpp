@@ -0,0 +1,296 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Sampling logger for channels published in a ChSignalRegistry.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+#include "subsys/ChChannelLogger.h"
+
+#include "utils/ChUtilsTimeSeries.h"
+
+
+namespace chrono {
+
+
+// Tolerance used when comparing a time against the next sample time.
+static const double time_tol = 1e-10;
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChChannelLogger::ChChannelLogger(const ChSignalRegistry& registry)
+: m_registry(registry),
+  m_streaming(false)
+{
+}
+
+ChChannelLogger::~ChChannelLogger()
+{
+  Close();
+}
+
+
+// -----------------------------------------------------------------------------
+// Channels are grouped by sampling rate. Channels can only be added before
+// sampling starts, so that all columns of a group have the same length. As in
+// the registry, a channel can only be selected once.
+// -----------------------------------------------------------------------------
+bool ChChannelLogger::AddChannel(const std::string& name,
+                                 double             rate)
+{
+  if (m_streaming) {
+    GetLog() << "ChChannelLogger: channels must be added before opening the output files\n";
+    return false;
+  }
+
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    if (m_groups[g].count > 0) {
+      GetLog() << "ChChannelLogger: channels must be added before sampling\n";
+      return false;
+    }
+  }
+
+  int channel = m_registry.FindChannel(name);
+  if (channel < 0) {
+    GetLog() << "ChChannelLogger: unknown channel " << name.c_str() << "\n";
+    return false;
+  }
+
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    const std::vector<int>& channels = m_groups[g].channels;
+    if (std::find(channels.begin(), channels.end(), channel) != channels.end()) {
+      GetLog() << "ChChannelLogger: duplicate channel " << name.c_str() << "\n";
+      return false;
+    }
+  }
+
+  if (rate < 0)
+    rate = 0;
+
+  size_t g = 0;
+  for (; g < m_groups.size(); g++) {
+    if (m_groups[g].rate == rate)
+      break;
+  }
+
+  if (g == m_groups.size()) {
+    Group group;
+    group.rate = rate;
+    group.start_time = 0;
+    group.periods = 0;
+    group.next_time = -std::numeric_limits<double>::max();
+    group.count = 0;
+    group.writer = NULL;
+    m_groups.push_back(group);
+  }
+
+  Group& group = m_groups[g];
+  group.channels.push_back(channel);
+  group.columns.push_back(std::vector<double>());
+  group.columns.back().reserve(group.times.capacity());
+
+  return true;
+}
+
+int ChChannelLogger::AddChannels(const std::string& prefix,
+                                 double             rate)
+{
+  int count = 0;
+
+  for (int i = 0; i < m_registry.GetNumChannels(); i++) {
+    const std::string& name = m_registry.GetName(i);
+    if (name.compare(0, prefix.size(), prefix) == 0 && AddChannel(name, rate))
+      count++;
+  }
+
+  return count;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChChannelLogger::Reserve(double duration,
+                              double step)
+{
+  if (m_streaming)
+    return;
+
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    Group& group = m_groups[g];
+    double rate = (group.rate > 0) ? group.rate : 1 / step;
+    size_t n = (size_t)(duration * rate) + 2;
+
+    group.times.reserve(n);
+    for (size_t c = 0; c < group.columns.size(); c++)
+      group.columns[c].reserve(n);
+  }
+}
+
+void ChChannelLogger::Clear()
+{
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    Group& group = m_groups[g];
+    group.next_time = -std::numeric_limits<double>::max();
+    group.count = 0;
+    group.times.clear();
+    for (size_t c = 0; c < group.columns.size(); c++)
+      group.columns[c].clear();
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// The next sample time of a group is the time of the first sample plus an
+// integer number of sampling periods, so that it does not drift with the
+// integration step size or accumulate round-off. The same tolerance is used to
+// decide whether a sample is due and to advance the next sample time.
+// -----------------------------------------------------------------------------
+void ChChannelLogger::Sample(double time)
+{
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    Group& group = m_groups[g];
+
+    if (group.rate > 0) {
+      if (group.count == 0) {
+        group.start_time = time;
+        group.periods = 0;
+      } else if (time < group.next_time - time_tol) {
+        continue;
+      }
+      double period = 1 / group.rate;
+      do {
+        group.periods++;
+        group.next_time = group.start_time + group.periods * period;
+      } while (group.next_time <= time + time_tol);
+    }
+
+    group.count++;
+
+    if (group.writer) {
+      m_row[0] = time;
+      for (size_t c = 0; c < group.channels.size(); c++)
+        m_row[c + 1] = m_registry.Evaluate(group.channels[c]);
+      group.writer->AppendRow(&m_row[0]);
+      continue;
+    }
+
+    group.times.push_back(time);
+    for (size_t c = 0; c < group.channels.size(); c++)
+      group.columns[c].push_back(m_registry.Evaluate(group.channels[c]));
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// In streaming mode, each group has its own time-series file, with the time
+// as first channel. Samples already stored in memory are discarded.
+// -----------------------------------------------------------------------------
+bool ChChannelLogger::Open(const std::string& prefix,
+                           int                block_size)
+{
+  Close();
+  Clear();
+
+  size_t num_columns = 1;
+
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    Group& group = m_groups[g];
+
+    group.writer = new utils::ChTimeSeriesWriter(block_size);
+    group.writer->AddChannel("Time", "s");
+    for (size_t c = 0; c < group.channels.size(); c++) {
+      int channel = group.channels[c];
+      group.writer->AddChannel(m_registry.GetName(channel), m_registry.GetUnits(channel));
+    }
+
+    std::ostringstream filename;
+    filename << prefix << "_" << g << ".dat";
+    if (!group.writer->Open(filename.str())) {
+      GetLog() << "ChChannelLogger: cannot open " << filename.str().c_str() << "\n";
+      Close();
+      return false;
+    }
+
+    std::vector<double>().swap(group.times);
+    for (size_t c = 0; c < group.columns.size(); c++)
+      std::vector<double>().swap(group.columns[c]);
+
+    if (group.channels.size() + 1 > num_columns)
+      num_columns = group.channels.size() + 1;
+  }
+
+  m_row.resize(num_columns);
+  m_streaming = true;
+
+  return true;
+}
+
+void ChChannelLogger::Close()
+{
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    delete m_groups[g].writer;
+    m_groups[g].writer = NULL;
+  }
+
+  m_streaming = false;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChChannelLogger::Write(const std::string& filename) const
+{
+  if (m_streaming) {
+    GetLog() << "ChChannelLogger: Write() is not available in streaming mode\n";
+    return false;
+  }
+
+  std::ofstream ofile(filename.c_str(), std::ios::out);
+  if (!ofile)
+    return false;
+
+  ofile.precision(10);
+
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    const Group& group = m_groups[g];
+
+    ofile << "# group " << g << ": rate " << group.rate << " Hz, " << group.times.size() << " samples\n";
+
+    ofile << "Time[s]";
+    for (size_t c = 0; c < group.channels.size(); c++) {
+      int channel = group.channels[c];
+      ofile << "\t" << m_registry.GetName(channel) << "[" << m_registry.GetUnits(channel) << "]";
+    }
+    ofile << "\n";
+
+    for (size_t i = 0; i < group.times.size(); i++) {
+      ofile << group.times[i];
+      for (size_t c = 0; c < group.columns.size(); c++)
+        ofile << "\t" << group.columns[c][i];
+      ofile << "\n";
+    }
+
+    ofile << "\n";
+  }
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,130 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Sampling logger for channels published in a ChSignalRegistry.
+//
+// Each selected channel is sampled at its own rate. Channels with the same rate
+// form a group which shares a time column. A rate of zero means that the
+// channel is sampled at every call to Sample().
+//
+// By default, samples are stored in memory, one column per channel, so that no
+// formatting happens during the simulation; the columns are formatted only when
+// written to file with Write(). The output file contains one section per group:
+//   # group <k>: rate <r> Hz, <n> samples
+//   Time[s]  <channel>[<units>]  ...
+//   <n> rows
+//
+// Alternatively, Open() switches the logger to streaming mode, in which each
+// group is written to its own binary time-series file (see ChUtilsTimeSeries.h)
+// in blocks of fixed size, so that memory use does not grow with the length of
+// the simulation.
+//
+// =============================================================================
+
+#ifndef CH_CHANNEL_LOGGER_H
+#define CH_CHANNEL_LOGGER_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSignalRegistry.h"
+
+namespace chrono {
+
+namespace utils {
+class ChTimeSeriesWriter;
+}
+
+///
+/// Multi-rate logger of registry channels.
+///
+class CH_SUBSYS_API ChChannelLogger : public ChShared
+{
+public:
+
+  ChChannelLogger(const ChSignalRegistry& registry);
+  ~ChChannelLogger();
+
+  /// Select the channel with given name, to be sampled at the given rate (Hz).
+  /// Channels must be selected before the first call to Sample().
+  /// Return false if no such channel exists or if it is already selected
+  /// (at any rate).
+  bool AddChannel(const std::string& name, double rate = 0);
+
+  /// Select all channels whose names start with the given prefix.
+  /// Return the number of newly selected channels.
+  int AddChannels(const std::string& prefix, double rate = 0);
+
+  /// Preallocate storage for a run of given duration (in-memory mode only).
+  /// The step size is used for channels sampled at every call.
+  void Reserve(double duration, double step);
+
+  /// Switch to streaming mode. All channels must have been selected. For each
+  /// group k, the file "<prefix>_<k>.dat" is created and its samples are
+  /// appended in blocks of the given number of rows.
+  /// Return false if a file cannot be created.
+  bool Open(
+    const std::string& prefix,            ///< [in] prefix of the output file names
+    int                block_size = 1024  ///< [in] number of rows per block
+    );
+
+  /// Write all buffered samples and close the output files (streaming mode).
+  void Close();
+
+  /// Return true if the logger is in streaming mode.
+  bool IsStreaming() const { return m_streaming; }
+
+  /// Sample all channels which are due at the specified time.
+  void Sample(double time);
+
+  /// Discard all recorded samples (the channel selection is preserved).
+  void Clear();
+
+  /// Get the number of channel groups (distinct sampling rates).
+  int GetNumGroups() const { return (int)m_groups.size(); }
+
+  /// Get the number of samples recorded in the specified group.
+  int GetNumSamples(int group) const { return (int)m_groups[group].count; }
+
+  /// Write all recorded samples to the specified file (in-memory mode only).
+  bool Write(const std::string& filename) const;
+
+private:
+
+  struct Group {
+    double                             rate;       ///< sampling rate (0: every call)
+    double                             start_time; ///< time of the first sample
+    long                               periods;    ///< sampling periods elapsed since the first sample
+    double                             next_time;  ///< time of the next sample
+    long                               count;      ///< number of samples recorded
+    std::vector<int>                   channels;   ///< registry indices of the group channels
+    std::vector<double>                times;      ///< sample times
+    std::vector<std::vector<double> >  columns;    ///< one column of samples per channel
+    utils::ChTimeSeriesWriter*         writer;     ///< output file (streaming mode)
+  };
+
+  const ChSignalRegistry&  m_registry;  ///< source of the channels
+  std::vector<Group>       m_groups;    ///< channel groups, one per sampling rate
+  bool                     m_streaming; ///< streaming mode?
+  std::vector<double>      m_row;       ///< row buffer (streaming mode)
+};
+
+
+} // end namespace chrono
+
+
+#endif
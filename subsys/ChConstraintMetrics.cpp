@@ -0,0 +1,183 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Structured constraint violation metrics for a vehicle.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+#include "physics/ChLinkDistance.h"
+
+#include "subsys/ChConstraintMetrics.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Collect the joints of all suspension and steering subsystems. Whether a link
+// is a distance constraint is determined here, once, so that Update() does not
+// need any dynamic casts.
+// -----------------------------------------------------------------------------
+ChConstraintMetrics::ChConstraintMetrics(const ChVehicle& vehicle)
+: m_max(0),
+  m_max_group(-1),
+  m_threshold(0),
+  m_callback(NULL)
+{
+  std::vector<ChLink*> links;
+
+  for (int i = 0; i < vehicle.GetNumberAxles(); i++) {
+    std::ostringstream name;
+    name << "Axle " << i;
+
+    links.clear();
+    vehicle.GetSuspension(i)->GetConstraintLinks(LEFT, links);
+    AddGroup(name.str() + " LEFT suspension", links);
+
+    links.clear();
+    vehicle.GetSuspension(i)->GetConstraintLinks(RIGHT, links);
+    AddGroup(name.str() + " RIGHT suspension", links);
+  }
+
+  links.clear();
+  vehicle.GetSteering()->GetConstraintLinks(links);
+  AddGroup("Steering", links);
+
+  m_violations.resize(m_links.size(), 0.0);
+}
+
+void ChConstraintMetrics::AddGroup(const std::string&          name,
+                                   const std::vector<ChLink*>& links)
+{
+  GroupMetrics group;
+  group.name = name;
+  group.start = (int)m_links.size();
+  group.count = 0;
+  group.max = 0;
+  group.rms = 0;
+
+  for (size_t i = 0; i < links.size(); i++) {
+    if (!links[i])
+      continue;
+    m_links.push_back(links[i]);
+    m_distance.push_back(dynamic_cast<ChLinkDistance*>(links[i]) != NULL);
+    group.count++;
+  }
+
+  m_groups.push_back(group);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChConstraintMetrics::SetThreshold(double     threshold,
+                                       Callback*  callback)
+{
+  m_threshold = threshold;
+  m_callback = callback;
+}
+
+
+// -----------------------------------------------------------------------------
+// The violation of a joint is the 2-norm of its constraint residual vector.
+// For distance constraints, this is the deviation from the imposed distance.
+// -----------------------------------------------------------------------------
+double ChConstraintMetrics::EvaluateViolation(ChLink* link, bool distance)
+{
+  if (distance) {
+    ChLinkDistance* dist = static_cast<ChLinkDistance*>(link);
+    return std::abs(dist->GetCurrentDistance() - dist->GetImposedDistance());
+  }
+
+  ChMatrix<>* C = link->GetC();
+  if (!C)
+    return 0;
+
+  double sum = 0;
+  for (int i = 0; i < C->GetRows(); i++) {
+    double c = C->GetElement(i, 0);
+    sum += c * c;
+  }
+
+  return std::sqrt(sum);
+}
+
+double ChConstraintMetrics::Update(double time)
+{
+  int num_links = (int)m_links.size();
+
+  for (int i = 0; i < num_links; i++)
+    m_violations[i] = EvaluateViolation(m_links[i], m_distance[i]);
+
+  m_max = 0;
+  m_max_group = -1;
+
+  for (int g = 0; g < (int)m_groups.size(); g++) {
+    GroupMetrics& group = m_groups[g];
+    double max = 0;
+    double sum = 0;
+
+    for (int i = group.start; i < group.start + group.count; i++) {
+      max = std::max<>(max, m_violations[i]);
+      sum += m_violations[i] * m_violations[i];
+    }
+
+    group.max = max;
+    group.rms = (group.count > 0) ? std::sqrt(sum / group.count) : 0;
+
+    if (max > m_max || m_max_group < 0) {
+      m_max = max;
+      m_max_group = g;
+    }
+
+    if (m_callback && max > m_threshold)
+      m_callback->OnViolation(time, g, group);
+  }
+
+  return m_max;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChConstraintMetrics::GetViolations(double* out) const
+{
+  for (size_t i = 0; i < m_violations.size(); i++)
+    out[i] = m_violations[i];
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChConstraintMetrics::LogMetrics() const
+{
+  // Format the values locally, so that the number format of the global log is
+  // left unchanged.
+  char buffer[64];
+
+  GetLog() << "\n---- Constraint violation metrics\n\n";
+  for (size_t g = 0; g < m_groups.size(); g++) {
+    GetLog() << m_groups[g].name.c_str() << " (" << m_groups[g].count << " joints)\n";
+    sprintf(buffer, "   max: %16.4e   rms: %16.4e\n", m_groups[g].max, m_groups[g].rms);
+    GetLog() << buffer;
+  }
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,139 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Structured constraint violation metrics for a vehicle.
+//
+// The joints of all suspension and steering subsystems are collected once, at
+// construction. Each call to Update() evaluates the violation norm of every
+// joint into a preallocated array and aggregates the maximum and RMS values
+// per subsystem group (one group for each side of each axle suspension and
+// one for the steering mechanism). No memory is allocated and no output is
+// generated during Update(), so that it can be called at every step.
+//
+// Optionally, a callback is invoked for each group whose maximum violation
+// exceeds a user-specified threshold.
+//
+// =============================================================================
+
+#ifndef CH_CONSTRAINT_METRICS_H
+#define CH_CONSTRAINT_METRICS_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+#include "physics/ChLink.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+
+namespace chrono {
+
+///
+/// Per-joint and per-subsystem constraint violation metrics.
+///
+class CH_SUBSYS_API ChConstraintMetrics : public ChShared
+{
+public:
+
+  /// Aggregated violation metrics for a group of joints.
+  struct GroupMetrics {
+    std::string name;     ///< group name (e.g. "Axle 0 LEFT suspension")
+    int         start;    ///< index of the first joint of this group
+    int         count;    ///< number of joints in this group
+    double      max;      ///< largest joint violation norm in this group
+    double      rms;      ///< RMS of the joint violation norms in this group
+  };
+
+  /// Interface for threshold notifications.
+  class Callback {
+  public:
+    virtual ~Callback() {}
+
+    /// Called from Update() for each group with max violation above threshold.
+    virtual void OnViolation(
+      double              time,     ///< [in] current simulation time
+      int                 group,    ///< [in] group index
+      const GroupMetrics& metrics   ///< [in] metrics of the offending group
+      ) = 0;
+  };
+
+  /// Collect the joints of all suspension and steering subsystems.
+  /// The vehicle must have been initialized.
+  ChConstraintMetrics(const ChVehicle& vehicle);
+
+  ~ChConstraintMetrics() {}
+
+  /// Set a threshold on the per-group maximum violation and the callback
+  /// invoked when it is exceeded. A NULL callback disables notifications.
+  void SetThreshold(double threshold, Callback* callback);
+
+  /// Evaluate the violation norms of all joints and the group metrics.
+  /// Returns the largest violation over all joints.
+  double Update(double time);
+
+  /// Get the total number of monitored joints.
+  int GetNumJoints() const { return (int)m_links.size(); }
+
+  /// Get the violation norm of the specified joint (as of the last Update).
+  double GetViolation(int joint) const { return m_violations[joint]; }
+
+  /// Get the violation norms of all joints (as of the last Update).
+  const std::vector<double>& GetViolations() const { return m_violations; }
+
+  /// Copy the violation norms of all joints into the given array, which must
+  /// have room for at least GetNumJoints() values.
+  void GetViolations(double* out) const;
+
+  /// Get the number of joint groups.
+  int GetNumGroups() const { return (int)m_groups.size(); }
+
+  /// Get the metrics of the specified group (as of the last Update).
+  const GroupMetrics& GetGroup(int group) const { return m_groups[group]; }
+
+  /// Get the largest violation over all joints (as of the last Update).
+  double GetMaxViolation() const { return m_max; }
+
+  /// Get the index of the group containing the largest violation.
+  int GetMaxGroup() const { return m_max_group; }
+
+  /// Log the current group metrics.
+  void LogMetrics() const;
+
+  /// Evaluate the violation norm of a single joint: the 2-norm of its
+  /// constraint residual vector or, if 'distance' is true (the link must then
+  /// be a ChLinkDistance), the deviation from the imposed distance.
+  static double EvaluateViolation(ChLink* link, bool distance);
+
+private:
+
+  void AddGroup(const std::string& name, const std::vector<ChLink*>& links);
+
+  std::vector<ChLink*>        m_links;        ///< monitored joints
+  std::vector<bool>           m_distance;     ///< flags for distance constraints
+  std::vector<double>         m_violations;   ///< per-joint violation norms
+  std::vector<GroupMetrics>   m_groups;       ///< per-group metrics
+
+  double                      m_max;          ///< largest violation at last update
+  int                         m_max_group;    ///< group of the largest violation
+
+  double                      m_threshold;    ///< per-group notification threshold
+  Callback*                   m_callback;     ///< threshold callback (not owned)
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -24,6 +24,8 @@
 #include <fstream>
 
 #include "subsys/ChDriver.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChTelemetryWriter.h"
 
 
 namespace chrono {
@@ -35,16 +37,45 @@ ChDriver::ChDriver()
 : m_throttle(0),
   m_steering(0),
   m_braking(0),
-  m_log_filename("")
+  m_log_filename(""),
+  m_log_writer(NULL),
+  m_log_stream(-1)
 {
 }
 
+// -----------------------------------------------------------------------------
+// Snapshot and restore the current driver inputs.
+// -----------------------------------------------------------------------------
+void ChDriver::Snapshot(ChStateBuffer& buffer) const
+{
+  buffer.Write(m_throttle);
+  buffer.Write(m_steering);
+  buffer.Write(m_braking);
+}
+
+bool ChDriver::Restore(ChStateBuffer& buffer)
+{
+  return buffer.Read(m_throttle) &&
+         buffer.Read(m_steering) &&
+         buffer.Read(m_braking);
+}
+
 // -----------------------------------------------------------------------------
 // Initialize output file for recording deriver inputs.
 // -----------------------------------------------------------------------------
-bool ChDriver::LogInit(const std::string& filename)
+bool ChDriver::LogInit(const std::string& filename,
+                       ChTelemetryWriter* writer)
 {
   m_log_filename = filename;
+  m_log_writer = NULL;
+
+  if (writer) {
+    m_log_stream = writer->AddStream(filename, "Time\tSteering\tThrottle\tBraking");
+    if (m_log_stream < 0)
+      return false;
+    m_log_writer = writer;
+    return true;
+  }
 
   std::ofstream ofile(filename.c_str(), std::ios::out);
   if (!ofile)
@@ -64,6 +95,14 @@ bool ChDriver::Log(double time)
   if (m_log_filename.empty())
     return false;
 
+  CH_PROFILE_SCOPE("Output::DriverLog");
+
+  if (m_log_writer) {
+    double inputs[3] = { m_steering, m_throttle, m_braking };
+    m_log_writer->Push(m_log_stream, time, 3, inputs);
+    return true;
+  }
+
   std::ofstream ofile(m_log_filename.c_str(), std::ios::app);
   if (!ofile)
     return false;
@@ -26,9 +26,12 @@
 #include "physics/ChSystem.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChStateBuffer.h"
 
 namespace chrono {
 
+class ChTelemetryWriter;
+
 ///
 /// Base class for a vehicle driver system.
 /// A driver system must be able to report the current values of the inputs
@@ -57,8 +60,20 @@ public:
   /// Advance the state of this driver system by the specified time step.
   virtual void Advance(double step) {}
 
+  /// Append the state of this driver system (current inputs) to the buffer.
+  virtual void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the state of this driver system from the specified buffer.
+  /// Return false if the buffer does not contain a compatible state.
+  virtual bool Restore(ChStateBuffer& buffer);
+
   /// Initialize output file for recording driver inputs.
-  bool LogInit(const std::string& filename);
+  /// If a telemetry writer is specified, the driver inputs are recorded through
+  /// it (i.e., formatted and written in the background).
+  bool LogInit(
+    const std::string&  filename,        ///< [in] name of the output file
+    ChTelemetryWriter*  writer = NULL    ///< [in] optional asynchronous writer
+    );
 
   /// Record the current driver inputs to the log file.
   bool Log(double time);
@@ -81,7 +96,9 @@ protected:
   double m_braking;    ///< current value of braking input
 
 private:
-  std::string  m_log_filename;  // name of output file for recording driver inputs
+  std::string         m_log_filename;  // name of output file for recording driver inputs
+  ChTelemetryWriter*  m_log_writer;    // asynchronous writer for driver inputs (may be NULL)
+  int                 m_log_stream;    // stream identifier in m_log_writer
 
 };
 
@@ -0,0 +1,244 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Flight recorder for vehicle simulations.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "subsys/ChFlightRecorder.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChFlightRecorder::ChFlightRecorder(const ChSignalRegistry& registry)
+: m_registry(registry),
+  m_row_size(1),
+  m_capacity(0),
+  m_count(0),
+  m_pre_rows(0),
+  m_post_rows(0),
+  m_pending(false),
+  m_trigger_row(0),
+  m_trigger_time(0),
+  m_prefix("event"),
+  m_max_events(1),
+  m_num_events(0)
+{
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChFlightRecorder::AddChannel(const std::string& name)
+{
+  if (IsInitialized()) {
+    GetLog() << "ChFlightRecorder: cannot add channel " << name.c_str() << " after initialization\n";
+    return false;
+  }
+
+  int channel = m_registry.FindChannel(name);
+  if (channel < 0) {
+    GetLog() << "ChFlightRecorder: unknown channel " << name.c_str() << "\n";
+    return false;
+  }
+
+  m_channels.push_back(channel);
+  return true;
+}
+
+int ChFlightRecorder::AddChannels(const std::string& prefix)
+{
+  if (IsInitialized()) {
+    GetLog() << "ChFlightRecorder: cannot add channels " << prefix.c_str() << "* after initialization\n";
+    return 0;
+  }
+
+  int count = 0;
+
+  for (int i = 0; i < m_registry.GetNumChannels(); i++) {
+    const std::string& name = m_registry.GetName(i);
+    if (name.compare(0, prefix.size(), prefix) == 0 && AddChannel(name))
+      count++;
+  }
+
+  return count;
+}
+
+bool ChFlightRecorder::AddThreshold(const std::string& name,
+                                    double             limit)
+{
+  int channel = m_registry.FindChannel(name);
+
+  for (size_t i = 0; i < m_channels.size(); i++) {
+    if (m_channels[i] == channel) {
+      Threshold threshold;
+      threshold.column = (int)i + 1;
+      threshold.limit = limit;
+      m_thresholds.push_back(threshold);
+      return true;
+    }
+  }
+
+  GetLog() << "ChFlightRecorder: channel " << name.c_str() << " not selected\n";
+  return false;
+}
+
+
+// -----------------------------------------------------------------------------
+// The ring buffer holds the pre- and post-trigger windows, so that the data
+// preceding an event is not overwritten while the post-trigger data is being
+// recorded. The row size is fixed here, which is why no channels can be
+// selected afterwards.
+// -----------------------------------------------------------------------------
+bool ChFlightRecorder::Initialize(double pre_time,
+                                  double post_time,
+                                  double step)
+{
+  if (!(step > 0) || !(pre_time >= 0) || !(post_time >= 0)) {
+    GetLog() << "ChFlightRecorder: invalid windows (" << pre_time << ", " << post_time
+             << ") or step " << step << "\n";
+    return false;
+  }
+
+  m_pre_rows = (long)std::ceil(pre_time / step);
+  m_post_rows = (long)std::ceil(post_time / step);
+  m_row_size = 1 + (int)m_channels.size();
+  m_capacity = m_pre_rows + m_post_rows + 1;
+
+  m_ring.assign(m_capacity * m_row_size, 0.0);
+  m_count = 0;
+  m_pending = false;
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChFlightRecorder::Record(double time)
+{
+  if (m_capacity == 0)
+    return false;
+
+  double* row = &m_ring[(m_count % m_capacity) * m_row_size];
+  row[0] = time;
+  for (size_t i = 0; i < m_channels.size(); i++)
+    row[i + 1] = m_registry.Evaluate(m_channels[i]);
+  m_count++;
+
+  if (m_pending) {
+    if (m_count - 1 - m_trigger_row >= m_post_rows) {
+      Dump();
+      return true;
+    }
+    return false;
+  }
+
+  if (m_num_events >= m_max_events)
+    return false;
+
+  for (size_t i = 0; i < m_thresholds.size(); i++) {
+    double value = row[m_thresholds[i].column];
+    if (std::abs(value) > m_thresholds[i].limit) {
+      std::ostringstream description;
+      description << "|" << m_registry.GetName(m_channels[m_thresholds[i].column - 1])
+                  << "| = " << std::abs(value) << " > " << m_thresholds[i].limit;
+      Fire(time, description.str());
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < m_triggers.size() && !m_pending; i++) {
+    if (m_triggers[i]->Check(time))
+      Fire(time, m_triggers[i]->GetDescription());
+  }
+
+  if (m_pending && m_post_rows == 0) {
+    Dump();
+    return true;
+  }
+
+  return false;
+}
+
+void ChFlightRecorder::Fire(double             time,
+                            const std::string& description)
+{
+  if (m_pending || m_num_events >= m_max_events || m_count == 0)
+    return;
+
+  m_pending = true;
+  m_trigger_row = m_count - 1;
+  m_trigger_time = time;
+  m_description = description;
+}
+
+void ChFlightRecorder::Finalize()
+{
+  if (m_pending)
+    Dump();
+}
+
+
+// -----------------------------------------------------------------------------
+// Write the rows from the start of the pre-trigger window (or the oldest row
+// still in the buffer) up to the last recorded row.
+// -----------------------------------------------------------------------------
+void ChFlightRecorder::Dump()
+{
+  m_pending = false;
+  m_num_events++;
+
+  std::ostringstream filename;
+  filename << m_prefix << "_" << m_num_events << ".dat";
+
+  std::ofstream ofile(filename.str().c_str());
+  if (!ofile) {
+    GetLog() << "ChFlightRecorder: cannot open " << filename.str().c_str() << "\n";
+    return;
+  }
+
+  ofile.precision(10);
+
+  ofile << "# Event " << m_num_events << " at t = " << m_trigger_time << ": " << m_description << "\n";
+  ofile << "# Pre-trigger rows: " << m_pre_rows << ", post-trigger rows: " << m_post_rows << "\n";
+
+  ofile << "Time";
+  for (size_t i = 0; i < m_channels.size(); i++)
+    ofile << "\t" << m_registry.GetName(m_channels[i]);
+  ofile << "\n";
+
+  long first = std::max<>(m_trigger_row - m_pre_rows, std::max<>(m_count - m_capacity, 0L));
+
+  for (long r = first; r < m_count; r++) {
+    const double* row = &m_ring[(r % m_capacity) * m_row_size];
+    ofile << row[0];
+    for (int i = 1; i < m_row_size; i++)
+      ofile << "\t" << row[i];
+    ofile << "\n";
+  }
+
+  GetLog() << "ChFlightRecorder: event written to " << filename.str().c_str() << "\n";
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,153 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Flight recorder for vehicle simulations.
+//
+// Selected channels of a ChSignalRegistry are recorded at every step into a
+// preallocated ring buffer holding the last few seconds of data. Nothing is
+// written to disk unless an event is triggered, either by one of the threshold
+// triggers (absolute value of a recorded channel above a limit), by a user
+// trigger object, or explicitly through Fire(). The data in a window around
+// the event (pre- and post-trigger) is then written to a file.
+//
+// The output files are TAB-delimited, with two comment lines followed by the
+// column headers, so that they can be read with utils::ChValidation.
+//
+// =============================================================================
+
+#ifndef CH_FLIGHT_RECORDER_H
+#define CH_FLIGHT_RECORDER_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSignalRegistry.h"
+
+namespace chrono {
+
+///
+/// Event-triggered recorder of full-rate channel data.
+///
+class CH_SUBSYS_API ChFlightRecorder : public ChShared
+{
+public:
+
+  /// Interface for a user-defined trigger predicate.
+  class Trigger {
+  public:
+    virtual ~Trigger() {}
+
+    /// Return true if an event occurred at the specified time.
+    virtual bool Check(double time) = 0;
+
+    /// Return a short description of the event.
+    virtual std::string GetDescription() const = 0;
+  };
+
+  ChFlightRecorder(const ChSignalRegistry& registry);
+  ~ChFlightRecorder() {}
+
+  /// Select the channel with given name. Return false if no such channel
+  /// exists or if the recorder was already initialized.
+  bool AddChannel(const std::string& name);
+
+  /// Select all channels whose names start with the given prefix.
+  /// Return the number of selected channels (0 if the recorder was already
+  /// initialized).
+  int AddChannels(const std::string& prefix);
+
+  /// Add a trigger on the absolute value of a selected channel.
+  /// Return false if the channel was not selected.
+  bool AddThreshold(const std::string& name, double limit);
+
+  /// Add a user-defined trigger (not owned by the recorder).
+  void AddTrigger(Trigger* trigger) { m_triggers.push_back(trigger); }
+
+  /// Set the prefix of the output files (default "event").
+  /// The k-th event is written to "<prefix>_<k>.dat".
+  void SetOutputPrefix(const std::string& prefix) { m_prefix = prefix; }
+
+  /// Set the maximum number of events written to disk (default 1).
+  void SetMaxEvents(int num) { m_max_events = num; }
+
+  /// Allocate the ring buffer. This must be called after selecting channels
+  /// and before recording; the channel selection is fixed afterwards.
+  /// Return false (and leave the recorder uninitialized) if the recording
+  /// interval is not positive or a window length is negative.
+  bool Initialize(
+    double pre_time,    ///< [in] length of the pre-trigger window
+    double post_time,   ///< [in] length of the post-trigger window
+    double step         ///< [in] (nominal) recording interval
+    );
+
+  /// Record all selected channels at the specified time and check triggers.
+  /// Return true if an event was written to disk during this call.
+  bool Record(double time);
+
+  /// Trigger an event at the specified time (typically, the last recorded
+  /// time). The event is written once the post-trigger window is recorded.
+  void Fire(double time, const std::string& description);
+
+  /// Write any pending event, using whatever post-trigger data is available.
+  /// This should be called at the end of the simulation.
+  void Finalize();
+
+  /// Return true if the ring buffer was allocated.
+  bool IsInitialized() const { return m_capacity > 0; }
+
+  /// Return true if an event was triggered and is not yet written.
+  bool IsPending() const { return m_pending; }
+
+  /// Get the number of events written to disk.
+  int GetNumEvents() const { return m_num_events; }
+
+private:
+
+  void Dump();
+
+  struct Threshold {
+    int     column;
+    double  limit;
+  };
+
+  const ChSignalRegistry&  m_registry;     ///< source of the channels
+  std::vector<int>         m_channels;     ///< registry indices of the selected channels
+  std::vector<Threshold>   m_thresholds;   ///< threshold triggers
+  std::vector<Trigger*>    m_triggers;     ///< user triggers
+
+  std::vector<double>      m_ring;         ///< ring buffer (time + channels, row-major)
+  int                      m_row_size;     ///< number of values per row
+  long                     m_capacity;     ///< ring buffer capacity (rows)
+  long                     m_count;        ///< total number of rows recorded
+  long                     m_pre_rows;     ///< rows in the pre-trigger window
+  long                     m_post_rows;    ///< rows in the post-trigger window
+
+  bool                     m_pending;      ///< event triggered, not yet written
+  long                     m_trigger_row;  ///< row at which the pending event was triggered
+  double                   m_trigger_time; ///< time of the pending event
+  std::string              m_description;  ///< description of the pending event
+
+  std::string              m_prefix;       ///< output file prefix
+  int                      m_max_events;   ///< maximum number of events written
+  int                      m_num_events;   ///< number of events written
+};
+
+
+} // end namespace chrono
+
+
+#endif
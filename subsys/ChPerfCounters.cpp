@@ -0,0 +1,366 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hardware performance counters for hot code regions.
+//
+// =============================================================================
+
+#include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+# include <unistd.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <linux/perf_event.h>
+#endif
+
+#include "core/ChLog.h"
+
+#include "subsys/ChPerfCounters.h"
+#include "subsys/ChThreadSlot.h"
+
+
+namespace chrono {
+
+
+#ifdef __linux__
+static const unsigned long long perf_config[ChPerfCounters::NUM_COUNTERS] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+#endif
+
+static const char* counter_names[ChPerfCounters::NUM_COUNTERS] = {
+  "cycles",
+  "instructions",
+  "cache_misses",
+  "branch_misses"
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPerfCounters& ChPerfCounters::GetInstance()
+{
+  static ChPerfCounters counters;
+  return counters;
+}
+
+ChPerfCounters::ChPerfCounters()
+: m_enabled(false),
+  m_failed(false),
+  m_probed(false),
+  m_num_regions(0)
+{
+  for (int c = 0; c < NUM_COUNTERS; c++)
+    m_supported[c] = false;
+
+  for (int t = 0; t < MAX_THREADS; t++) {
+    m_state[t] = NOT_OPEN;
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+      m_fd[t][c] = -1;
+      m_index[t][c] = -1;
+    }
+  }
+
+  m_slots = new Slot[MAX_THREADS * MAX_REGIONS];
+  Reset();
+}
+
+ChPerfCounters::~ChPerfCounters()
+{
+#ifdef __linux__
+  for (int t = 0; t < MAX_THREADS; t++) {
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+      if (m_fd[t][c] >= 0)
+        close(m_fd[t][c]);
+    }
+  }
+#endif
+
+  delete [] m_slots;
+}
+
+
+// -----------------------------------------------------------------------------
+// The counters are opened for the calling thread as one group, with the cycle
+// counter as group leader, so that they are read with a single system call.
+// The supported set of counters is determined by the first thread that opens
+// them; other threads try to open the same set. Since a counter may still fail
+// to open for a given thread, the position of each counter in the group read
+// is recorded separately for each slot.
+//
+// Since the counters are bound to the OS thread that opens them, the slot is
+// the calling thread's ChThreadSlot index, which is only ever used by that
+// thread. The outcome of the first attempt is stored in the slot state, so a
+// failed open is not retried.
+// -----------------------------------------------------------------------------
+bool ChPerfCounters::OpenSlot(int slot)
+{
+  if (slot >= MAX_THREADS)
+    return false;
+
+  if (m_state[slot] == NOT_OPEN) {
+    m_open_lock.Lock();
+    bool opened = Open(slot);
+    m_open_lock.Unlock();
+    m_state[slot] = opened ? OPEN : FAILED;
+  }
+
+  return m_state[slot] == OPEN;
+}
+
+bool ChPerfCounters::Open(int slot)
+{
+#ifdef __linux__
+  bool first = !m_probed;
+  int leader = -1;
+  int num_open = 0;
+
+  for (int c = 0; c < NUM_COUNTERS; c++) {
+    if (!first && !m_supported[c])
+      continue;
+
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = perf_config[c];
+    attr.disabled = (leader < 0) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+
+    if (fd < 0) {
+      if (c == CYCLES)
+        return false;
+      continue;
+    }
+
+    if (leader < 0)
+      leader = fd;
+
+    m_fd[slot][c] = fd;
+    m_index[slot][c] = num_open++;
+
+    if (first)
+      m_supported[c] = true;
+  }
+
+  m_probed = true;
+
+  ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool ChPerfCounters::Read(int slot, Sample& sample)
+{
+#ifdef __linux__
+  struct {
+    unsigned long long nr;
+    unsigned long long time_enabled;
+    unsigned long long time_running;
+    unsigned long long values[NUM_COUNTERS];
+  } data;
+
+  if (read(m_fd[slot][CYCLES], &data, sizeof(data)) <= 0)
+    return false;
+
+  sample.time_enabled = data.time_enabled;
+  sample.time_running = data.time_running;
+  for (int c = 0; c < NUM_COUNTERS; c++) {
+    int index = m_index[slot][c];
+    sample.values[c] = (index >= 0 && index < (int)data.nr) ? data.values[index] : 0;
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Enabling opens the counters for the calling thread, to detect whether they
+// are available at all. Other threads open theirs on first use.
+// -----------------------------------------------------------------------------
+bool ChPerfCounters::Enable()
+{
+  if (m_failed)
+    return false;
+
+  if (!OpenSlot(ChThreadSlot::Get())) {
+    m_failed = true;
+    GetLog() << "ChPerfCounters: hardware performance counters not available\n";
+    return false;
+  }
+
+  m_enabled = true;
+  return true;
+}
+
+int ChPerfCounters::GetRegion(const std::string& name)
+{
+  int id = -1;
+
+  m_register_lock.Lock();
+
+  for (int i = 0; i < m_num_regions; i++) {
+    if (m_names[i] == name) {
+      id = i;
+      break;
+    }
+  }
+
+  if (id < 0 && m_num_regions < MAX_REGIONS) {
+    id = m_num_regions;
+    m_names[id] = name;
+    m_num_regions++;
+  }
+
+  m_register_lock.Unlock();
+
+  return id;
+}
+
+void ChPerfCounters::Begin(Sample& sample)
+{
+  int slot = ChThreadSlot::Get();
+
+  if (!OpenSlot(slot))
+    return;
+
+  sample.valid = Read(slot, sample);
+}
+
+void ChPerfCounters::End(int id, const Sample& sample)
+{
+  if (id < 0)
+    return;
+
+  int slot = ChThreadSlot::Get();
+
+  Sample end;
+  if (!Read(slot, end))
+    return;
+
+  Slot& s = m_slots[slot * MAX_REGIONS + id];
+  s.calls++;
+
+  // Scale for multiplexing: the counters only count while they are scheduled
+  // on the PMU, so extrapolate to the time they were enabled.
+  unsigned long long enabled = end.time_enabled - sample.time_enabled;
+  unsigned long long running = end.time_running - sample.time_running;
+
+  if (running == 0) {
+    s.missed++;
+    return;
+  }
+
+  double scale = (running < enabled) ? (double)enabled / running : 1.0;
+  for (int c = 0; c < NUM_COUNTERS; c++) {
+    unsigned long long delta = end.values[c] - sample.values[c];
+    s.values[c] += (scale == 1.0) ? delta : (unsigned long long)(delta * scale + 0.5);
+  }
+}
+
+void ChPerfCounters::Reset()
+{
+  for (int i = 0; i < MAX_THREADS * MAX_REGIONS; i++) {
+    m_slots[i].calls = 0;
+    m_slots[i].missed = 0;
+    for (int c = 0; c < NUM_COUNTERS; c++)
+      m_slots[i].values[c] = 0;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Reporting
+// -----------------------------------------------------------------------------
+void ChPerfCounters::GetStats(std::vector<Stats>& stats) const
+{
+  stats.resize(m_num_regions);
+
+  for (int id = 0; id < m_num_regions; id++) {
+    Stats& s = stats[id];
+    s.name = m_names[id];
+    s.calls = 0;
+    s.missed = 0;
+    for (int c = 0; c < NUM_COUNTERS; c++)
+      s.values[c] = 0;
+
+    for (int t = 0; t < MAX_THREADS; t++) {
+      const Slot& slot = m_slots[t * MAX_REGIONS + id];
+      s.calls += slot.calls;
+      s.missed += slot.missed;
+      for (int c = 0; c < NUM_COUNTERS; c++)
+        s.values[c] += slot.values[c];
+    }
+  }
+}
+
+void ChPerfCounters::LogSummary() const
+{
+  std::vector<Stats> stats;
+  GetStats(stats);
+
+  GetLog() << "\n---- Hardware counters\n";
+  GetLog() << "   region, calls, missed, cycles, instructions, IPC, cache misses, branch misses\n";
+  for (size_t i = 0; i < stats.size(); i++) {
+    const Stats& s = stats[i];
+    double ipc = s.values[CYCLES] > 0 ? (double)s.values[INSTRUCTIONS] / s.values[CYCLES] : 0;
+    GetLog() << "   " << s.name.c_str() << "  " << (int)s.calls << "  " << (int)s.missed
+             << "  " << (double)s.values[CYCLES] << "  " << (double)s.values[INSTRUCTIONS] << "  " << ipc
+             << "  " << (double)s.values[CACHE_MISSES] << "  " << (double)s.values[BRANCH_MISSES] << "\n";
+  }
+}
+
+bool ChPerfCounters::WriteCSV(const std::string& filename) const
+{
+  std::ofstream ofile(filename.c_str());
+  if (!ofile.is_open())
+    return false;
+
+  std::vector<Stats> stats;
+  GetStats(stats);
+
+  ofile << "region,calls,missed";
+  for (int c = 0; c < NUM_COUNTERS; c++)
+    ofile << "," << counter_names[c];
+  ofile << std::endl;
+
+  for (size_t i = 0; i < stats.size(); i++) {
+    ofile << stats[i].name << "," << stats[i].calls << "," << stats[i].missed;
+    for (int c = 0; c < NUM_COUNTERS; c++)
+      ofile << "," << stats[i].values[c];
+    ofile << std::endl;
+  }
+
+  ofile.close();
+  return true;
+}
+
+
+} // end namespace chrono
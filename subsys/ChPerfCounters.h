@@ -0,0 +1,203 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Hardware performance counters for hot code regions.
+//
+// On Linux, the counters (CPU cycles, instructions, cache misses, and branch
+// misses) are read through perf_event_open for the calling thread, at the
+// start and end of each marked region, and the differences are accumulated per
+// region (in per-thread slots, without locking). Counters and slots belong to
+// an OS thread (see ChThreadSlot); threads beyond MAX_THREADS are not counted.
+// If the kernel multiplexes the counters, the differences are scaled by the
+// ratio of the time the counters were enabled to the time they were running;
+// calls during which the counters did not run at all are reported separately.
+//
+// Counting is off by default and must be enabled at run time. If the counters
+// cannot be opened (other platforms, insufficient permissions, virtualized
+// hardware, etc.), a message is logged once and the region markers have no
+// effect (a failure to open the counters for a given thread is remembered, so
+// that it is not retried for every region). Individual counters which are not
+// supported are reported as zero.
+//
+// Region markers (CH_PERF_SCOPE) are compiled in only if the library was
+// configured with ENABLE_PROFILING.
+//
+// =============================================================================
+
+#ifndef CH_PERF_COUNTERS_H
+#define CH_PERF_COUNTERS_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChThreadSlot.h"
+
+#include "ChronoVehicle_config.h"
+
+namespace chrono {
+
+///
+/// Collector of hardware performance counters (singleton).
+///
+class CH_SUBSYS_API ChPerfCounters
+{
+public:
+
+  /// Hardware events counted for each region.
+  enum Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    NUM_COUNTERS
+  };
+
+  static const int MAX_REGIONS = 64;    ///< maximum number of regions
+  static const int MAX_THREADS = 32;    ///< number of per-thread slots
+
+  /// Accumulated counter values for one region.
+  struct Stats {
+    std::string         name;                      ///< region name
+    long                calls;                     ///< number of calls
+    long                missed;                    ///< calls not counted (counters not running)
+    unsigned long long  values[NUM_COUNTERS];      ///< accumulated counter values
+  };
+
+  /// Counter snapshot taken at the start of a region.
+  struct Sample {
+    bool                valid;
+    unsigned long long  time_enabled;
+    unsigned long long  time_running;
+    unsigned long long  values[NUM_COUNTERS];
+  };
+
+  /// Get the collector instance.
+  static ChPerfCounters& GetInstance();
+
+  /// Enable counting. Return false if hardware counters are not available.
+  bool Enable();
+
+  /// Disable counting.
+  void Disable() { m_enabled = false; }
+
+  /// Return true if counting is enabled.
+  bool IsEnabled() const { return m_enabled; }
+
+  /// Return true if the specified counter is supported.
+  bool IsSupported(Counter counter) const { return m_supported[counter]; }
+
+  /// Return the identifier of the region with the given name (registered on
+  /// first call). Returns -1 if too many regions.
+  int GetRegion(const std::string& name);
+
+  /// Read the current counter values for the calling thread.
+  void Begin(Sample& sample);
+
+  /// Accumulate the counter differences since the given sample.
+  void End(int id, const Sample& sample);
+
+  /// Clear all accumulated values.
+  void Reset();
+
+  /// Get the accumulated values for all regions (merged over threads).
+  void GetStats(std::vector<Stats>& stats) const;
+
+  /// Log a summary of all regions.
+  void LogSummary() const;
+
+  /// Write the accumulated values for all regions to a CSV file.
+  bool WriteCSV(const std::string& filename) const;
+
+private:
+
+  struct Slot {
+    long                calls;
+    long                missed;
+    unsigned long long  values[NUM_COUNTERS];
+  };
+
+  enum SlotState {
+    NOT_OPEN,
+    OPEN,
+    FAILED
+  };
+
+  ChPerfCounters();
+  ~ChPerfCounters();
+
+  bool OpenSlot(int slot);
+  bool Open(int slot);
+  bool Read(int slot, Sample& sample);
+
+  bool         m_enabled;                           ///< counting enabled?
+  bool         m_failed;                            ///< counters could not be opened
+  bool         m_supported[NUM_COUNTERS];           ///< supported counters
+  bool         m_probed;                            ///< supported counters determined?
+  SlotState    m_state[MAX_THREADS];                ///< per-thread counter state
+  int          m_fd[MAX_THREADS][NUM_COUNTERS];     ///< per-thread counter file descriptors (-1 if not open)
+  int          m_index[MAX_THREADS][NUM_COUNTERS];  ///< per-thread position of each counter in the group read (-1 if not open)
+  int          m_num_regions;                       ///< number of registered regions
+  std::string  m_names[MAX_REGIONS];                ///< region names
+  Slot*        m_slots;                             ///< per-thread values [MAX_THREADS x MAX_REGIONS]
+  ChSpinLock   m_open_lock;                         ///< lock for opening the counters of a thread
+  ChSpinLock   m_register_lock;                     ///< lock for region registration
+};
+
+
+///
+/// Scoped region marker for hardware performance counters.
+///
+class ChPerfScope
+{
+public:
+  ChPerfScope(int id) : m_id(id)
+  {
+    m_sample.valid = false;
+    if (ChPerfCounters::GetInstance().IsEnabled())
+      ChPerfCounters::GetInstance().Begin(m_sample);
+  }
+  ~ChPerfScope()
+  {
+    if (m_sample.valid)
+      ChPerfCounters::GetInstance().End(m_id, m_sample);
+  }
+
+private:
+  int                     m_id;
+  ChPerfCounters::Sample  m_sample;
+};
+
+
+} // end namespace chrono
+
+
+#if PROFILING_ENABLED
+
+# define CH_PERF_CONCAT_(a, b) a##b
+# define CH_PERF_CONCAT(a, b) CH_PERF_CONCAT_(a, b)
+
+/// Collect hardware counters for the enclosing scope, in the region with the given (literal) name.
+# define CH_PERF_SCOPE(name) \
+    static const int CH_PERF_CONCAT(ch_perf_id_, __LINE__) = chrono::ChPerfCounters::GetInstance().GetRegion(name); \
+    chrono::ChPerfScope CH_PERF_CONCAT(ch_perf_scope_, __LINE__)(CH_PERF_CONCAT(ch_perf_id_, __LINE__))
+
+#else
+
+# define CH_PERF_SCOPE(name)
+
+#endif
+
+
+#endif
@@ -23,9 +23,24 @@ namespace chrono {
 
 
 ChPowertrain::ChPowertrain()
-: m_drive_mode(FORWARD)
+: m_drive_mode(FORWARD),
+  m_verbose(true)
 {
 }
 
 
+// -----------------------------------------------------------------------------
+// Snapshot and restore the drive mode.
+// -----------------------------------------------------------------------------
+void ChPowertrain::Snapshot(ChStateBuffer& buffer) const
+{
+  buffer.Write(m_drive_mode);
+}
+
+bool ChPowertrain::Restore(ChStateBuffer& buffer)
+{
+  return buffer.Read(m_drive_mode);
+}
+
+
 }  // end namespace chrono
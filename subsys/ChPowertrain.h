@@ -24,6 +24,7 @@
 #include "physics/ChBody.h"
 
 #include "subsys/ChApiSubsys.h"
+#include "subsys/ChStateBuffer.h"
 
 namespace chrono {
 
@@ -86,8 +87,23 @@ public:
   /// Advance the state of this powertrain system by the specified time step.
   virtual void Advance(double step) = 0;
 
+  /// Append the state of this powertrain system to the specified buffer.
+  /// The base class records the drive mode only. Note that the states of any
+  /// Chrono physics items (e.g. shafts) are saved with the vehicle system.
+  virtual void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the state of this powertrain system from the specified buffer.
+  /// Return false if the buffer does not contain a compatible state.
+  virtual bool Restore(ChStateBuffer& buffer);
+
+  /// Enable or disable diagnostic messages (e.g. gear shifts). Enabled by
+  /// default. Runners stepping several vehicles in parallel disable them,
+  /// since GetLog() is not thread-safe.
+  void SetVerbose(bool verbose) { m_verbose = verbose; }
+
 protected:
   DriveMode m_drive_mode;
+  bool      m_verbose;    ///< report diagnostic messages
 };
 
 
@@ -0,0 +1,265 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Profiling registry for timing the vehicle simulation modules.
+//
+// =============================================================================
+
+#include <fstream>
+#include <algorithm>
+
+#include "core/ChLog.h"
+
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChProfiler& ChProfiler::GetInstance()
+{
+  static ChProfiler profiler;
+  return profiler;
+}
+
+ChProfiler::ChProfiler()
+: m_num_regions(0)
+{
+  m_slots = new Slot[(MAX_THREADS + 1) * MAX_REGIONS];
+  Reset();
+}
+
+ChProfiler::~ChProfiler()
+{
+  delete [] m_slots;
+}
+
+
+// -----------------------------------------------------------------------------
+// Registration is rare (typically once per instrumented call site) and is
+// serialized. Recording uses the slot of the calling thread only; threads
+// without a slot of their own share the last slot, under a lock.
+// -----------------------------------------------------------------------------
+int ChProfiler::Register(const std::string& name,
+                         bool               is_timer)
+{
+  int id = -1;
+
+  m_register_lock.Lock();
+
+  for (int i = 0; i < m_num_regions; i++) {
+    if (m_names[i] == name && m_is_timer[i] == is_timer) {
+      id = i;
+      break;
+    }
+  }
+
+  if (id < 0 && m_num_regions < MAX_REGIONS) {
+    id = m_num_regions;
+    m_names[id] = name;
+    m_is_timer[id] = is_timer;
+    m_num_regions++;
+  }
+
+  m_register_lock.Unlock();
+
+  return id;
+}
+
+void ChProfiler::ClearSlot(Slot& slot)
+{
+  slot.count = 0;
+  slot.total = 0;
+  slot.min = 1e30;
+  slot.max = 0;
+  for (int k = 0; k < NUM_BUCKETS; k++)
+    slot.hist[k] = 0;
+}
+
+void ChProfiler::Accumulate(Slot&  slot,
+                            double duration)
+{
+  slot.count++;
+  slot.total += duration;
+  slot.min = std::min<>(slot.min, duration);
+  slot.max = std::max<>(slot.max, duration);
+
+  // Bucket k holds durations in [2^(k-1), 2^k) microseconds.
+  int k = 0;
+  for (double us = duration * 1e6; us >= 1 && k < NUM_BUCKETS - 1; us *= 0.5)
+    k++;
+  slot.hist[k]++;
+}
+
+void ChProfiler::Record(int    id,
+                        double duration)
+{
+  if (id < 0)
+    return;
+
+  int thread = ChThreadSlot::Get();
+
+  if (thread < MAX_THREADS) {
+    Accumulate(m_slots[thread * MAX_REGIONS + id], duration);
+    return;
+  }
+
+  m_overflow_lock.Lock();
+  Accumulate(m_slots[MAX_THREADS * MAX_REGIONS + id], duration);
+  m_overflow_lock.Unlock();
+}
+
+void ChProfiler::Increment(int  id,
+                           long n)
+{
+  if (id < 0)
+    return;
+
+  int thread = ChThreadSlot::Get();
+
+  if (thread < MAX_THREADS) {
+    m_slots[thread * MAX_REGIONS + id].count += n;
+    return;
+  }
+
+  m_overflow_lock.Lock();
+  m_slots[MAX_THREADS * MAX_REGIONS + id].count += n;
+  m_overflow_lock.Unlock();
+}
+
+void ChProfiler::Reset()
+{
+  for (int i = 0; i < (MAX_THREADS + 1) * MAX_REGIONS; i++)
+    ClearSlot(m_slots[i]);
+}
+
+
+// -----------------------------------------------------------------------------
+// Merge the per-thread statistics.
+// -----------------------------------------------------------------------------
+void ChProfiler::GetStats(std::vector<Stats>& stats) const
+{
+  stats.resize(m_num_regions);
+
+  for (int id = 0; id < m_num_regions; id++) {
+    Stats& s = stats[id];
+    s.name = m_names[id];
+    s.is_timer = m_is_timer[id];
+    s.count = 0;
+    s.total = 0;
+    s.min = 1e30;
+    s.max = 0;
+    for (int k = 0; k < NUM_BUCKETS; k++)
+      s.hist[k] = 0;
+
+    for (int t = 0; t <= MAX_THREADS; t++) {
+      const Slot& slot = m_slots[t * MAX_REGIONS + id];
+      s.count += slot.count;
+      s.total += slot.total;
+      s.min = std::min<>(s.min, slot.min);
+      s.max = std::max<>(s.max, slot.max);
+      for (int k = 0; k < NUM_BUCKETS; k++)
+        s.hist[k] += slot.hist[k];
+    }
+
+    if (s.min > s.max)
+      s.min = 0;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Reporting
+// -----------------------------------------------------------------------------
+void ChProfiler::LogSummary() const
+{
+  std::vector<Stats> stats;
+  GetStats(stats);
+
+  GetLog() << "\n---- Profiling summary\n";
+  GetLog() << "   region, calls, total (s), average (s), min (s), max (s)\n";
+  for (size_t i = 0; i < stats.size(); i++) {
+    const Stats& s = stats[i];
+    GetLog() << "   " << s.name.c_str() << "  " << (int)s.count;
+    if (s.is_timer)
+      GetLog() << "  " << s.total << "  " << s.GetAverage() << "  " << s.min << "  " << s.max;
+    GetLog() << "\n";
+  }
+}
+
+bool ChProfiler::WriteCSV(const std::string& filename) const
+{
+  std::ofstream ofile(filename.c_str());
+  if (!ofile.is_open())
+    return false;
+
+  std::vector<Stats> stats;
+  GetStats(stats);
+
+  ofile << "region,type,count,total,average,min,max";
+  for (int k = 0; k < NUM_BUCKETS; k++)
+    ofile << ",hist_" << k;
+  ofile << std::endl;
+
+  for (size_t i = 0; i < stats.size(); i++) {
+    const Stats& s = stats[i];
+    ofile << s.name << "," << (s.is_timer ? "timer" : "counter") << "," << s.count << ","
+          << s.total << "," << s.GetAverage() << "," << s.min << "," << s.max;
+    for (int k = 0; k < NUM_BUCKETS; k++)
+      ofile << "," << s.hist[k];
+    ofile << std::endl;
+  }
+
+  ofile.close();
+  return true;
+}
+
+bool ChProfiler::WriteJSON(const std::string& filename) const
+{
+  std::ofstream ofile(filename.c_str());
+  if (!ofile.is_open())
+    return false;
+
+  std::vector<Stats> stats;
+  GetStats(stats);
+
+  ofile << "{" << std::endl;
+  ofile << "  \"Histogram Buckets\": \"bucket k: [2^(k-1), 2^k) us\"," << std::endl;
+  ofile << "  \"Regions\": [" << std::endl;
+
+  for (size_t i = 0; i < stats.size(); i++) {
+    const Stats& s = stats[i];
+    ofile << "    { \"Name\": \"" << s.name << "\", \"Type\": \"" << (s.is_timer ? "timer" : "counter")
+          << "\", \"Count\": " << s.count;
+    if (s.is_timer) {
+      ofile << ", \"Total\": " << s.total << ", \"Average\": " << s.GetAverage()
+            << ", \"Min\": " << s.min << ", \"Max\": " << s.max << ", \"Histogram\": [";
+      for (int k = 0; k < NUM_BUCKETS; k++)
+        ofile << (k ? ", " : "") << s.hist[k];
+      ofile << "]";
+    }
+    ofile << " }" << (i + 1 < stats.size() ? "," : "") << std::endl;
+  }
+
+  ofile << "  ]" << std::endl;
+  ofile << "}" << std::endl;
+
+  ofile.close();
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,188 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Profiling registry for timing the vehicle simulation modules.
+//
+// Named regions are registered once (obtaining an integer identifier) and then
+// timed with scoped timers. For each region, the registry keeps the number of
+// calls, total/min/max time, and a histogram of call durations (logarithmic
+// buckets, in microseconds). Counter regions only accumulate a count.
+//
+// Statistics are accumulated in per-thread slots (no locking on the hot path)
+// and merged when reported. Slots are assigned per OS thread (see
+// ChThreadSlot); threads beyond MAX_THREADS share one additional slot, which
+// is updated under a lock. The summary can be logged or exported as CSV or
+// JSON.
+//
+// Profiled scopes also feed the timeline tracer (see ChTracer), if enabled.
+//
+// Instrumentation is compiled in only if the library was configured with
+// ENABLE_PROFILING (PROFILING_ENABLED in ChronoVehicle_config.h). Otherwise,
+// the CH_PROFILE_* macros expand to nothing.
+//
+// =============================================================================
+
+#ifndef CH_PROFILER_H
+#define CH_PROFILER_H
+
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChTracer.h"
+#include "subsys/ChThreadSlot.h"
+
+#include "ChronoVehicle_config.h"
+
+namespace chrono {
+
+///
+/// Registry of profiling regions (singleton).
+///
+class CH_SUBSYS_API ChProfiler
+{
+public:
+
+  static const int MAX_REGIONS = 128;   ///< maximum number of regions
+  static const int MAX_THREADS = 32;    ///< number of per-thread slots (excluding the shared overflow slot)
+  static const int NUM_BUCKETS = 16;    ///< number of histogram buckets
+
+  /// Merged statistics for one region.
+  struct Stats {
+    std::string  name;                   ///< region name
+    bool         is_timer;               ///< false for counter regions
+    long         count;                  ///< number of calls (or counter value)
+    double       total;                  ///< total time (s)
+    double       min;                    ///< shortest call (s)
+    double       max;                    ///< longest call (s)
+    long         hist[NUM_BUCKETS];      ///< number of calls per bucket; bucket k holds durations in [2^(k-1), 2^k) us
+
+    double GetAverage() const { return count > 0 ? total / count : 0; }
+  };
+
+  /// Get the profiler instance.
+  static ChProfiler& GetInstance();
+
+  /// Return the identifier of the timer region with the given name.
+  /// The region is registered on first call. Returns -1 if too many regions.
+  int GetRegion(const std::string& name) { return Register(name, true); }
+
+  /// Return the identifier of the counter with the given name.
+  /// The counter is registered on first call. Returns -1 if too many regions.
+  int GetCounter(const std::string& name) { return Register(name, false); }
+
+  /// Record one call of the specified timer region.
+  void Record(int id, double duration);
+
+  /// Increment the specified counter.
+  void Increment(int id, long n = 1);
+
+  /// Clear all accumulated statistics (region registrations are kept).
+  void Reset();
+
+  /// Get the merged statistics for all registered regions.
+  void GetStats(std::vector<Stats>& stats) const;
+
+  /// Log a summary of all regions.
+  void LogSummary() const;
+
+  /// Write the statistics for all regions to a CSV file.
+  bool WriteCSV(const std::string& filename) const;
+
+  /// Write the statistics for all regions to a JSON file.
+  bool WriteJSON(const std::string& filename) const;
+
+private:
+
+  struct Slot {
+    long    count;
+    double  total;
+    double  min;
+    double  max;
+    long    hist[NUM_BUCKETS];
+  };
+
+  ChProfiler();
+  ~ChProfiler();
+
+  int Register(const std::string& name, bool is_timer);
+  static void ClearSlot(Slot& slot);
+  static void Accumulate(Slot& slot, double duration);
+
+  int          m_num_regions;                ///< number of registered regions
+  std::string  m_names[MAX_REGIONS];         ///< region names
+  bool         m_is_timer[MAX_REGIONS];      ///< region types
+  Slot*        m_slots;                      ///< per-thread statistics [(MAX_THREADS + 1) x MAX_REGIONS]
+  ChSpinLock   m_overflow_lock;              ///< lock for the shared overflow slot
+  ChSpinLock   m_register_lock;              ///< lock for region registration
+};
+
+
+///
+/// Scoped timer, recording the time between construction and destruction.
+/// If the tracer is enabled, a trace event is also recorded.
+///
+class ChProfileScope
+{
+public:
+  ChProfileScope(int id) : m_id(id), m_start(ChTracer::GetTime()) {}
+  ~ChProfileScope()
+  {
+    double duration = ChTracer::GetTime() - m_start;
+    ChProfiler::GetInstance().Record(m_id, duration);
+    ChTracer& tracer = ChTracer::GetInstance();
+    if (tracer.IsEnabled())
+      tracer.Record(m_id, m_start, duration);
+  }
+
+private:
+  int     m_id;
+  double  m_start;
+};
+
+
+} // end namespace chrono
+
+
+#define CH_PROFILE_CONCAT_(a, b) a##b
+#define CH_PROFILE_CONCAT(a, b) CH_PROFILE_CONCAT_(a, b)
+
+#if PROFILING_ENABLED
+
+/// Time the enclosing scope, in the region with the given (literal) name.
+# define CH_PROFILE_SCOPE(name) \
+    static const int CH_PROFILE_CONCAT(ch_prof_id_, __LINE__) = chrono::ChProfiler::GetInstance().GetRegion(name); \
+    chrono::ChProfileScope CH_PROFILE_CONCAT(ch_prof_scope_, __LINE__)(CH_PROFILE_CONCAT(ch_prof_id_, __LINE__))
+
+/// Time the enclosing scope, in the region with the given identifier.
+# define CH_PROFILE_SCOPE_ID(id) \
+    chrono::ChProfileScope CH_PROFILE_CONCAT(ch_prof_scope_, __LINE__)(id)
+
+/// Increment the counter with the given (literal) name.
+# define CH_PROFILE_COUNT(name, n) \
+    do { \
+      static const int ch_prof_cnt = chrono::ChProfiler::GetInstance().GetCounter(name); \
+      chrono::ChProfiler::GetInstance().Increment(ch_prof_cnt, n); \
+    } while (0)
+
+#else
+
+# define CH_PROFILE_SCOPE(name)
+# define CH_PROFILE_SCOPE_ID(id)
+# define CH_PROFILE_COUNT(name, n) do {} while (0)
+
+#endif
+
+
+#endif
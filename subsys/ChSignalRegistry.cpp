@@ -0,0 +1,270 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Registry of named vehicle signals (output channels).
+//
+// =============================================================================
+
+#include <sstream>
+
+#include "subsys/ChSignalRegistry.h"
+#include "subsys/ChVehicleSimulation.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Signal implementations for the quantities published by the registry helpers.
+// Each signal only wraps an existing accessor.
+// -----------------------------------------------------------------------------
+namespace {
+
+class ChassisSignal : public ChSignalRegistry::Signal {
+public:
+  enum Quantity { SPEED, POS_X, POS_Y, POS_Z };
+
+  ChassisSignal(const ChVehicle& vehicle, Quantity q) : m_vehicle(vehicle), m_q(q) {}
+
+  virtual double Evaluate() const {
+    switch (m_q) {
+    case SPEED: return m_vehicle.GetVehicleSpeed();
+    case POS_X: return m_vehicle.GetChassisPos().x;
+    case POS_Y: return m_vehicle.GetChassisPos().y;
+    default:    return m_vehicle.GetChassisPos().z;
+    }
+  }
+
+private:
+  const ChVehicle& m_vehicle;
+  Quantity         m_q;
+};
+
+class WheelOmegaSignal : public ChSignalRegistry::Signal {
+public:
+  WheelOmegaSignal(const ChVehicle& vehicle, const ChWheelID& wheel_id) : m_vehicle(vehicle), m_wheel_id(wheel_id) {}
+
+  virtual double Evaluate() const { return m_vehicle.GetWheelOmega(m_wheel_id); }
+
+private:
+  const ChVehicle& m_vehicle;
+  ChWheelID        m_wheel_id;
+};
+
+class SuspensionSignal : public ChSignalRegistry::Signal {
+public:
+  enum Quantity { SPRING_FORCE, SPRING_LENGTH, SHOCK_FORCE, SHOCK_VELOCITY };
+
+  SuspensionSignal(ChSharedPtr<ChSuspension> suspension, ChVehicleSide side, Quantity q)
+  : m_suspension(suspension), m_side(side), m_q(q) {}
+
+  virtual double Evaluate() const {
+    switch (m_q) {
+    case SPRING_FORCE:  return m_suspension->GetSpringForce(m_side);
+    case SPRING_LENGTH: return m_suspension->GetSpringLength(m_side);
+    case SHOCK_FORCE:   return m_suspension->GetShockForce(m_side);
+    default:            return m_suspension->GetShockVelocity(m_side);
+    }
+  }
+
+private:
+  ChSharedPtr<ChSuspension> m_suspension;
+  ChVehicleSide             m_side;
+  Quantity                  m_q;
+};
+
+class TireForceSignal : public ChSignalRegistry::Signal {
+public:
+  enum Quantity { FX, FY, FZ, MZ };
+
+  TireForceSignal(const ChVehicle& vehicle, const ChTire& tire, Quantity q)
+  : m_vehicle(vehicle), m_tire(tire), m_q(q) {}
+
+  virtual double Evaluate() const {
+    ChTireForce tf = m_tire.GetTireForce();
+    const ChQuaternion<>& rot = m_vehicle.GetChassisRot();
+    switch (m_q) {
+    case FX: return rot.RotateBack(tf.force).x;
+    case FY: return rot.RotateBack(tf.force).y;
+    case FZ: return rot.RotateBack(tf.force).z;
+    default: return rot.RotateBack(tf.moment).z;
+    }
+  }
+
+private:
+  const ChVehicle& m_vehicle;
+  const ChTire&    m_tire;
+  Quantity         m_q;
+};
+
+class PowertrainSignal : public ChSignalRegistry::Signal {
+public:
+  enum Quantity { ENGINE_RPM, ENGINE_TORQUE, OUTPUT_TORQUE, GEAR };
+
+  PowertrainSignal(const ChPowertrain& powertrain, Quantity q) : m_powertrain(powertrain), m_q(q) {}
+
+  virtual double Evaluate() const {
+    switch (m_q) {
+    case ENGINE_RPM:    return m_powertrain.GetMotorSpeed() * 30 / CH_C_PI;
+    case ENGINE_TORQUE: return m_powertrain.GetMotorTorque();
+    case OUTPUT_TORQUE: return m_powertrain.GetOutputTorque();
+    default:            return m_powertrain.GetCurrentTransmissionGear();
+    }
+  }
+
+private:
+  const ChPowertrain& m_powertrain;
+  Quantity            m_q;
+};
+
+class DriverSignal : public ChSignalRegistry::Signal {
+public:
+  enum Quantity { STEERING, THROTTLE, BRAKING };
+
+  DriverSignal(const ChDriver& driver, Quantity q) : m_driver(driver), m_q(q) {}
+
+  virtual double Evaluate() const {
+    switch (m_q) {
+    case STEERING: return m_driver.GetSteering();
+    case THROTTLE: return m_driver.GetThrottle();
+    default:       return m_driver.GetBraking();
+    }
+  }
+
+private:
+  const ChDriver& m_driver;
+  Quantity        m_q;
+};
+
+} // end anonymous namespace
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSignalRegistry::~ChSignalRegistry()
+{
+  for (size_t i = 0; i < m_channels.size(); i++)
+    delete m_channels[i].signal;
+}
+
+int ChSignalRegistry::AddChannel(const std::string& name,
+                                 const std::string& units,
+                                 Signal*            signal)
+{
+  if (FindChannel(name) >= 0) {
+    GetLog() << "ChSignalRegistry: duplicate channel " << name.c_str() << "\n";
+    delete signal;
+    return -1;
+  }
+
+  Channel channel;
+  channel.name = name;
+  channel.units = units;
+  channel.signal = signal;
+  m_channels.push_back(channel);
+
+  return (int)m_channels.size() - 1;
+}
+
+int ChSignalRegistry::FindChannel(const std::string& name) const
+{
+  for (size_t i = 0; i < m_channels.size(); i++) {
+    if (m_channels[i].name == name)
+      return (int)i;
+  }
+
+  return -1;
+}
+
+
+// -----------------------------------------------------------------------------
+// Publishing helpers
+// -----------------------------------------------------------------------------
+void ChSignalRegistry::AddVehicleChannels(const ChVehicle& vehicle)
+{
+  AddChannel("chassis.speed", "m/s", new ChassisSignal(vehicle, ChassisSignal::SPEED));
+  AddChannel("chassis.x", "m", new ChassisSignal(vehicle, ChassisSignal::POS_X));
+  AddChannel("chassis.y", "m", new ChassisSignal(vehicle, ChassisSignal::POS_Y));
+  AddChannel("chassis.z", "m", new ChassisSignal(vehicle, ChassisSignal::POS_Z));
+
+  for (int i = 0; i < 2 * vehicle.GetNumberAxles(); i++) {
+    std::ostringstream name;
+    name << "wheel" << i << ".omega";
+    AddChannel(name.str(), "rad/s", new WheelOmegaSignal(vehicle, ChWheelID(i)));
+  }
+
+  for (int i = 0; i < vehicle.GetNumberAxles(); i++) {
+    ChSharedPtr<ChSuspension> suspension = vehicle.GetSuspension(i);
+    if (!suspension->HasSpringShock())
+      continue;
+    for (int side = LEFT; side <= RIGHT; side++) {
+      std::ostringstream prefix;
+      prefix << "axle" << i << (side == LEFT ? ".left." : ".right.");
+      ChVehicleSide s = ChVehicleSide(side);
+      AddChannel(prefix.str() + "spring_force", "N", new SuspensionSignal(suspension, s, SuspensionSignal::SPRING_FORCE));
+      AddChannel(prefix.str() + "spring_length", "m", new SuspensionSignal(suspension, s, SuspensionSignal::SPRING_LENGTH));
+      AddChannel(prefix.str() + "shock_force", "N", new SuspensionSignal(suspension, s, SuspensionSignal::SHOCK_FORCE));
+      AddChannel(prefix.str() + "shock_velocity", "m/s", new SuspensionSignal(suspension, s, SuspensionSignal::SHOCK_VELOCITY));
+    }
+  }
+}
+
+void ChSignalRegistry::AddTireChannels(const ChVehicle& vehicle,
+                                       const ChWheelID& wheel_id,
+                                       const ChTire&    tire)
+{
+  std::ostringstream prefix;
+  prefix << "tire" << wheel_id.id() << ".";
+
+  AddChannel(prefix.str() + "Fx", "N", new TireForceSignal(vehicle, tire, TireForceSignal::FX));
+  AddChannel(prefix.str() + "Fy", "N", new TireForceSignal(vehicle, tire, TireForceSignal::FY));
+  AddChannel(prefix.str() + "Fz", "N", new TireForceSignal(vehicle, tire, TireForceSignal::FZ));
+  AddChannel(prefix.str() + "Mz", "Nm", new TireForceSignal(vehicle, tire, TireForceSignal::MZ));
+}
+
+void ChSignalRegistry::AddPowertrainChannels(const ChPowertrain& powertrain)
+{
+  AddChannel("powertrain.engine_rpm", "rpm", new PowertrainSignal(powertrain, PowertrainSignal::ENGINE_RPM));
+  AddChannel("powertrain.engine_torque", "Nm", new PowertrainSignal(powertrain, PowertrainSignal::ENGINE_TORQUE));
+  AddChannel("powertrain.output_torque", "Nm", new PowertrainSignal(powertrain, PowertrainSignal::OUTPUT_TORQUE));
+  AddChannel("powertrain.gear", "-", new PowertrainSignal(powertrain, PowertrainSignal::GEAR));
+}
+
+void ChSignalRegistry::AddDriverChannels(const ChDriver& driver)
+{
+  AddChannel("driver.steering", "-", new DriverSignal(driver, DriverSignal::STEERING));
+  AddChannel("driver.throttle", "-", new DriverSignal(driver, DriverSignal::THROTTLE));
+  AddChannel("driver.braking", "-", new DriverSignal(driver, DriverSignal::BRAKING));
+}
+
+void ChSignalRegistry::AddSimulationChannels(ChVehicleSimulation& sim)
+{
+  const ChVehicle& vehicle = sim.GetVehicle();
+
+  AddVehicleChannels(vehicle);
+
+  for (int i = 0; i < 2 * vehicle.GetNumberAxles(); i++) {
+    const ChTire* tire = sim.GetTire(ChWheelID(i));
+    if (tire)
+      AddTireChannels(vehicle, ChWheelID(i), *tire);
+  }
+
+  if (sim.GetPowertrain())
+    AddPowertrainChannels(*sim.GetPowertrain());
+
+  AddDriverChannels(sim.GetDriver());
+}
+
+
+} // end namespace chrono
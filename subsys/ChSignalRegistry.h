@@ -0,0 +1,134 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Registry of named vehicle signals (output channels).
+//
+// A channel associates a name and units with a signal object which evaluates
+// the current value of some quantity from an existing accessor (e.g., chassis
+// speed, wheel angular speed, spring force, tire force, engine speed). Channels
+// are published once, typically right after the vehicle system is initialized,
+// and can then be sampled by any number of consumers (see ChChannelLogger).
+//
+// Channel naming convention (wheels and tires indexed by wheel ID):
+//   chassis.speed, chassis.x, chassis.y, chassis.z
+//   wheel<i>.omega
+//   axle<i>.<left|right>.spring_force, .spring_length, .shock_force, .shock_velocity
+//   tire<i>.Fx, .Fy, .Fz, .Mz          (expressed in the chassis frame)
+//   powertrain.engine_rpm, .engine_torque, .output_torque, .gear
+//   driver.steering, driver.throttle, driver.braking
+//
+// =============================================================================
+
+#ifndef CH_SIGNAL_REGISTRY_H
+#define CH_SIGNAL_REGISTRY_H
+
+#include <string>
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChPowertrain.h"
+
+namespace chrono {
+
+class ChVehicleSimulation;
+
+///
+/// Registry of named signals.
+///
+class CH_SUBSYS_API ChSignalRegistry : public ChShared
+{
+public:
+
+  /// Interface for a scalar signal.
+  class Signal {
+  public:
+    virtual ~Signal() {}
+
+    /// Return the current value of the signal.
+    virtual double Evaluate() const = 0;
+  };
+
+  ChSignalRegistry() {}
+  ~ChSignalRegistry();
+
+  /// Publish a channel. The registry takes ownership of the signal object.
+  /// Return the channel index, or -1 if a channel with the same name exists.
+  int AddChannel(
+    const std::string& name,    ///< [in] unique channel name
+    const std::string& units,   ///< [in] channel units
+    Signal*            signal   ///< [in] signal object (owned by the registry)
+    );
+
+  /// Publish the chassis, wheel, and suspension channels of a vehicle.
+  /// Spring and shock channels are only published for suspensions which
+  /// have separate spring and shock elements (see ChSuspension::HasSpringShock).
+  void AddVehicleChannels(const ChVehicle& vehicle);
+
+  /// Publish the force channels of the tire attached to the specified wheel.
+  void AddTireChannels(
+    const ChVehicle&           vehicle,   ///< [in] vehicle (defines the force frame)
+    const ChWheelID&           wheel_id,  ///< [in] wheel identifier
+    const ChTire&              tire       ///< [in] tire (must outlive the registry)
+    );
+
+  /// Publish the channels of a powertrain (which must outlive the registry).
+  void AddPowertrainChannels(const ChPowertrain& powertrain);
+
+  /// Publish the channels of a driver.
+  void AddDriverChannels(const ChDriver& driver);
+
+  /// Publish all channels of a vehicle simulation (vehicle, tires, powertrain,
+  /// and driver).
+  void AddSimulationChannels(ChVehicleSimulation& sim);
+
+  /// Get the number of published channels.
+  int GetNumChannels() const { return (int)m_channels.size(); }
+
+  /// Get the index of the channel with given name (-1 if not found).
+  int FindChannel(const std::string& name) const;
+
+  /// Get the name of the specified channel.
+  const std::string& GetName(int channel) const { return m_channels[channel].name; }
+
+  /// Get the units of the specified channel.
+  const std::string& GetUnits(int channel) const { return m_channels[channel].units; }
+
+  /// Evaluate the current value of the specified channel.
+  double Evaluate(int channel) const { return m_channels[channel].signal->Evaluate(); }
+
+private:
+
+  // Signals are owned by the registry; disallow copying.
+  ChSignalRegistry(const ChSignalRegistry&);
+  ChSignalRegistry& operator=(const ChSignalRegistry&);
+
+  struct Channel {
+    std::string  name;
+    std::string  units;
+    Signal*      signal;
+  };
+
+  std::vector<Channel>  m_channels;   ///< published channels
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,327 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Automatic selection of solver settings for a vehicle.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <algorithm>
+#include <sstream>
+
+#include "core/ChTimer.h"
+
+#include "subsys/ChSolverTuner.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+using namespace rapidjson;
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChSolverTuner::ChSolverTuner(ChVehicleFactory&                        factory,
+                             const std::vector<ChDataDriver::Entry>&  maneuver,
+                             double                                   duration)
+: m_factory(factory),
+  m_maneuver(maneuver),
+  m_duration(duration),
+  m_step(1e-3),
+  m_tolerance(1e-3),
+  m_repeats(3),
+  m_found(false)
+{
+  m_types.push_back(ChSystem::LCP_ITERATIVE_SOR);
+  m_types.push_back(ChSystem::LCP_ITERATIVE_SYMMSOR);
+  m_types.push_back(ChSystem::LCP_ITERATIVE_BARZILAIBORWEIN);
+  m_types.push_back(ChSystem::LCP_ITERATIVE_APGD);
+
+  int iterations[] = { 20, 40, 60, 80, 100, 150, 200 };
+  m_iterations.assign(iterations, iterations + sizeof(iterations) / sizeof(int));
+}
+
+
+// -----------------------------------------------------------------------------
+// For each solver type, try increasing iteration counts until the constraint
+// violation is acceptable (larger counts are then assumed to be acceptable as
+// well, but more expensive).
+// -----------------------------------------------------------------------------
+bool ChSolverTuner::Run()
+{
+  m_trials.clear();
+  m_found = false;
+
+  std::vector<int> iterations = m_iterations;
+  std::sort(iterations.begin(), iterations.end());
+
+  double best_cost = 0;
+
+  for (size_t it = 0; it < m_types.size(); it++) {
+    for (size_t ii = 0; ii < iterations.size(); ii++) {
+      Trial trial;
+      trial.settings.type = m_types[it];
+      trial.settings.max_iters_speed = iterations[ii];
+      trial.settings.max_iters_stab = iterations[ii];
+      trial.settings.max_recovery_speed = 4.0;
+
+      RunTrial(trial);
+      m_trials.push_back(trial);
+
+      if (!trial.valid)
+        continue;
+
+      if (!m_found || trial.cost < best_cost) {
+        m_best = trial.settings;
+        best_cost = trial.cost;
+        m_found = true;
+      }
+      break;
+    }
+  }
+
+  return m_found;
+}
+
+
+// -----------------------------------------------------------------------------
+// Simulate the calibration maneuver on a new vehicle with the candidate
+// settings, over the interval [t0, t0 + duration] where t0 is the simulation
+// time at the start of the trial. The trial is abandoned as soon as the
+// tolerance is exceeded. Otherwise, the maneuver is repeated (each time on a
+// new vehicle) and the cost is the median of the measured wall-clock times.
+// -----------------------------------------------------------------------------
+void ChSolverTuner::RunTrial(Trial& trial)
+{
+  std::vector<double> times;
+
+  trial.valid = true;
+
+  for (int r = 0; r < m_repeats && trial.valid; r++) {
+    ChSharedPtr<ChDataDriver> driver(new ChDataDriver(m_maneuver));
+    ChVehicleInstance instance(m_factory, driver);
+
+    ChVehicleSimulation& sim = instance.GetSimulation();
+    ChVehicle& vehicle = sim.GetVehicle();
+
+    trial.settings.max_recovery_speed = vehicle.GetSolverSettings().max_recovery_speed;
+    vehicle.SetSolverSettings(trial.settings);
+    vehicle.SetSolverTelemetry(true);
+
+    double t_end = sim.GetTime() + m_duration;
+
+    ChTimer<double> timer;
+    timer.start();
+
+    while (sim.GetTime() < t_end - 1e-10) {
+      sim.Step(std::min<double>(m_step, t_end - sim.GetTime()));
+      if (vehicle.GetSolverStats().max_violation > m_tolerance) {
+        trial.valid = false;
+        break;
+      }
+    }
+
+    timer.stop();
+    times.push_back(timer());
+
+    trial.max_violation = vehicle.GetSolverStats().max_violation;
+    trial.avg_iterations = vehicle.GetSolverStats().GetAverageIterations();
+  }
+
+  std::sort(times.begin(), times.end());
+  size_t n = times.size();
+  trial.cost = (n % 2) ? times[n / 2] : 0.5 * (times[n / 2 - 1] + times[n / 2]);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSolverTuner::LogResults() const
+{
+  GetLog() << "\n---- Solver calibration (tolerance: " << m_tolerance << ")\n\n";
+  for (size_t i = 0; i < m_trials.size(); i++) {
+    const Trial& t = m_trials[i];
+    GetLog() << ChVehicle::GetSolverTypeName(t.settings.type) << "  " << t.settings.max_iters_speed
+             << "  violation: " << t.max_violation << "  iterations: " << t.avg_iterations
+             << "  time: " << t.cost << (t.valid ? "" : "  (rejected)") << "\n";
+  }
+
+  if (m_found) {
+    GetLog() << "Recommended: " << ChVehicle::GetSolverTypeName(m_best.type)
+             << "  " << m_best.max_iters_speed << "\n";
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Locate the value of a top-level member of the JSON object in 'text'. On
+// success, 'key' is the offset of the member name (opening quote), and
+// [value, end) the extent of its value. If the member is not found, 'end' is
+// the offset of the closing brace of the object and 'value' is the offset
+// just past its last member (or its opening brace, if empty).
+// -----------------------------------------------------------------------------
+static size_t SkipString(const std::string& text, size_t i)
+{
+  // i is the offset of the opening quote; return the offset past the closing one
+  for (i++; i < text.size(); i++) {
+    if (text[i] == '\\')
+      i++;
+    else if (text[i] == '"')
+      return i + 1;
+  }
+  return text.size();
+}
+
+static bool FindTopLevelMember(const std::string& text,
+                               const char*        name,
+                               size_t&            key,
+                               size_t&            value,
+                               size_t&            end)
+{
+  std::string quoted = std::string("\"") + name + "\"";
+  int depth = 0;
+  size_t last = 0;       // offset past the last value at depth 1
+  size_t i = 0;
+
+  while (i < text.size()) {
+    char ch = text[i];
+    if (ch == '"') {
+      size_t next = SkipString(text, i);
+      if (depth == 1 && text.compare(i, next - i, quoted) == 0) {
+        size_t j = text.find_first_not_of(" \t\r\n", next);
+        if (j != std::string::npos && text[j] == ':') {
+          // found: the value extends to the next ',' or '}' at depth 1
+          key = i;
+          value = text.find_first_not_of(" \t\r\n", j + 1);
+          int d = 0;
+          for (j = value; j < text.size(); j++) {
+            if (text[j] == '"')
+              j = SkipString(text, j) - 1;
+            else if (text[j] == '{' || text[j] == '[')
+              d++;
+            else if (text[j] == '}' || text[j] == ']') {
+              if (d == 0)
+                break;
+              if (--d == 0) {
+                j++;
+                break;
+              }
+            }
+            else if (text[j] == ',' && d == 0)
+              break;
+          }
+          end = text.find_last_not_of(" \t\r\n", j - 1) + 1;
+          return true;
+        }
+      }
+      i = next;
+      if (depth == 1)
+        last = i;
+      continue;
+    }
+    if (ch == '{' || ch == '[') {
+      if (depth == 0)
+        last = i + 1;
+      depth++;
+    }
+    else if (ch == '}' || ch == ']') {
+      depth--;
+      if (depth == 1)
+        last = i + 1;
+      if (depth == 0) {
+        value = last;
+        end = i;
+        return false;
+      }
+    }
+    else if (depth == 1 && ch != ',' && ch != ':' && ch != ' ' && ch != '\t' && ch != '\r' && ch != '\n') {
+      last = i + 1;
+    }
+    i++;
+  }
+
+  end = value = std::string::npos;
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Read the vehicle specification and replace (or append) its "Solver" section.
+// Only the text of that section is changed; the rest of the file (member
+// order, formatting, whitespace) is kept as is.
+// -----------------------------------------------------------------------------
+bool ChSolverTuner::WriteRecommendation(const std::string& filename) const
+{
+  if (!m_found)
+    return false;
+
+  std::string text;
+
+  {
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (!fp)
+      return false;
+    char readBuffer[65536];
+    size_t n;
+    while ((n = fread(readBuffer, 1, sizeof(readBuffer), fp)) > 0)
+      text.append(readBuffer, n);
+    fclose(fp);
+  }
+
+  Document d;
+  d.Parse(text.c_str());
+  if (d.HasParseError() || !d.IsObject())
+    return false;
+
+  // Format the numbers as rapidjson does (shortest round-trip representation).
+  StringBuffer speed;
+  {
+    Writer<StringBuffer> writer(speed);
+    writer.Double(m_best.max_recovery_speed);
+  }
+
+  std::ostringstream solver;
+  solver << "\"Solver\":\n"
+         << "  {\n"
+         << "    \"Type\":                            \"" << ChVehicle::GetSolverTypeName(m_best.type) << "\",\n"
+         << "    \"Max Iterations Speed\":            " << m_best.max_iters_speed << ",\n"
+         << "    \"Max Iterations Stab\":             " << m_best.max_iters_stab << ",\n"
+         << "    \"Max Penetration Recovery Speed\":  " << speed.GetString() << "\n"
+         << "  }";
+
+  size_t key, value, end;
+  if (FindTopLevelMember(text, "Solver", key, value, end)) {
+    text.replace(key, end - key, solver.str());
+  }
+  else {
+    if (end == std::string::npos)
+      return false;
+    bool empty = (text[value - 1] == '{');
+    text.insert(value, (empty ? "\n  " : ",\n\n  ") + solver.str() + (empty ? "\n" : ""));
+  }
+
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if (!fp)
+    return false;
+  fwrite(text.data(), 1, text.size(), fp);
+  fclose(fp);
+
+  return true;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,120 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Automatic selection of solver settings for a vehicle.
+//
+// A short calibration maneuver is simulated with a number of candidate solver
+// settings (solver type and maximum number of iterations), each on a new
+// vehicle created by a ChVehicleFactory. For each solver type, the iteration
+// counts are tried in increasing order until the maximum joint constraint
+// violation over the maneuver stays below the specified tolerance. The
+// cheapest (in terms of median wall-clock time over several runs) acceptable
+// setting is recommended and can be written to the "Solver" section of a
+// vehicle JSON specification file (which is read by the Vehicle class).
+//
+// =============================================================================
+
+#ifndef CH_SOLVER_TUNER_H
+#define CH_SOLVER_TUNER_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChVehicleFactory.h"
+#include "subsys/driver/ChDataDriver.h"
+
+namespace chrono {
+
+///
+/// Auto-tuning harness for the vehicle solver settings.
+///
+class CH_SUBSYS_API ChSolverTuner
+{
+public:
+
+  /// Outcome of the calibration run for one candidate setting.
+  struct Trial {
+    ChVehicle::SolverSettings  settings;       ///< candidate solver settings
+    bool                       valid;          ///< true if the violation stayed below tolerance
+    double                     max_violation;  ///< maximum joint constraint violation
+    double                     avg_iterations; ///< average solver iterations per step
+    double                     cost;           ///< wall-clock time for the maneuver (median over repeats)
+  };
+
+  ChSolverTuner(
+    ChVehicleFactory&                        factory,    ///< [in] factory used to create the vehicles
+    const std::vector<ChDataDriver::Entry>&  maneuver,   ///< [in] calibration maneuver (driver inputs)
+    double                                   duration    ///< [in] maneuver duration
+    );
+
+  ~ChSolverTuner() {}
+
+  /// Set the simulation step size (default: 1e-3).
+  void SetStepsize(double step) { m_step = step; }
+
+  /// Set the tolerance on the maximum joint constraint violation (default: 1e-3).
+  void SetTolerance(double tolerance) { m_tolerance = tolerance; }
+
+  /// Set the number of timed runs of each acceptable candidate (default: 3).
+  /// The cost of a candidate is the median of the measured times.
+  void SetRepeats(int repeats) { m_repeats = std::max(repeats, 1); }
+
+  /// Set the candidate solver types (default: SOR, SYMMSOR, BARZILAIBORWEIN, APGD).
+  void SetSolverTypes(const std::vector<ChSystem::eCh_lcpSolver>& types) { m_types = types; }
+
+  /// Set the candidate iteration counts (default: 20, 40, 60, 80, 100, 150, 200).
+  void SetIterationCounts(const std::vector<int>& iterations) { m_iterations = iterations; }
+
+  /// Run the calibration. Return false if no candidate setting was acceptable.
+  bool Run();
+
+  /// Get the recommended settings (available after a successful Run).
+  const ChVehicle::SolverSettings& GetRecommendation() const { return m_best; }
+
+  /// Get the outcome of all calibration runs.
+  const std::vector<Trial>& GetTrials() const { return m_trials; }
+
+  /// Log the calibration results.
+  void LogResults() const;
+
+  /// Write the recommended settings in the "Solver" section of the specified
+  /// vehicle JSON file. Only the text of an existing "Solver" section is
+  /// replaced (or a new section appended); the rest of the file is unchanged.
+  bool WriteRecommendation(const std::string& filename) const;
+
+private:
+
+  void RunTrial(Trial& trial);
+
+  ChVehicleFactory&                     m_factory;     ///< factory for creating vehicles
+  std::vector<ChDataDriver::Entry>      m_maneuver;    ///< calibration maneuver
+  double                                m_duration;    ///< maneuver duration
+  double                                m_step;        ///< simulation step size
+  double                                m_tolerance;   ///< constraint violation tolerance
+  std::vector<ChSystem::eCh_lcpSolver>  m_types;       ///< candidate solver types
+  std::vector<int>                      m_iterations;  ///< candidate iteration counts
+  int                                   m_repeats;     ///< number of timed runs per candidate
+  std::vector<Trial>                    m_trials;      ///< calibration results
+  ChVehicle::SolverSettings             m_best;        ///< recommended settings
+  bool                                  m_found;       ///< true if a recommendation exists
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,130 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// In-memory binary buffer used to take snapshots of the state of vehicle
+// modules and to restore them later.
+//
+// =============================================================================
+
+#ifndef CH_STATE_BUFFER_H
+#define CH_STATE_BUFFER_H
+
+#include <vector>
+#include <cstring>
+
+namespace chrono {
+
+///
+/// Binary buffer for module state snapshots.
+/// Values are written and read back in the same order, as raw bytes. Only plain
+/// data types (numbers, ChVector, ChQuaternion, ChCoordsys, and structures of
+/// these) may be stored. Clearing the buffer keeps its storage, so that taking
+/// repeated snapshots into the same buffer does not allocate memory.
+/// A buffer can also be used as a read-only view of the contents of another
+/// buffer (see View()), so that several readers can restore from the same
+/// snapshot without copying it.
+///
+class ChStateBuffer
+{
+public:
+
+  ChStateBuffer() : m_view(0), m_pos(0) {}
+
+  /// Discard the buffer contents (but keep the allocated storage).
+  /// This also ends any view set with View().
+  void Clear() { m_data.clear(); m_view = 0; m_pos = 0; }
+
+  /// Read from the contents of the specified buffer, without copying them,
+  /// starting at its beginning. The source buffer must not be modified or
+  /// destroyed while the view is in use. Call Clear() before writing again to
+  /// this buffer.
+  void View(const ChStateBuffer& source) { m_view = &source.m_data; m_pos = 0; }
+
+  /// Reset the read position to the beginning of the buffer.
+  void Rewind() { m_pos = 0; }
+
+  /// Pre-allocate storage for the specified number of bytes.
+  void Reserve(size_t size) { m_data.reserve(size); }
+
+  /// Get the number of bytes currently stored.
+  size_t GetSize() const { return Data().size(); }
+
+  /// Get the number of bytes left to read.
+  size_t GetRemaining() const { return Data().size() - m_pos; }
+
+  /// Return true if all data was read back.
+  bool AtEnd() const { return m_pos == Data().size(); }
+
+  /// Append the specified value to the buffer.
+  template <typename T>
+  void Write(const T& val)
+  {
+    size_t pos = m_data.size();
+    m_data.resize(pos + sizeof(T));
+    std::memcpy(&m_data[pos], &val, sizeof(T));
+  }
+
+  /// Append an array of values to the buffer.
+  template <typename T>
+  void WriteArray(const T* vals, size_t num)
+  {
+    if (num == 0)
+      return;
+    size_t pos = m_data.size();
+    m_data.resize(pos + num * sizeof(T));
+    std::memcpy(&m_data[pos], vals, num * sizeof(T));
+  }
+
+  /// Read the next value from the buffer.
+  /// Return false if there is not enough data left.
+  template <typename T>
+  bool Read(T& val)
+  {
+    const std::vector<char>& data = Data();
+    if (m_pos + sizeof(T) > data.size())
+      return false;
+    std::memcpy(&val, &data[m_pos], sizeof(T));
+    m_pos += sizeof(T);
+    return true;
+  }
+
+  /// Read the next array of values from the buffer.
+  /// Return false if there is not enough data left.
+  template <typename T>
+  bool ReadArray(T* vals, size_t num)
+  {
+    if (num == 0)
+      return true;
+    const std::vector<char>& data = Data();
+    if (m_pos + num * sizeof(T) > data.size())
+      return false;
+    std::memcpy(vals, &data[m_pos], num * sizeof(T));
+    m_pos += num * sizeof(T);
+    return true;
+  }
+
+private:
+
+  const std::vector<char>& Data() const { return m_view ? *m_view : m_data; }
+
+  std::vector<char>        m_data;   ///< buffer contents
+  const std::vector<char>* m_view;   ///< contents of the viewed buffer (NULL if none)
+  size_t                   m_pos;    ///< current read position
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -20,6 +20,7 @@
 #define CH_STEERING_H
 
 #include <string>
+#include <vector>
 
 #include "core/ChShared.h"
 #include "physics/ChSystem.h"
@@ -76,6 +77,13 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations() {}
 
+  /// Append the constraints of the steering mechanism to the given list.
+  /// Used to evaluate per-joint violation metrics (see ChConstraintMetrics)
+  /// without going through the text output of LogConstraintViolations.
+  virtual void GetConstraintLinks(
+    std::vector<ChLink*>& links   ///< [out] list of constraints
+    ) const {}
+
 protected:
 
   std::string  m_name;          ///< name of the subsystem
@@ -111,6 +111,24 @@ struct ChTireForce {
 /// Vector of tire force structures.
 typedef std::vector<ChTireForce> ChTireForces;
 
+///
+/// Structure with a snapshot of the vehicle state.
+/// All per-wheel quantities are stored in contiguous arrays, indexed by wheel
+/// ID. Spring and shock quantities are zero for suspensions that do not have
+/// such elements.
+///
+struct ChVehicleStateSnapshot {
+  double              time;              ///< simulation time at which the snapshot was taken
+  ChBodyState         chassis;           ///< state of the chassis reference frame
+  double              speed;             ///< vehicle speed (at the chassis reference frame)
+  double              driveshaft_speed;  ///< driveshaft angular speed
+  ChWheelStates       wheel_states;      ///< wheel states
+  std::vector<double> spring_force;      ///< spring forces
+  std::vector<double> spring_length;     ///< spring lengths
+  std::vector<double> shock_force;       ///< shock forces
+  std::vector<double> shock_velocity;    ///< shock velocities
+};
+
 
 } // end namespace chrono
 
@@ -85,6 +85,24 @@ public:
   /// Get the angular speed of the axle on the specified side.
   double GetAxleSpeed(ChVehicleSide side) const { return m_axle[side]->GetPos_dt(); }
 
+  /// Return true if this suspension has separate spring and shock elements,
+  /// i.e. if the spring and shock getters below report actual values.
+  virtual bool HasSpringShock() const { return false; }
+
+  /// Get the force in the spring element on the specified side.
+  /// Return zero if this suspension has no separate spring element.
+  virtual double GetSpringForce(ChVehicleSide side) const { return 0; }
+
+  /// Get the current length of the spring element on the specified side.
+  virtual double GetSpringLength(ChVehicleSide side) const { return 0; }
+
+  /// Get the force in the shock (damper) element on the specified side.
+  /// Return zero if this suspension has no separate shock element.
+  virtual double GetShockForce(ChVehicleSide side) const { return 0; }
+
+  /// Get the current deformation velocity of the shock element on the specified side.
+  virtual double GetShockVelocity(ChVehicleSide side) const { return 0; }
+
   /// Apply the provided tire forces.
   /// The given tire force and moment is applied to the specified (left or
   /// right) spindle body.  This function provides the interface to the tire
@@ -120,6 +138,14 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations(ChVehicleSide side) {}
 
+  /// Append the constraints of the specified side to the given list.
+  /// Used to evaluate per-joint violation metrics (see ChConstraintMetrics)
+  /// without going through the text output of LogConstraintViolations.
+  virtual void GetConstraintLinks(
+    ChVehicleSide         side,   ///< [in] indicates the suspension side
+    std::vector<ChLink*>& links   ///< [out] list of constraints
+    ) const {}
+
 protected:
 
   std::string                      m_name;               ///< name of the subsystem
@@ -0,0 +1,355 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Asynchronous writer for simulation telemetry.
+//
+// The ring buffer indices are free-running counters: the producer only writes
+// m_head and the consumer only writes m_tail. A full memory barrier separates
+// the record contents from the index update that publishes (or releases) it.
+//
+// =============================================================================
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <pthread.h>
+# include <sched.h>
+# include <unistd.h>
+#endif
+
+#include "core/ChLog.h"
+
+#include "subsys/ChTelemetryWriter.h"
+#include "subsys/ChTracer.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Platform-specific helpers
+// -----------------------------------------------------------------------------
+static inline void MemoryFence()
+{
+#ifdef _WIN32
+  MemoryBarrier();
+#else
+  __sync_synchronize();
+#endif
+}
+
+static inline void YieldThread()
+{
+#ifdef _WIN32
+  Sleep(0);
+#else
+  sched_yield();
+#endif
+}
+
+static inline void SleepThread()
+{
+#ifdef _WIN32
+  Sleep(1);
+#else
+  usleep(1000);
+#endif
+}
+
+struct ChTelemetryWriter::ThreadData {
+#ifdef _WIN32
+  HANDLE handle;
+  static DWORD WINAPI Run(LPVOID arg) { ChTelemetryWriter::ThreadFunc(arg); return 0; }
+#else
+  pthread_t handle;
+#endif
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChTelemetryWriter::ChTelemetryWriter()
+: m_buffer(NULL),
+  m_mask(0),
+  m_head(0),
+  m_tail(0),
+  m_stop(false),
+  m_running(false),
+  m_thread(new ThreadData),
+  m_num_streams(0),
+  m_num_pushed(0),
+  m_num_rejected(0),
+  m_num_sync(0),
+  m_num_stalls(0),
+  m_stall_time(0),
+  m_max_occupancy(0)
+{
+}
+
+ChTelemetryWriter::~ChTelemetryWriter()
+{
+  Stop();
+
+  for (int i = 0; i < m_num_streams; i++)
+    delete m_streams[i].file;
+
+  delete [] m_buffer;
+  delete m_thread;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChTelemetryWriter::AddStream(const std::string& filename,
+                                 const std::string& header,
+                                 char               delim)
+{
+  if (m_num_streams >= MAX_STREAMS) {
+    GetLog() << "ChTelemetryWriter: too many streams (" << filename.c_str() << ")\n";
+    return -1;
+  }
+
+  std::ofstream* file = new std::ofstream(filename.c_str(), std::ios::out);
+  if (!(*file)) {
+    GetLog() << "ChTelemetryWriter: cannot open " << filename.c_str() << "\n";
+    delete file;
+    return -1;
+  }
+
+  // Values are written with enough digits to be read back exactly.
+  file->precision(17);
+
+  if (!header.empty())
+    *file << header << "\n";
+
+  m_streams[m_num_streams].file = file;
+  m_streams[m_num_streams].delim = delim;
+
+  // Publish the new stream before any record referring to it.
+  MemoryFence();
+
+  return m_num_streams++;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChTelemetryWriter::Start(int capacity)
+{
+  if (m_running)
+    return true;
+
+  unsigned long size = 2;
+  while (size < (unsigned long)capacity)
+    size *= 2;
+
+  // The buffer is empty here, so the running indices remain valid.
+  if (!m_buffer || size != m_mask + 1) {
+    delete [] m_buffer;
+    m_buffer = new Record[size];
+    m_mask = size - 1;
+  }
+  m_stop = false;
+
+  MemoryFence();
+
+#ifdef _WIN32
+  m_thread->handle = CreateThread(NULL, 0, ThreadData::Run, this, 0, NULL);
+  m_running = (m_thread->handle != NULL);
+#else
+  m_running = (pthread_create(&m_thread->handle, NULL, ThreadFunc, this) == 0);
+#endif
+
+  if (!m_running)
+    GetLog() << "ChTelemetryWriter: cannot start writer thread; records will be written synchronously\n";
+
+  return m_running;
+}
+
+void ChTelemetryWriter::Stop()
+{
+  if (m_running) {
+    MemoryFence();
+    m_stop = true;
+
+#ifdef _WIN32
+    WaitForSingleObject(m_thread->handle, INFINITE);
+    CloseHandle(m_thread->handle);
+#else
+    pthread_join(m_thread->handle, NULL);
+#endif
+
+    m_running = false;
+  }
+
+  for (int i = 0; i < m_num_streams; i++)
+    m_streams[i].file->flush();
+}
+
+
+// -----------------------------------------------------------------------------
+// Producer side. If the buffer is full, wait for the writer thread rather than
+// dropping the record, and account for the time spent waiting. Records which
+// do not fit in a buffer slot are rejected rather than silently truncated.
+// -----------------------------------------------------------------------------
+bool ChTelemetryWriter::Push(int           stream,
+                             double        time,
+                             int           num_values,
+                             const double* values)
+{
+  if (stream < 0 || stream >= m_num_streams) {
+    GetLog() << "ChTelemetryWriter: invalid stream " << stream << "\n";
+    return false;
+  }
+
+  if (num_values > MAX_VALUES) {
+    GetLog() << "ChTelemetryWriter: record with " << num_values << " values rejected (limit "
+             << (int)MAX_VALUES << ")\n";
+    m_num_rejected++;
+    return false;
+  }
+
+  m_num_pushed++;
+
+  if (!m_running) {
+    Record rec;
+    rec.stream = stream;
+    rec.num_values = num_values;
+    rec.time = time;
+    for (int i = 0; i < num_values; i++)
+      rec.values[i] = values[i];
+    WriteRecord(rec);
+    m_num_sync++;
+    return true;
+  }
+
+  unsigned long head = m_head;
+  unsigned long pending = head - m_tail;
+
+  if (pending > m_mask) {
+    m_num_stalls++;
+    double start = ChTracer::GetTime();
+    do {
+      YieldThread();
+      pending = head - m_tail;
+    } while (pending > m_mask);
+    m_stall_time += ChTracer::GetTime() - start;
+  }
+
+  if ((long)pending + 1 > m_max_occupancy)
+    m_max_occupancy = (long)pending + 1;
+
+  // The slot at 'head' is no longer read by the consumer.
+  MemoryFence();
+
+  Record& rec = m_buffer[head & m_mask];
+  rec.stream = stream;
+  rec.num_values = num_values;
+  rec.time = time;
+  for (int i = 0; i < num_values; i++)
+    rec.values[i] = values[i];
+
+  MemoryFence();
+  m_head = head + 1;
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Consumer side. Runs until a stop was requested and the buffer is empty.
+// -----------------------------------------------------------------------------
+void* ChTelemetryWriter::ThreadFunc(void* arg)
+{
+  static_cast<ChTelemetryWriter*>(arg)->Drain();
+  return NULL;
+}
+
+void ChTelemetryWriter::Drain()
+{
+  unsigned long tail = m_tail;
+  int idle = 0;
+
+  while (true) {
+    bool stop = m_stop;
+    MemoryFence();
+    unsigned long head = m_head;
+
+    // Yield for a while before going to sleep, so that a burst of records
+    // does not find the writer asleep.
+    if (tail == head) {
+      if (stop)
+        break;
+      if (++idle < 100)
+        YieldThread();
+      else
+        SleepThread();
+      continue;
+    }
+
+    idle = 0;
+    MemoryFence();
+
+    while (tail != head) {
+      WriteRecord(m_buffer[tail & m_mask]);
+      tail++;
+      MemoryFence();
+      m_tail = tail;
+    }
+  }
+}
+
+void ChTelemetryWriter::WriteRecord(const Record& rec)
+{
+  std::ofstream& file = *m_streams[rec.stream].file;
+  char delim = m_streams[rec.stream].delim;
+
+  file << rec.time;
+  for (int i = 0; i < rec.num_values; i++)
+    file << delim << rec.values[i];
+  file << "\n";
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChTelemetryWriter::Stats ChTelemetryWriter::GetStats() const
+{
+  Stats stats;
+  stats.num_pushed = m_num_pushed;
+  stats.num_rejected = m_num_rejected;
+  stats.num_written = m_num_sync + (long)m_tail;
+  stats.num_stalls = m_num_stalls;
+  stats.stall_time = m_stall_time;
+  stats.max_occupancy = m_max_occupancy;
+
+  return stats;
+}
+
+void ChTelemetryWriter::LogStats() const
+{
+  Stats stats = GetStats();
+
+  GetLog() << "\n---- Telemetry writer\n";
+  GetLog() << "  records pushed:   " << (int)stats.num_pushed << "\n";
+  GetLog() << "  records rejected: " << (int)stats.num_rejected << "\n";
+  GetLog() << "  records written:  " << (int)stats.num_written << "\n";
+  GetLog() << "  buffer capacity:  " << (int)(m_mask + 1) << "\n";
+  GetLog() << "  max occupancy:    " << (int)stats.max_occupancy << "\n";
+  GetLog() << "  producer stalls:  " << (int)stats.num_stalls << "\n";
+  GetLog() << "  stall time (s):   " << stats.stall_time << "\n";
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,155 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Asynchronous writer for simulation telemetry.
+//
+// The simulation thread pushes fixed-size records (a stream identifier, the
+// simulation time, and up to MAX_VALUES values) into a single-producer /
+// single-consumer lock-free ring buffer. A background thread drains the buffer,
+// formats the records, and appends them to the output file of their stream.
+//
+// Records with more than MAX_VALUES values are rejected (and reported in the
+// log); all other records are never dropped: if the buffer is full, the producer waits for the
+// writer thread to free up space. The number of such stalls and the time spent
+// waiting are reported as back-pressure statistics. If the writer thread is not
+// running, records are written synchronously.
+//
+// Only one thread may call Push() at a time.
+//
+// Driver inputs (ChDriver::LogInit), Pacejka tire data
+// (ChPacejkaTire::SetTelemetryWriter) and the suspension test rig log
+// (SuspensionTest::Save_DebugLog) can be recorded through a writer. The PovRay
+// output of utils::WriteShapesPovray is not: it writes one file per frame with
+// a variable number of shape records mixing numbers and mesh names, which do
+// not fit fixed-size numeric records.
+//
+// =============================================================================
+
+#ifndef CH_TELEMETRY_WRITER_H
+#define CH_TELEMETRY_WRITER_H
+
+#include <string>
+#include <fstream>
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+///
+/// Background writer of telemetry records.
+///
+class CH_SUBSYS_API ChTelemetryWriter
+{
+public:
+
+  static const int MAX_VALUES = 64;    ///< maximum number of values per record
+  static const int MAX_STREAMS = 32;   ///< maximum number of output streams
+
+  /// Back-pressure and throughput statistics.
+  struct Stats {
+    long    num_pushed;      ///< number of records pushed by the producer
+    long    num_rejected;    ///< number of records rejected (too many values)
+    long    num_written;     ///< number of records written by the writer thread
+    long    num_stalls;      ///< number of pushes which found the buffer full
+    double  stall_time;      ///< total time the producer waited for free space (s)
+    long    max_occupancy;   ///< largest number of pending records seen by the producer
+  };
+
+  ChTelemetryWriter();
+  ~ChTelemetryWriter();
+
+  /// Create a new output stream and write its (optional) header line.
+  /// Values are written with 17 significant digits (full double precision).
+  /// Streams can be added before or after Start(), but only from the producer
+  /// thread. Return the stream identifier, or -1 on failure.
+  int AddStream(
+    const std::string& filename,       ///< [in] name of the output file
+    const std::string& header = "",    ///< [in] header line (without newline)
+    char               delim = '\t'    ///< [in] value separator
+    );
+
+  /// Allocate the ring buffer and start the writer thread.
+  /// The capacity is rounded up to a power of two. Return false if the thread
+  /// could not be started (records are then written synchronously).
+  bool Start(int capacity = 4096);
+
+  /// Wait until all pending records are written, stop the writer thread, and
+  /// flush all output streams.
+  void Stop();
+
+  /// Return true if the writer thread is running.
+  bool IsRunning() const { return m_running; }
+
+  /// Push a record for the specified stream.
+  /// Return false (and report in the log) if the stream identifier is invalid
+  /// or the record has more than MAX_VALUES values; the record is then not
+  /// written.
+  bool Push(
+    int           stream,      ///< [in] stream identifier (as returned by AddStream)
+    double        time,        ///< [in] simulation time
+    int           num_values,  ///< [in] number of values
+    const double* values       ///< [in] record values
+    );
+
+  /// Get the current statistics.
+  Stats GetStats() const;
+
+  /// Log the current statistics.
+  void LogStats() const;
+
+private:
+
+  struct Record {
+    int     stream;
+    int     num_values;
+    double  time;
+    double  values[MAX_VALUES];
+  };
+
+  struct Stream {
+    std::ofstream*  file;
+    char            delim;
+  };
+
+  struct ThreadData;
+
+  void WriteRecord(const Record& rec);
+  void Drain();
+
+  static void* ThreadFunc(void* arg);
+
+  Record*                 m_buffer;                 ///< ring buffer of records
+  unsigned long           m_mask;                   ///< ring buffer capacity minus one
+  volatile unsigned long  m_head;                   ///< number of records pushed (producer)
+  volatile unsigned long  m_tail;                   ///< number of records written (consumer)
+  volatile bool           m_stop;                   ///< request to stop the writer thread
+  bool                    m_running;                ///< writer thread running?
+  ThreadData*             m_thread;                 ///< platform-specific thread handle
+
+  Stream                  m_streams[MAX_STREAMS];   ///< output streams
+  int                     m_num_streams;            ///< number of output streams
+
+  long                    m_num_pushed;             ///< total records pushed
+  long                    m_num_rejected;           ///< records rejected (too many values)
+  long                    m_num_sync;               ///< records written synchronously
+  long                    m_num_stalls;             ///< pushes which found the buffer full
+  double                  m_stall_time;             ///< total producer wait time
+  long                    m_max_occupancy;          ///< largest number of pending records
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,85 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thread slot indices for lock-free per-thread data, and a simple spin lock.
+//
+// =============================================================================
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <sched.h>
+#endif
+
+#include "subsys/ChThreadSlot.h"
+
+#ifdef _MSC_VER
+# define CH_THREAD_LOCAL __declspec(thread)
+#else
+# define CH_THREAD_LOCAL __thread
+#endif
+
+
+namespace chrono {
+
+
+static CH_THREAD_LOCAL int  thread_slot = -1;   // slot of the calling thread (-1: not yet assigned)
+static volatile long        num_slots = 0;      // number of slots assigned
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int ChThreadSlot::Get()
+{
+  if (thread_slot < 0) {
+#ifdef _WIN32
+    thread_slot = (int)InterlockedIncrement(&num_slots) - 1;
+#else
+    thread_slot = (int)__sync_add_and_fetch(&num_slots, 1) - 1;
+#endif
+  }
+
+  return thread_slot;
+}
+
+int ChThreadSlot::GetNumAssigned()
+{
+  return (int)num_slots;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSpinLock::Lock()
+{
+#ifdef _WIN32
+  while (InterlockedExchange(&m_flag, 1) != 0)
+    Sleep(0);
+#else
+  while (__sync_lock_test_and_set(&m_flag, 1) != 0)
+    sched_yield();
+#endif
+}
+
+void ChSpinLock::Unlock()
+{
+#ifdef _WIN32
+  InterlockedExchange(&m_flag, 0);
+#else
+  __sync_lock_release(&m_flag);
+#endif
+}
+
+
+} // end namespace chrono
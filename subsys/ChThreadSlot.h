@@ -0,0 +1,70 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Thread slot indices for lock-free per-thread data, and a simple spin lock.
+//
+// Each OS thread (OpenMP worker, background writer thread, or any other user
+// thread) is assigned a unique index the first time it asks for one, from a
+// process-wide atomic counter. The index is kept in thread-local storage, so
+// that later calls are cheap. Indices are never reused; users with a fixed
+// number of per-thread slots must handle indices beyond that number (e.g. with
+// a shared slot protected by a ChSpinLock).
+//
+// =============================================================================
+
+#ifndef CH_THREAD_SLOT_H
+#define CH_THREAD_SLOT_H
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+///
+/// Per-thread slot indices.
+///
+class CH_SUBSYS_API ChThreadSlot
+{
+public:
+
+  /// Return the slot index of the calling thread (0, 1, 2, ...).
+  /// A new index is assigned at the first call from each thread.
+  static int Get();
+
+  /// Return the number of slot indices assigned so far.
+  static int GetNumAssigned();
+};
+
+
+///
+/// Spin lock, for short critical sections on rarely contended data.
+///
+class CH_SUBSYS_API ChSpinLock
+{
+public:
+
+  ChSpinLock() : m_flag(0) {}
+
+  void Lock();
+  void Unlock();
+
+private:
+
+  volatile long m_flag;
+};
+
+
+} // end namespace chrono
+
+
+#endif
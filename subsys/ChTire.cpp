@@ -22,6 +22,7 @@
 #include "physics/ChSystem.h"
 
 #include "subsys/ChTire.h"
+#include "subsys/ChPerfCounters.h"
 
 
 namespace chrono {
@@ -48,6 +49,8 @@ bool ChTire::disc_terrain_contact(const ChVector<>& disc_center,
                                   ChCoordsys<>&     contact,
                                   double&           depth)
 {
+  CH_PERF_SCOPE("ChTire::disc_terrain_contact");
+
   // Find terrain height below disc center. There is no contact if the disc
   // center is below the terrain or farther away by more than its radius.
   double hc = m_terrain.GetHeight(disc_center.x, disc_center.y);
@@ -29,6 +29,7 @@
 
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChSubsysDefs.h"
+#include "subsys/ChStateBuffer.h"
 #include "subsys/ChTerrain.h"
 
 namespace chrono {
@@ -72,6 +73,19 @@ public:
   /// force one the wheel body.
   virtual ChTireForce GetTireForce() const = 0;
 
+  /// Append the internal state of this tire to the specified buffer.
+  /// The base class implementation does nothing (stateless tire).
+  virtual void Snapshot(ChStateBuffer& buffer) const {}
+
+  /// Restore the internal state of this tire from the specified buffer.
+  /// Return false if the buffer does not contain a compatible state.
+  virtual bool Restore(ChStateBuffer& buffer) { return true; }
+
+  /// Reset the internal (transient) state of this tire to its initial value.
+  /// The current tire force is kept; it is recalculated at the next step.
+  /// The base class implementation does nothing (stateless tire).
+  virtual void ResetState() {}
+
 protected:
 
   /// Perform disc-terrain collision detection.
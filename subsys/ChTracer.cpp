@@ -0,0 +1,189 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Timeline tracer for the vehicle simulation loop.
+//
+// =============================================================================
+
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
+#include "subsys/ChTracer.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChTracer& ChTracer::GetInstance()
+{
+  static ChTracer tracer;
+  return tracer;
+}
+
+ChTracer::ChTracer()
+: m_enabled(false),
+  m_capacity(0),
+  m_start(0)
+{
+  for (int t = 0; t <= MAX_THREADS; t++) {
+    m_buffers[t].events = NULL;
+    m_buffers[t].count = 0;
+  }
+}
+
+ChTracer::~ChTracer()
+{
+  for (int t = 0; t <= MAX_THREADS; t++)
+    delete [] m_buffers[t].events;
+}
+
+double ChTracer::GetTime()
+{
+#ifdef _WIN32
+  static LARGE_INTEGER frequency = { 0 };
+  if (frequency.QuadPart == 0)
+    QueryPerformanceFrequency(&frequency);
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Buffers are (re)allocated only here, never while recording.
+// -----------------------------------------------------------------------------
+void ChTracer::Enable(int capacity)
+{
+  m_enabled = false;
+
+  if (capacity != m_capacity) {
+    for (int t = 0; t <= MAX_THREADS; t++) {
+      delete [] m_buffers[t].events;
+      m_buffers[t].events = new Event[capacity];
+    }
+    m_capacity = capacity;
+  }
+
+  for (int t = 0; t <= MAX_THREADS; t++)
+    m_buffers[t].count = 0;
+
+  m_start = GetTime();
+  m_enabled = (capacity > 0);
+}
+
+void ChTracer::Record(int    id,
+                      double start,
+                      double duration)
+{
+  if (!m_enabled || id < 0)
+    return;
+
+  int thread = ChThreadSlot::Get();
+
+  if (thread < MAX_THREADS) {
+    Store(m_buffers[thread], id, start, duration);
+    return;
+  }
+
+  m_overflow_lock.Lock();
+  Store(m_buffers[MAX_THREADS], id, start, duration);
+  m_overflow_lock.Unlock();
+}
+
+void ChTracer::Store(Buffer& buffer,
+                     int     id,
+                     double  start,
+                     double  duration)
+{
+  Event& e = buffer.events[buffer.count % m_capacity];
+  e.id = id;
+  e.start = start;
+  e.duration = duration;
+  buffer.count++;
+}
+
+long ChTracer::GetNumEvents() const
+{
+  long num = 0;
+  for (int t = 0; t <= MAX_THREADS; t++)
+    num += m_buffers[t].count;
+  return num;
+}
+
+long ChTracer::GetNumOverwritten() const
+{
+  long num = 0;
+  for (int t = 0; t <= MAX_THREADS; t++) {
+    if (m_buffers[t].count > m_capacity)
+      num += m_buffers[t].count - m_capacity;
+  }
+  return num;
+}
+
+
+// -----------------------------------------------------------------------------
+// Events are written as complete ("X") events, with times in microseconds
+// relative to the time tracing was enabled. Each thread buffer is written in
+// chronological order, starting with the oldest event still available.
+// -----------------------------------------------------------------------------
+bool ChTracer::WriteChromeTrace(const std::string& filename) const
+{
+  std::ofstream ofile(filename.c_str());
+  if (!ofile.is_open())
+    return false;
+
+  std::vector<ChProfiler::Stats> stats;
+  ChProfiler::GetInstance().GetStats(stats);
+
+  ofile.precision(15);
+  ofile << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+
+  bool first = true;
+
+  for (int t = 0; t <= MAX_THREADS; t++) {
+    const Buffer& buffer = m_buffers[t];
+    long begin = (buffer.count > m_capacity) ? buffer.count - m_capacity : 0;
+
+    for (long k = begin; k < buffer.count; k++) {
+      const Event& e = buffer.events[k % m_capacity];
+      const char* name = (e.id < (int)stats.size()) ? stats[e.id].name.c_str() : "unknown";
+      ofile << (first ? "" : ",\n")
+            << "{\"name\": \"" << name << "\", \"cat\": \"vehicle\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << t
+            << ", \"ts\": " << 1e6 * (e.start - m_start) << ", \"dur\": " << 1e6 * e.duration << "}";
+      first = false;
+    }
+  }
+
+  ofile << std::endl << "]}" << std::endl;
+
+  ofile.close();
+  return true;
+}
+
+
+} // end namespace chrono
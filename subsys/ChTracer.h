@@ -0,0 +1,114 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Timeline tracer for the vehicle simulation loop.
+//
+// When enabled, every profiled scope (see ChProfiler) also records a trace
+// event (region, start time, duration) in a fixed-capacity ring buffer owned by
+// the calling OS thread (see ChThreadSlot), so no locking is needed. Threads
+// beyond MAX_THREADS share one additional buffer, which is written under a
+// lock (its events are reported with thread id MAX_THREADS).
+//
+// When a buffer is full, the oldest events are overwritten, so that the tracer
+// can be left on in long runs and still provide the most recent timeline.
+//
+// The recorded events can be written in the Chrome trace-event JSON format
+// (viewable with chrome://tracing or Perfetto).
+//
+// Tracing requires the library to be configured with ENABLE_PROFILING; when
+// the tracer is not enabled at run time, the cost is a single test per scope.
+//
+// =============================================================================
+
+#ifndef CH_TRACER_H
+#define CH_TRACER_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChThreadSlot.h"
+
+namespace chrono {
+
+///
+/// Recorder of trace events (singleton).
+///
+class CH_SUBSYS_API ChTracer
+{
+public:
+
+  static const int MAX_THREADS = 32;    ///< number of per-thread buffers (excluding the shared overflow buffer)
+
+  /// Get the tracer instance.
+  static ChTracer& GetInstance();
+
+  /// Return the current time, in seconds, from a monotonic clock.
+  static double GetTime();
+
+  /// Enable tracing, with the given capacity (number of events) per thread.
+  /// Any previously recorded events are discarded.
+  void Enable(int capacity = 100000);
+
+  /// Disable tracing. Recorded events are kept until the next Enable().
+  void Disable() { m_enabled = false; }
+
+  /// Return true if tracing is enabled.
+  bool IsEnabled() const { return m_enabled; }
+
+  /// Record an event for the specified profiling region.
+  void Record(
+    int     id,         ///< [in] profiling region identifier
+    double  start,      ///< [in] start time (as returned by GetTime)
+    double  duration    ///< [in] event duration (s)
+    );
+
+  /// Get the number of events recorded by all threads (including overwritten ones).
+  long GetNumEvents() const;
+
+  /// Get the number of events lost because a buffer was full.
+  long GetNumOverwritten() const;
+
+  /// Write the recorded events in the Chrome trace-event JSON format.
+  bool WriteChromeTrace(const std::string& filename) const;
+
+private:
+
+  struct Event {
+    int     id;
+    double  start;
+    double  duration;
+  };
+
+  struct Buffer {
+    Event*  events;
+    long    count;   ///< number of events recorded (the next one goes at count % capacity)
+  };
+
+  ChTracer();
+  ~ChTracer();
+
+  void Store(Buffer& buffer, int id, double start, double duration);
+
+  bool    m_enabled;                 ///< tracing enabled?
+  int     m_capacity;                ///< capacity of each per-thread buffer
+  double  m_start;                   ///< time at which tracing was enabled
+  Buffer      m_buffers[MAX_THREADS + 1];  ///< per-thread event buffers (the last one is shared)
+  ChSpinLock  m_overflow_lock;             ///< lock for the shared buffer
+};
+
+
+} // end namespace chrono
+
+
+#endif
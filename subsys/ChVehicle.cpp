@@ -17,9 +17,19 @@
 // =============================================================================
 
 #include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "physics/ChLinkDistance.h"
+#include "physics/ChShaft.h"
+#include "physics/ChContactContainerBase.h"
+#include "lcp/ChLcpIterativeSolver.h"
 
 #include "subsys/ChVehicle.h"
+#include "subsys/ChConstraintMetrics.h"
 #include "subsys/ChDriveline.h"
+#include "subsys/ChProfiler.h"
+#include "subsys/ChPerfCounters.h"
 
 
 namespace chrono {
@@ -31,7 +41,17 @@ namespace chrono {
 // -----------------------------------------------------------------------------
 ChVehicle::ChVehicle()
 : m_ownsSystem(true),
-  m_stepsize(1e-3)
+  m_stepsize(1e-3),
+  m_fixed_stepsize(1e-3),
+  m_adaptive(false),
+  m_min_step(1e-5),
+  m_max_step(5e-3),
+  m_max_violation(1e-3),
+  m_max_force_change(0.25),
+  m_max_penetration(5e-3),
+  m_penetration(0),
+  m_num_smooth(0),
+  m_solver_telemetry(false)
 {
   m_system = new ChSystem;
 
@@ -42,6 +62,9 @@ ChVehicle::ChVehicle()
   m_system->SetIterLCPmaxItersSpeed(150);
   m_system->SetIterLCPmaxItersStab(150);
   m_system->SetMaxPenetrationRecoverySpeed(4.0);
+
+  ResetStepStats();
+  ResetSolverStats();
 }
 
 
@@ -51,8 +74,20 @@ ChVehicle::ChVehicle()
 ChVehicle::ChVehicle(ChSystem* system)
 : m_system(system),
   m_ownsSystem(false),
-  m_stepsize(1e-3)
+  m_stepsize(1e-3),
+  m_fixed_stepsize(1e-3),
+  m_adaptive(false),
+  m_min_step(1e-5),
+  m_max_step(5e-3),
+  m_max_violation(1e-3),
+  m_max_force_change(0.25),
+  m_max_penetration(5e-3),
+  m_penetration(0),
+  m_num_smooth(0),
+  m_solver_telemetry(false)
 {
+  ResetStepStats();
+  ResetSolverStats();
 }
 
 
@@ -69,15 +104,492 @@ ChVehicle::~ChVehicle()
 // -----------------------------------------------------------------------------
 // Advance the state of the system, taking as many steps as needed to exactly
 // reach the specified value 'step'.
-// ---------------------------------------------------------------------------- -
+//
+// In adaptive mode, the step size is reduced (halved) if the tire forces
+// changed significantly since the last call. A step during which a new pair of
+// collision models came into contact, the contact penetration grew beyond its
+// tolerance, or the constraint violation exceeded its tolerance is rejected:
+// the state at the beginning of the step is restored and the step is retried
+// with half the step size. Changes in the number of contact points between
+// bodies already in contact are not events. A step is retried at most
+// max_retries times (and a step taken at the minimum step size is always
+// accepted). The step size is doubled after a few consecutive accepted steps
+// with no such events and with a constraint violation well below tolerance.
+// Only accepted steps are included in the solver telemetry.
+// -----------------------------------------------------------------------------
+static const int num_smooth_to_grow = 3;
+static const int max_retries = 3;
+static const double growth_factor = 2.0;
+
 void ChVehicle::Advance(double step)
 {
+  CH_PERF_SCOPE("ChVehicle::Advance");
+
+  if (!m_adaptive) {
+    double t = 0;
+    while (t < step) {
+      double h = std::min<>(m_stepsize, step - t);
+      {
+        CH_PROFILE_SCOPE("ChSystem::DoStepDynamics");
+        m_system->DoStepDynamics(h);
+        if (m_solver_telemetry)
+          RecordSolverStats();
+      }
+      t += h;
+    }
+    UpdateStateSnapshot();
+    return;
+  }
+
+  if (CheckTireForceChange() > m_max_force_change && m_stepsize > m_min_step) {
+    m_stepsize = std::max<>(0.5 * m_stepsize, m_min_step);
+    m_stats.num_shrink++;
+    m_stats.num_force_events++;
+    m_num_smooth = 0;
+  }
+
+  ContactPairs pairs;
   double t = 0;
+  int num_retries = 0;
+
   while (t < step) {
     double h = std::min<>(m_stepsize, step - t);
-    m_system->DoStepDynamics(h);
+
+    // Save the state at the beginning of the step, once per step and only if
+    // the step can be rejected at all. Retries start from the restored state,
+    // so they reuse the snapshot taken before the first attempt.
+    bool can_reject = (h > m_min_step && num_retries < max_retries);
+    if (can_reject && num_retries == 0) {
+      m_step_state.Clear();
+      ChVehicle::Snapshot(m_step_state);
+    }
+
+    {
+      CH_PROFILE_SCOPE("ChSystem::DoStepDynamics");
+      m_system->DoStepDynamics(h);
+    }
+
+    double penetration = GetContactPairs(pairs);
+    bool contact_event = (penetration > m_max_penetration && penetration > m_penetration);
+    for (size_t i = 0; i < pairs.size() && !contact_event; i++)
+      contact_event = !std::binary_search(m_contact_pairs.begin(), m_contact_pairs.end(), pairs[i]);
+    double violation = GetMaxConstraintViolation();
+    bool event = contact_event || violation > m_max_violation;
+
+    if (event) {
+      m_num_smooth = 0;
+      if (contact_event)
+        m_stats.num_contact_events++;
+      else
+        m_stats.num_violation_events++;
+    }
+
+    if (event && can_reject) {
+      // Reject the step: restore the state at its beginning (keeping the
+      // spindle forces recorded for the tire force check) and retry.
+      std::vector<ChVector<> > spindle_forces;
+      spindle_forces.swap(m_spindle_forces);
+      m_step_state.Rewind();
+      ChVehicle::Restore(m_step_state);
+      m_spindle_forces.swap(spindle_forces);
+
+      m_stepsize = std::max<>(0.5 * h, m_min_step);
+      m_stats.num_shrink++;
+      m_stats.num_rejected++;
+      num_retries++;
+      continue;
+    }
+
+    // Accept the step.
     t += h;
+    num_retries = 0;
+    m_contact_pairs.swap(pairs);
+    m_penetration = penetration;
+
+    if (m_solver_telemetry)
+      RecordSolverStats();
+
+    m_stats.num_steps++;
+    m_stats.total_time += h;
+    m_stats.min_step = std::min<>(m_stats.min_step, h);
+    m_stats.max_step = std::max<>(m_stats.max_step, h);
+
+    if (!event && violation < 0.1 * m_max_violation) {
+      if (++m_num_smooth >= num_smooth_to_grow && m_stepsize < m_max_step) {
+        m_stepsize = std::min<>(growth_factor * m_stepsize, m_max_step);
+        m_stats.num_grow++;
+        m_num_smooth = 0;
+      }
+    }
+    else {
+      m_num_smooth = 0;
+    }
+  }
+
+  UpdateStateSnapshot();
+}
+
+
+// -----------------------------------------------------------------------------
+// Adaptive time stepping settings and statistics
+// -----------------------------------------------------------------------------
+void ChVehicle::SetAdaptiveStepping(bool   val,
+                                   double min_step,
+                                   double max_step)
+{
+  if (val && !m_adaptive)
+    m_fixed_stepsize = m_stepsize;
+  else if (!val && m_adaptive)
+    m_stepsize = m_fixed_stepsize;
+
+  m_adaptive = val;
+  m_min_step = min_step;
+  m_max_step = max_step;
+
+  if (m_adaptive)
+    m_stepsize = std::min<>(std::max<>(m_stepsize, m_min_step), m_max_step);
+  m_penetration = GetContactPairs(m_contact_pairs);
+  m_num_smooth = 0;
+  m_spindle_forces.clear();
+
+  ResetStepStats();
+}
+
+void ChVehicle::SetAdaptiveTolerances(double max_violation,
+                                      double max_force_change,
+                                      double max_penetration)
+{
+  m_max_violation = max_violation;
+  m_max_force_change = max_force_change;
+  m_max_penetration = max_penetration;
+}
+
+void ChVehicle::ResetStepStats()
+{
+  m_stats.num_steps = 0;
+  m_stats.num_shrink = 0;
+  m_stats.num_grow = 0;
+  m_stats.num_rejected = 0;
+  m_stats.num_contact_events = 0;
+  m_stats.num_violation_events = 0;
+  m_stats.num_force_events = 0;
+  m_stats.min_step = 1e30;
+  m_stats.max_step = 0;
+  m_stats.total_time = 0;
+}
+
+void ChVehicle::LogStepStats()
+{
+  GetLog() << "\n---- Adaptive step size statistics\n\n";
+  GetLog() << "Number of steps:      " << m_stats.num_steps << "\n";
+  GetLog() << "Integrated time:      " << m_stats.total_time << "\n";
+  if (m_stats.num_steps > 0) {
+    GetLog() << "Step size min/avg/max: " << m_stats.min_step << "  "
+             << m_stats.GetAverageStep() << "  " << m_stats.max_step << "\n";
+  }
+  GetLog() << "Step reductions:      " << m_stats.num_shrink
+           << "  (contact: " << m_stats.num_contact_events
+           << ", violation: " << m_stats.num_violation_events
+           << ", tire force: " << m_stats.num_force_events << ")\n";
+  GetLog() << "Step increases:       " << m_stats.num_grow << "\n";
+  GetLog() << "Rejected steps:       " << m_stats.num_rejected << "\n";
+}
+
+
+// -----------------------------------------------------------------------------
+// Collect the pairs of bodies in contact (each pair stored once, with the
+// smaller index first) and the largest penetration depth. Bodies are keyed by
+// their position in the system body list rather than by address, so that the
+// contact history stays valid when a snapshot is restored into another system
+// built the same way (e.g. the branches of a rollout). The ChObj identifiers
+// cannot be used for this, as most vehicle subsystems leave them at 0.
+// Contactables other than bodies are all keyed as -1.
+// -----------------------------------------------------------------------------
+class ContactPairCollector : public ChReportContactCallback
+{
+public:
+  ContactPairCollector(const std::map<const ChPhysicsItem*, int>& index,
+                       std::vector<std::pair<int, int> >&         pairs)
+  : m_index(index), m_pairs(pairs), m_max_penetration(0) {}
+
+  virtual bool ReportContactCallback(const ChVector<>&          pA,
+                                     const ChVector<>&          pB,
+                                     const ChMatrix33<>&        plane_coord,
+                                     const double&              distance,
+                                     const float&               mfriction,
+                                     const ChVector<>&          react_forces,
+                                     const ChVector<>&          react_torques,
+                                     collision::ChCollisionModel* modA,
+                                     collision::ChCollisionModel* modB)
+  {
+    int a = GetIndex(modA);
+    int b = GetIndex(modB);
+    if (b < a)
+      std::swap(a, b);
+    m_pairs.push_back(std::make_pair(a, b));
+    m_max_penetration = std::max<>(m_max_penetration, -distance);
+    return true;
+  }
+
+  int GetIndex(collision::ChCollisionModel* model) const
+  {
+    std::map<const ChPhysicsItem*, int>::const_iterator it = m_index.find(model->GetPhysicsItem());
+    return (it == m_index.end()) ? -1 : it->second;
+  }
+
+  const std::map<const ChPhysicsItem*, int>& m_index;
+  std::vector<std::pair<int, int> >&         m_pairs;
+  double                                     m_max_penetration;
+};
+
+double ChVehicle::GetContactPairs(ContactPairs& pairs) const
+{
+  pairs.clear();
+
+  std::vector<ChBody*>* bodies = m_system->Get_bodylist();
+  std::map<const ChPhysicsItem*, int> index;
+  for (size_t i = 0; i < bodies->size(); i++)
+    index[bodies->at(i)] = (int)i;
+
+  ContactPairCollector collector(index, pairs);
+  m_system->GetContactContainer()->ReportAllContacts(&collector);
+
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  return collector.m_max_penetration;
+}
+
+
+// -----------------------------------------------------------------------------
+// Compare the forces currently applied to the wheel spindles (i.e. the tire
+// forces set in the last call to Update) with those recorded at the previous
+// call. Changes are measured relative to the larger of the previous force
+// magnitude and a reference value (the average wheel load from gravity).
+// -----------------------------------------------------------------------------
+double ChVehicle::CheckTireForceChange()
+{
+  size_t num_wheels = 2 * m_suspensions.size();
+  bool first = (m_spindle_forces.size() != num_wheels);
+  if (first)
+    m_spindle_forces.resize(num_wheels);
+
+  double ref = m_chassis->GetMass() * m_system->Get_G_acc().Length() / num_wheels;
+  double change = 0;
+
+  for (size_t i = 0; i < m_suspensions.size(); i++) {
+    for (int side = LEFT; side <= RIGHT; side++) {
+      ChVector<> force = m_suspensions[i]->GetSpindle(ChVehicleSide(side))->Get_accumulated_force();
+      ChVector<>& prev = m_spindle_forces[2 * i + side];
+      if (!first) {
+        double scale = std::max<>(prev.Length(), ref);
+        change = std::max<>(change, (force - prev).Length() / scale);
+      }
+      prev = force;
+    }
+  }
+
+  return change;
+}
+
+
+// -----------------------------------------------------------------------------
+// Solver settings and convergence telemetry
+// -----------------------------------------------------------------------------
+void ChVehicle::SetSolverSettings(const SolverSettings& settings)
+{
+  m_system->SetLcpSolverType(settings.type);
+  m_system->SetIterLCPmaxItersSpeed(settings.max_iters_speed);
+  m_system->SetIterLCPmaxItersStab(settings.max_iters_stab);
+  m_system->SetMaxPenetrationRecoverySpeed(settings.max_recovery_speed);
+
+  // Changing the solver type creates new solver objects.
+  if (m_solver_telemetry)
+    EnableSolverRecording();
+}
+
+ChVehicle::SolverSettings ChVehicle::GetSolverSettings() const
+{
+  SolverSettings settings;
+  settings.type = m_system->GetLcpSolverType();
+  settings.max_iters_speed = m_system->GetIterLCPmaxItersSpeed();
+  settings.max_iters_stab = m_system->GetIterLCPmaxItersStab();
+  settings.max_recovery_speed = m_system->GetMaxPenetrationRecoverySpeed();
+  return settings;
+}
+
+static const struct {
+  ChSystem::eCh_lcpSolver  type;
+  const char*              name;
+} solver_names[] = {
+  { ChSystem::LCP_ITERATIVE_SOR,             "SOR" },
+  { ChSystem::LCP_ITERATIVE_SYMMSOR,         "SYMMSOR" },
+  { ChSystem::LCP_ITERATIVE_JACOBI,          "JACOBI" },
+  { ChSystem::LCP_ITERATIVE_BARZILAIBORWEIN, "BARZILAIBORWEIN" },
+  { ChSystem::LCP_ITERATIVE_APGD,            "APGD" },
+  { ChSystem::LCP_ITERATIVE_PMINRES,         "PMINRES" },
+  { ChSystem::LCP_SIMPLEX,                   "SIMPLEX" }
+};
+
+static const int num_solver_names = sizeof(solver_names) / sizeof(solver_names[0]);
+
+const char* ChVehicle::GetSolverTypeName(ChSystem::eCh_lcpSolver type)
+{
+  for (int i = 0; i < num_solver_names; i++) {
+    if (solver_names[i].type == type)
+      return solver_names[i].name;
+  }
+  return "UNKNOWN";
+}
+
+bool ChVehicle::GetSolverType(const std::string&        name,
+                              ChSystem::eCh_lcpSolver&  type)
+{
+  for (int i = 0; i < num_solver_names; i++) {
+    if (name.compare(solver_names[i].name) == 0) {
+      type = solver_names[i].type;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ChVehicle::SetSolverTelemetry(bool val)
+{
+  m_solver_telemetry = val;
+
+  if (val)
+    EnableSolverRecording();
+
+  ResetSolverStats();
+}
+
+void ChVehicle::EnableSolverRecording()
+{
+  if (ChLcpIterativeSolver* solver = dynamic_cast<ChLcpIterativeSolver*>(m_system->GetLcpSolverSpeed()))
+    solver->SetRecordViolation(true);
+}
+
+void ChVehicle::ResetSolverStats()
+{
+  m_solver_stats.num_steps = 0;
+  m_solver_stats.last_iterations = 0;
+  m_solver_stats.last_residual = 0;
+  m_solver_stats.last_violation = 0;
+  m_solver_stats.total_iterations = 0;
+  m_solver_stats.max_iterations = 0;
+  m_solver_stats.max_residual = 0;
+  m_solver_stats.max_violation = 0;
+}
+
+// The number of iterations and the final residual are obtained from the
+// residual history recorded by the (iterative) speed solver.
+void ChVehicle::RecordSolverStats()
+{
+  SolverStats& s = m_solver_stats;
+
+  s.last_iterations = 0;
+  s.last_residual = 0;
+
+  if (ChLcpIterativeSolver* solver = dynamic_cast<ChLcpIterativeSolver*>(m_system->GetLcpSolverSpeed())) {
+    const std::vector<double>& history = solver->GetViolationHistory();
+    s.last_iterations = (int)history.size();
+    s.last_residual = history.empty() ? 0 : history.back();
+  }
+
+  s.last_violation = GetMaxConstraintViolation();
+
+  s.num_steps++;
+  s.total_iterations += s.last_iterations;
+  s.max_iterations = std::max<>(s.max_iterations, s.last_iterations);
+  s.max_residual = std::max<>(s.max_residual, s.last_residual);
+  s.max_violation = std::max<>(s.max_violation, s.last_violation);
+}
+
+void ChVehicle::LogSolverStats()
+{
+  SolverSettings settings = GetSolverSettings();
+
+  GetLog() << "\n---- Solver telemetry\n\n";
+  GetLog() << "Solver:               " << GetSolverTypeName(settings.type) << "\n";
+  GetLog() << "Max. iterations:      " << settings.max_iters_speed << " / " << settings.max_iters_stab << "\n";
+  GetLog() << "Number of steps:      " << m_solver_stats.num_steps << "\n";
+  GetLog() << "Iterations avg/max:   " << m_solver_stats.GetAverageIterations() << "  " << m_solver_stats.max_iterations << "\n";
+  GetLog() << "Maximum residual:     " << m_solver_stats.max_residual << "\n";
+  GetLog() << "Maximum violation:    " << m_solver_stats.max_violation << "\n";
+}
+
+
+// -----------------------------------------------------------------------------
+// Traverse all joints in the system and return the largest violation norm, as
+// evaluated by ChConstraintMetrics.
+// -----------------------------------------------------------------------------
+double ChVehicle::GetMaxConstraintViolation() const
+{
+  double violation = 0;
+
+  std::vector<ChLink*>::iterator ilink = m_system->Get_linklist()->begin();
+  for (; ilink != m_system->Get_linklist()->end(); ++ilink) {
+    bool distance = dynamic_cast<ChLinkDistance*>(*ilink) != NULL;
+    violation = std::max<>(violation, ChConstraintMetrics::EvaluateViolation(*ilink, distance));
+  }
+
+  return violation;
+}
+
+
+// -----------------------------------------------------------------------------
+// Kinetic quantities over all bodies in the system, used to detect when the
+// vehicle comes to rest (see ChVehicleSimulation::Settle).
+// -----------------------------------------------------------------------------
+double ChVehicle::GetKineticEnergy() const
+{
+  double energy = 0;
+
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+    ChBody* body = *ibody;
+    if (body->GetBodyFixed())
+      continue;
+    ChVector<> w = body->GetWvel_loc();
+    ChVector<> Iw = body->GetInertia().Matrix_times_vector(w);
+    energy += 0.5 * body->GetMass() * body->GetPos_dt().Length2() + 0.5 * (w ^ Iw);
+  }
+
+  return energy;
+}
+
+double ChVehicle::GetMaxBodySpeed() const
+{
+  double speed = 0;
+
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody)
+    speed = std::max<>(speed, (*ibody)->GetPos_dt().Length());
+
+  return speed;
+}
+
+void ChVehicle::ZeroVelocities()
+{
+  std::vector<ChBody*>::iterator ibody = m_system->Get_bodylist()->begin();
+  for (; ibody != m_system->Get_bodylist()->end(); ++ibody) {
+    (*ibody)->SetPos_dt(VNULL);
+    (*ibody)->SetWvel_loc(VNULL);
+    (*ibody)->SetPos_dtdt(VNULL);
+    (*ibody)->SetWacc_loc(VNULL);
   }
+
+  std::vector<ChPhysicsItem*>* items = m_system->Get_otherphysicslist();
+  for (size_t i = 0; i < items->size(); i++) {
+    if (ChShaft* shaft = dynamic_cast<ChShaft*>(items->at(i))) {
+      shaft->SetPos_dt(0);
+      shaft->SetPos_dtdt(0);
+    }
+  }
+
+  m_system->Update();
+  UpdateStateSnapshot();
 }
 
 
@@ -133,6 +645,76 @@ ChWheelState ChVehicle::GetWheelState(const ChWheelID& wheel_id) const
   return state;
 }
 
+// -----------------------------------------------------------------------------
+// Return the states of all wheels, accessing the spindle bodies directly.
+// -----------------------------------------------------------------------------
+void ChVehicle::GetWheelStates(ChWheelStates& states) const
+{
+  states.resize(2 * m_suspensions.size());
+
+  for (size_t i = 0; i < m_suspensions.size(); i++) {
+    for (int side = LEFT; side <= RIGHT; side++) {
+      const ChBody* spindle = m_suspensions[i]->GetSpindle(ChVehicleSide(side)).get_ptr();
+      ChWheelState& state = states[2 * i + side];
+
+      state.pos = spindle->GetPos();
+      state.rot = spindle->GetRot();
+      state.lin_vel = spindle->GetPos_dt();
+      state.ang_vel = spindle->GetWvel_par();
+      state.omega = spindle->GetWvel_loc().y;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Apply tire forces (indexed by wheel ID) to the spindle bodies.
+// -----------------------------------------------------------------------------
+void ChVehicle::ApplyTireForces(const ChTireForces& tire_forces)
+{
+  for (size_t i = 0; i < m_suspensions.size(); i++) {
+    m_suspensions[i]->ApplyTireForce(LEFT, tire_forces[2 * i]);
+    m_suspensions[i]->ApplyTireForce(RIGHT, tire_forces[2 * i + 1]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Fill the state snapshot. Storage is allocated at the first call only.
+// -----------------------------------------------------------------------------
+void ChVehicle::UpdateStateSnapshot()
+{
+  size_t num_wheels = 2 * m_suspensions.size();
+
+  if (m_snapshot.spring_force.size() != num_wheels) {
+    m_snapshot.wheel_states.resize(num_wheels);
+    m_snapshot.spring_force.resize(num_wheels);
+    m_snapshot.spring_length.resize(num_wheels);
+    m_snapshot.shock_force.resize(num_wheels);
+    m_snapshot.shock_velocity.resize(num_wheels);
+  }
+
+  const ChFrameMoving<>& frame = m_chassis->GetFrame_REF_to_abs();
+
+  m_snapshot.time = m_system->GetChTime();
+  m_snapshot.chassis.pos = frame.GetPos();
+  m_snapshot.chassis.rot = frame.GetRot();
+  m_snapshot.chassis.lin_vel = frame.GetPos_dt();
+  m_snapshot.chassis.ang_vel = frame.GetWvel_par();
+  m_snapshot.speed = m_snapshot.chassis.lin_vel.Length();
+  m_snapshot.driveshaft_speed = m_driveline->GetDriveshaftSpeed();
+
+  GetWheelStates(m_snapshot.wheel_states);
+
+  for (size_t i = 0; i < m_suspensions.size(); i++) {
+    for (int side = LEFT; side <= RIGHT; side++) {
+      size_t id = 2 * i + side;
+      m_snapshot.spring_force[id] = m_suspensions[i]->GetSpringForce(ChVehicleSide(side));
+      m_snapshot.spring_length[id] = m_suspensions[i]->GetSpringLength(ChVehicleSide(side));
+      m_snapshot.shock_force[id] = m_suspensions[i]->GetShockForce(ChVehicleSide(side));
+      m_snapshot.shock_velocity[id] = m_suspensions[i]->GetShockVelocity(ChVehicleSide(side));
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Return the global driver position
 // -----------------------------------------------------------------------------
@@ -149,6 +731,136 @@ double ChVehicle::GetDriveshaftSpeed() const
 }
 
 
+// -----------------------------------------------------------------------------
+// Snapshot and restore the state of the underlying Chrono system.
+// For each body, we store position, orientation, and their first and second
+// time derivatives; for each shaft, its angle, angular speed, and angular
+// acceleration. The number of bodies and shafts is stored first and checked on
+// restore. The adaptive-stepping contact history (pairs of body indices) is
+// stored ahead of it.
+// -----------------------------------------------------------------------------
+void ChVehicle::Snapshot(ChStateBuffer& buffer) const
+{
+  std::vector<ChBody*>* bodies = m_system->Get_bodylist();
+  std::vector<ChPhysicsItem*>* items = m_system->Get_otherphysicslist();
+
+  int num_bodies = (int)bodies->size();
+  int num_shafts = 0;
+  for (size_t i = 0; i < items->size(); i++) {
+    if (dynamic_cast<ChShaft*>(items->at(i)))
+      num_shafts++;
+  }
+
+  buffer.Write(m_system->GetChTime());
+  buffer.Write(m_stepsize);
+  buffer.Write(m_penetration);
+  buffer.Write((int)m_contact_pairs.size());
+  for (size_t i = 0; i < m_contact_pairs.size(); i++) {
+    buffer.Write(m_contact_pairs[i].first);
+    buffer.Write(m_contact_pairs[i].second);
+  }
+  buffer.Write(num_bodies);
+  buffer.Write(num_shafts);
+
+  for (size_t i = 0; i < bodies->size(); i++) {
+    ChBody* body = bodies->at(i);
+    buffer.Write(body->GetPos());
+    buffer.Write(body->GetRot());
+    buffer.Write(body->GetPos_dt());
+    buffer.Write(body->GetRot_dt());
+    buffer.Write(body->GetPos_dtdt());
+    buffer.Write(body->GetRot_dtdt());
+  }
+
+  for (size_t i = 0; i < items->size(); i++) {
+    if (ChShaft* shaft = dynamic_cast<ChShaft*>(items->at(i))) {
+      buffer.Write(shaft->GetPos());
+      buffer.Write(shaft->GetPos_dt());
+      buffer.Write(shaft->GetPos_dtdt());
+    }
+  }
+}
+
+bool ChVehicle::Restore(ChStateBuffer& buffer)
+{
+  std::vector<ChBody*>* bodies = m_system->Get_bodylist();
+  std::vector<ChPhysicsItem*>* items = m_system->Get_otherphysicslist();
+
+  double time;
+  int num_pairs;
+  int num_bodies;
+  int num_shafts;
+
+  if (!buffer.Read(time) ||
+      !buffer.Read(m_stepsize) ||
+      !buffer.Read(m_penetration) ||
+      !buffer.Read(num_pairs))
+    return false;
+
+  // Do not trust the pair count before checking it against the data left in
+  // the buffer.
+  if (num_pairs < 0 || (size_t)num_pairs > buffer.GetRemaining() / (2 * sizeof(int)))
+    return false;
+
+  m_contact_pairs.resize(num_pairs);
+  for (int i = 0; i < num_pairs; i++) {
+    if (!buffer.Read(m_contact_pairs[i].first) ||
+        !buffer.Read(m_contact_pairs[i].second))
+      return false;
+  }
+
+  if (!buffer.Read(num_bodies) ||
+      !buffer.Read(num_shafts))
+    return false;
+
+  if (num_bodies != (int)bodies->size())
+    return false;
+
+  ChVector<> pos, pos_dt, pos_dtdt;
+  ChQuaternion<> rot, rot_dt, rot_dtdt;
+
+  for (size_t i = 0; i < bodies->size(); i++) {
+    if (!buffer.Read(pos) || !buffer.Read(rot) ||
+        !buffer.Read(pos_dt) || !buffer.Read(rot_dt) ||
+        !buffer.Read(pos_dtdt) || !buffer.Read(rot_dtdt))
+      return false;
+
+    ChBody* body = bodies->at(i);
+    body->SetPos(pos);
+    body->SetRot(rot);
+    body->SetPos_dt(pos_dt);
+    body->SetRot_dt(rot_dt);
+    body->SetPos_dtdt(pos_dtdt);
+    body->SetRot_dtdt(rot_dtdt);
+  }
+
+  int count = 0;
+  for (size_t i = 0; i < items->size(); i++) {
+    if (ChShaft* shaft = dynamic_cast<ChShaft*>(items->at(i))) {
+      double s, s_dt, s_dtdt;
+      if (++count > num_shafts ||
+          !buffer.Read(s) || !buffer.Read(s_dt) || !buffer.Read(s_dtdt))
+        return false;
+      shaft->SetPos(s);
+      shaft->SetPos_dt(s_dt);
+      shaft->SetPos_dtdt(s_dtdt);
+    }
+  }
+
+  if (count != num_shafts)
+    return false;
+
+  // Update all dependent quantities (markers, joints, etc.)
+  m_system->SetChTime(time);
+  m_system->Update();
+
+  m_spindle_forces.clear();
+  UpdateStateSnapshot();
+
+  return true;
+}
+
+
 // -----------------------------------------------------------------------------
 // Log constraint violations
 // -----------------------------------------------------------------------------
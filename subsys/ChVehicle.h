@@ -23,6 +23,7 @@
 #define CH_VEHICLE_H
 
 #include <vector>
+#include <utility>
 
 #include "core/ChVector.h"
 #include "physics/ChSystem.h"
@@ -30,6 +31,7 @@
 
 #include "subsys/ChApiSubsys.h"
 #include "subsys/ChSubsysDefs.h"
+#include "subsys/ChStateBuffer.h"
 #include "subsys/ChSuspension.h"
 #include "subsys/ChDriveline.h"
 #include "subsys/ChSteering.h"
@@ -47,6 +49,57 @@ class CH_SUBSYS_API ChVehicle : public ChShared
 {
 public:
 
+  ///
+  /// Step-size statistics for adaptive time stepping.
+  /// These are accumulated over all calls to Advance() since the adaptive mode
+  /// was last enabled (or the statistics were reset).
+  ///
+  struct StepStats {
+    int     num_steps;          ///< total number of integration steps
+    int     num_shrink;         ///< number of step size reductions
+    int     num_grow;           ///< number of step size increases
+    int     num_rejected;       ///< number of rejected (and retried) steps
+    int     num_contact_events; ///< reductions triggered by new contact pairs or excessive penetration
+    int     num_violation_events;  ///< reductions triggered by constraint violations
+    int     num_force_events;   ///< reductions triggered by tire force changes
+    double  min_step;           ///< smallest step size taken
+    double  max_step;           ///< largest step size taken
+    double  total_time;         ///< total integrated time
+
+    /// Return the average step size.
+    double GetAverageStep() const { return (num_steps > 0) ? total_time / num_steps : 0; }
+  };
+
+  ///
+  /// Settings for the solver of the underlying Chrono system.
+  ///
+  struct SolverSettings {
+    ChSystem::eCh_lcpSolver  type;                ///< LCP solver type
+    int                      max_iters_speed;     ///< maximum number of iterations (speed solver)
+    int                      max_iters_stab;      ///< maximum number of iterations (stabilization solver)
+    double                   max_recovery_speed;  ///< maximum penetration recovery speed
+  };
+
+  ///
+  /// Solver convergence telemetry.
+  /// Values for the last integration step, as well as totals and extremes
+  /// accumulated since telemetry was enabled (or the statistics were reset).
+  /// Iterations and residuals are only available for iterative solvers.
+  ///
+  struct SolverStats {
+    int     num_steps;          ///< number of integration steps recorded
+    int     last_iterations;    ///< speed solver iterations at the last step
+    double  last_residual;      ///< final speed solver residual at the last step
+    double  last_violation;     ///< maximum joint constraint violation after the last step
+    long    total_iterations;   ///< total number of speed solver iterations
+    int     max_iterations;     ///< largest number of iterations in one step
+    double  max_residual;       ///< largest final residual
+    double  max_violation;      ///< largest joint constraint violation
+
+    /// Return the average number of solver iterations per step.
+    double GetAverageIterations() const { return (num_steps > 0) ? (double)total_iterations / num_steps : 0; }
+  };
+
   /// Construct a vehicle system with a default ChSystem.
   ChVehicle();
 
@@ -62,6 +115,9 @@ public:
   /// Get a handle to the vehicle's chassis body.
   ChSharedPtr<ChBodyAuxRef> GetChassis() const { return m_chassis; }
 
+  /// Get a handle to the suspension subsystem of the specified axle.
+  const ChSharedPtr<ChSuspension> GetSuspension(int axle) const { return m_suspensions[axle]; }
+
   /// Get a handle to the vehicle's steering subsystem.
   const ChSharedPtr<ChSteering> GetSteering() const { return m_steering; }
 
@@ -132,6 +188,26 @@ public:
   /// speed about its rotation axis.
   ChWheelState GetWheelState(const ChWheelID& wheel_id) const;
 
+  /// Get the complete states of all wheels.
+  /// The provided vector is resized (if needed) to the number of wheels and is
+  /// filled with the wheel states, indexed by wheel ID.
+  void GetWheelStates(ChWheelStates& states) const;
+
+  /// Apply the provided tire forces to all spindle bodies.
+  /// The tire forces are assumed to be indexed by wheel ID.
+  void ApplyTireForces(const ChTireForces& tire_forces);
+
+  /// Get the snapshot of the vehicle state.
+  /// The snapshot is filled once, at the end of each call to Advance() (as
+  /// well as by UpdateStateSnapshot(), Restore(), and ZeroVelocities()), and
+  /// can be used by any number of consumers (tires, loggers, etc.) without
+  /// additional queries of the underlying Chrono system.
+  const ChVehicleStateSnapshot& GetStateSnapshot() const { return m_snapshot; }
+
+  /// Fill the vehicle state snapshot with the current state.
+  /// This function is called automatically at the end of Advance().
+  void UpdateStateSnapshot();
+
   /// Get the angular speed of the driveshaft.
   /// This function provides the interface between a vehicle system and a
   /// powertrain system.
@@ -171,11 +247,109 @@ public:
   /// Get the current value of the integration step size for the vehicle system.
   double GetStepsize() const { return m_stepsize; }
 
+  /// Enable or disable adaptive time stepping.
+  /// In adaptive mode, Advance() starts from the current step size and reduces
+  /// it when a new pair of collision models comes into contact, when the
+  /// contact penetration or the maximum joint constraint violation exceeds its
+  /// tolerance, or when the tire forces change by more than the specified
+  /// relative amount between two calls to Advance(). A step with such a
+  /// contact or constraint event is rejected and retried with the smaller step
+  /// size (at most a few times per step, and never below min_step). The step
+  /// size is increased again during smooth phases. The step size is always
+  /// kept in the interval [min_step, max_step]. Disabling adaptive mode
+  /// restores the step size in effect when it was enabled.
+  void SetAdaptiveStepping(
+    bool   val,                    ///< [in] enable/disable adaptive mode
+    double min_step = 1e-5,        ///< [in] minimum allowable step size
+    double max_step = 5e-3         ///< [in] maximum allowable step size
+    );
+
+  /// Set the tolerances that drive the adaptive step size controller.
+  void SetAdaptiveTolerances(
+    double max_violation,            ///< [in] maximum joint constraint violation
+    double max_force_change,         ///< [in] maximum relative change in tire forces
+    double max_penetration = 5e-3    ///< [in] maximum contact penetration depth
+    );
+
+  /// Return true if adaptive time stepping is enabled.
+  bool IsAdaptiveStepping() const { return m_adaptive; }
+
+  /// Get the step-size statistics accumulated in adaptive mode.
+  const StepStats& GetStepStats() const { return m_stats; }
+
+  /// Reset the step-size statistics.
+  void ResetStepStats();
+
+  /// Log the step-size statistics.
+  void LogStepStats();
+
+  /// Set the solver settings for the underlying Chrono system.
+  void SetSolverSettings(const SolverSettings& settings);
+
+  /// Get the current solver settings of the underlying Chrono system.
+  SolverSettings GetSolverSettings() const;
+
+  /// Get the name of the specified solver type (as used in JSON files).
+  static const char* GetSolverTypeName(ChSystem::eCh_lcpSolver type);
+
+  /// Find the solver type with the given name. Return false if not recognized.
+  static bool GetSolverType(const std::string& name, ChSystem::eCh_lcpSolver& type);
+
+  /// Enable/disable solver convergence telemetry.
+  /// When enabled, the number of solver iterations, the final solver residual,
+  /// and the maximum joint constraint violation are recorded after each
+  /// integration step (this requires a traversal of all joints at each step).
+  void SetSolverTelemetry(bool val);
+
+  /// Return true if solver telemetry is enabled.
+  bool IsSolverTelemetry() const { return m_solver_telemetry; }
+
+  /// Get the solver convergence telemetry.
+  const SolverStats& GetSolverStats() const { return m_solver_stats; }
+
+  /// Reset the solver convergence telemetry.
+  void ResetSolverStats();
+
+  /// Log the solver convergence telemetry.
+  void LogSolverStats();
+
+  /// Return the maximum joint constraint violation over all joints in the
+  /// underlying Chrono system. The violation of each joint is evaluated as in
+  /// ChConstraintMetrics (the 2-norm of its constraint residuals, or the
+  /// distance error for distance constraints).
+  double GetMaxConstraintViolation() const;
+
+  /// Return the total kinetic energy of all bodies in the underlying Chrono system.
+  double GetKineticEnergy() const;
+
+  /// Return the largest linear speed of any body in the underlying Chrono system.
+  double GetMaxBodySpeed() const;
+
+  /// Set all body and shaft velocities and accelerations to zero.
+  /// The positions are not changed. Dependent quantities and the vehicle state
+  /// snapshot are updated.
+  void ZeroVelocities();
+
   /// Log current constraint violations.
   void LogConstraintViolations();
 
+  /// Append the state of the vehicle system to the specified buffer.
+  /// This includes the simulation time and the states of all bodies and shafts
+  /// in the underlying Chrono system (including any terrain bodies).  Joint
+  /// reactions are not stored; these are recalculated at the next step.
+  virtual void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the state of the vehicle system from the specified buffer.
+  /// Return false if the buffer does not contain a state compatible with the
+  /// current system (i.e. with the same number of bodies and shafts).
+  virtual bool Restore(ChStateBuffer& buffer);
+
 protected:
 
+  /// Pairs of bodies in contact, identified by their index in the system
+  /// body list.
+  typedef std::vector<std::pair<int, int> > ContactPairs;
+
   ChSystem*                  m_system;       ///< pointer to the Chrono system
   bool                       m_ownsSystem;   ///< true if system created at construction
 
@@ -187,6 +361,41 @@ protected:
   ChBrakeList                m_brakes;       ///< list of handles to brake subsystems
 
   double                     m_stepsize;   ///< integration step-size for the vehicle system
+  double                     m_fixed_stepsize;   ///< step size to restore when adaptive mode is disabled
+
+  bool                       m_adaptive;         ///< true if adaptive time stepping is enabled
+  double                     m_min_step;         ///< minimum step size in adaptive mode
+  double                     m_max_step;         ///< maximum step size in adaptive mode
+  double                     m_max_violation;    ///< constraint violation tolerance
+  double                     m_max_force_change; ///< relative tire force change tolerance
+  double                     m_max_penetration;  ///< contact penetration tolerance
+  ContactPairs               m_contact_pairs;    ///< pairs in contact at the end of the last step (sorted)
+  double                     m_penetration;      ///< largest penetration at the end of the last step
+  int                        m_num_smooth;       ///< number of consecutive smooth steps
+  ChStateBuffer              m_step_state;       ///< state at the beginning of the current step
+  std::vector<ChVector<> >   m_spindle_forces;   ///< spindle forces at the last call to Advance
+  StepStats                  m_stats;            ///< step-size statistics
+
+  bool                       m_solver_telemetry; ///< true if solver telemetry is enabled
+  SolverStats                m_solver_stats;     ///< solver convergence telemetry
+
+  ChVehicleStateSnapshot     m_snapshot;         ///< vehicle state snapshot
+
+private:
+
+  /// Return the largest relative change in applied spindle (tire) forces since
+  /// the previous call, and record the current forces.
+  double CheckTireForceChange();
+
+  /// Collect the (sorted) pairs of bodies currently in contact and
+  /// return the largest penetration depth.
+  double GetContactPairs(ContactPairs& pairs) const;
+
+  /// Enable recording of the solver residual history (if iterative).
+  void EnableSolverRecording();
+
+  /// Record solver telemetry for the last integration step.
+  void RecordSolverStats();
 };
 
 
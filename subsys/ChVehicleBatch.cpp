@@ -0,0 +1,154 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batch of identical vehicle simulations advanced in lockstep.
+//
+// =============================================================================
+
+#include <algorithm>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+#include "subsys/ChVehicleBatch.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Create the vehicle simulation and record its initial state, used on reset.
+// Environments are stepped in parallel, so powertrain messages are disabled.
+// -----------------------------------------------------------------------------
+ChVehicleBatch::Env::Env(ChVehicleFactory& factory)
+: driver(new InputDriver)
+{
+  instance = ChSharedPtr<ChVehicleInstance>(new ChVehicleInstance(factory, driver));
+  if (!instance->GetPowertrain().IsNull())
+    instance->GetPowertrain()->SetVerbose(false);
+  instance->GetVehicle()->UpdateStateSnapshot();
+  instance->GetSimulation().Snapshot(initial);
+}
+
+
+// -----------------------------------------------------------------------------
+// Vehicles are created serially, since factories are not required to be
+// thread-safe.
+// -----------------------------------------------------------------------------
+ChVehicleBatch::ChVehicleBatch(ChVehicleFactory& factory,
+                               int               num_vehicles)
+: m_obs_size(0),
+  m_step(1e-3),
+  m_interval(1e-2),
+  m_num_threads(0)
+{
+  for (int i = 0; i < num_vehicles; i++)
+    m_envs.push_back(new Env(factory));
+
+  if (num_vehicles > 0)
+    m_obs_size = 8 + m_envs[0]->instance->GetSimulation().GetNumWheels();
+}
+
+ChVehicleBatch::~ChVehicleBatch()
+{
+  for (size_t i = 0; i < m_envs.size(); i++)
+    delete m_envs[i];
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChVehicleBatch::Reset(int i)
+{
+  return m_envs[i]->instance->GetSimulation().Restore(m_envs[i]->initial);
+}
+
+bool ChVehicleBatch::Reset(double* observations)
+{
+  int num_vehicles = GetNumVehicles();
+  bool okay = true;
+
+  for (int i = 0; i < num_vehicles; i++)
+    okay &= Reset(i);
+
+  if (observations)
+    GetObservations(observations);
+
+  return okay;
+}
+
+
+// -----------------------------------------------------------------------------
+// Each vehicle reads its own slice of the action array and writes its own slice
+// of the observation array, so no synchronization is needed.
+// -----------------------------------------------------------------------------
+void ChVehicleBatch::Step(const double* actions,
+                          double*       observations)
+{
+  int num_vehicles = GetNumVehicles();
+
+  int num_threads = (m_num_threads > 0) ? m_num_threads : 1;
+#ifdef _OPENMP
+  if (m_num_threads <= 0)
+    num_threads = omp_get_max_threads();
+#endif
+  num_threads = std::min<>(num_threads, std::max<>(num_vehicles, 1));
+
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+  for (int i = 0; i < num_vehicles; i++) {
+    Env& env = *m_envs[i];
+    ChVehicleSimulation& sim = env.instance->GetSimulation();
+
+    env.driver->SetInputs(actions + ACTION_SIZE * i);
+
+    double t_end = sim.GetTime() + m_interval;
+    while (sim.GetTime() < t_end - 1e-10)
+      sim.Step(std::min<double>(m_step, t_end - sim.GetTime()));
+
+    if (observations)
+      WriteObservation(env, observations + m_obs_size * i);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Observations are taken from the vehicle state snapshot, which is refreshed at
+// the end of each vehicle step.
+// -----------------------------------------------------------------------------
+void ChVehicleBatch::GetObservations(double* observations) const
+{
+  for (size_t i = 0; i < m_envs.size(); i++)
+    WriteObservation(*m_envs[i], observations + m_obs_size * i);
+}
+
+void ChVehicleBatch::WriteObservation(const Env& env, double* obs) const
+{
+  const ChVehicleStateSnapshot& s = env.instance->GetVehicle()->GetStateSnapshot();
+
+  obs[0] = s.chassis.pos.x;
+  obs[1] = s.chassis.pos.y;
+  obs[2] = s.chassis.pos.z;
+  obs[3] = s.chassis.rot.e0;
+  obs[4] = s.chassis.rot.e1;
+  obs[5] = s.chassis.rot.e2;
+  obs[6] = s.chassis.rot.e3;
+  obs[7] = s.speed;
+
+  for (int w = 8; w < m_obs_size; w++)
+    obs[w] = s.wheel_states[w - 8].omega;
+}
+
+
+} // end namespace chrono
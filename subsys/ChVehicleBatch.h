@@ -0,0 +1,141 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Batch of identical vehicle simulations advanced in lockstep.
+//
+// All vehicles are created with the same ChVehicleFactory. At each call to
+// Step(), the driver inputs for all vehicles are taken from a flat array of
+// actions and, after all vehicles were advanced over one control interval,
+// the observations for all vehicles are written to a flat, caller-provided
+// array. Vehicles are advanced concurrently using OpenMP, if available.
+//
+// Actions are stored as [throttle, steering, braking] for each vehicle.
+// Observations are stored, for each vehicle, as:
+//   chassis position (3), chassis orientation (4), vehicle speed (1),
+//   wheel angular speeds (one per wheel)
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_BATCH_H
+#define CH_VEHICLE_BATCH_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChStateBuffer.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChVehicleFactory.h"
+
+namespace chrono {
+
+///
+/// Batch of vehicle simulations stepped in lockstep.
+///
+class CH_SUBSYS_API ChVehicleBatch : public ChShared
+{
+public:
+
+  /// Number of action values per vehicle (throttle, steering, braking).
+  static const int ACTION_SIZE = 3;
+
+  ChVehicleBatch(
+    ChVehicleFactory& factory,        ///< [in] factory used to create the vehicles
+    int               num_vehicles    ///< [in] number of vehicles in the batch
+    );
+
+  ~ChVehicleBatch();
+
+  /// Get the number of vehicles in the batch.
+  int GetNumVehicles() const { return (int)m_envs.size(); }
+
+  /// Get the number of observation values per vehicle.
+  int GetObservationSize() const { return m_obs_size; }
+
+  /// Set the step size used for simulating the vehicles (default: 1e-3).
+  void SetStepsize(double step) { m_step = step; }
+
+  /// Set the control interval, i.e. the time over which the vehicles are
+  /// advanced at each call to Step() (default: 1e-2).
+  void SetControlInterval(double interval) { m_interval = interval; }
+
+  /// Set the number of threads (default: 0, use all available).
+  void SetNumThreads(int num_threads) { m_num_threads = num_threads; }
+
+  /// Get the simulation for the specified vehicle.
+  ChVehicleSimulation& GetSimulation(int i) { return m_envs[i]->instance->GetSimulation(); }
+
+  /// Reset all vehicles to their initial state and write the observations.
+  /// The observation array must have room for GetNumVehicles() * GetObservationSize() values.
+  /// Return false if any of the vehicles could not be reset.
+  bool Reset(
+    double* observations    ///< [out] observations for all vehicles (may be NULL)
+    );
+
+  /// Reset the specified vehicle to its initial state.
+  /// Return false if the vehicle could not be reset.
+  bool Reset(
+    int i                   ///< [in] vehicle index
+    );
+
+  /// Apply the driver inputs, advance all vehicles over one control interval,
+  /// and write the resulting observations.
+  /// The action array must have GetNumVehicles() * ACTION_SIZE values.
+  void Step(
+    const double* actions,       ///< [in] driver inputs for all vehicles
+    double*       observations   ///< [out] observations for all vehicles (may be NULL)
+    );
+
+  /// Write the current observations for all vehicles.
+  void GetObservations(
+    double* observations         ///< [out] observations for all vehicles
+    ) const;
+
+private:
+
+  /// Driver whose inputs are set directly from the action array.
+  class InputDriver : public ChDriver
+  {
+  public:
+    void SetInputs(const double* action)
+    {
+      SetThrottle(action[0]);
+      SetSteering(action[1]);
+      SetBraking(action[2]);
+    }
+  };
+
+  struct Env {
+    Env(ChVehicleFactory& factory);
+
+    ChSharedPtr<InputDriver>        driver;
+    ChSharedPtr<ChVehicleInstance>  instance;
+    ChStateBuffer                   initial;
+  };
+
+  void WriteObservation(const Env& env, double* obs) const;
+
+  std::vector<Env*>  m_envs;          ///< list of vehicle simulations
+  int                m_obs_size;      ///< number of observation values per vehicle
+  double             m_step;          ///< simulation step size
+  double             m_interval;      ///< control interval
+  int                m_num_threads;   ///< number of threads (0: all available)
+};
+
+
+} // end namespace chrono
+
+
+#endif
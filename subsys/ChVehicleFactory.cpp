@@ -0,0 +1,54 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Container owning all modules of one vehicle simulation.
+//
+// =============================================================================
+
+#include "subsys/ChVehicleFactory.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Create all modules, in the order vehicle, terrain, powertrain, tires, then
+// the simulation object that ties them together.
+// -----------------------------------------------------------------------------
+ChVehicleInstance::ChVehicleInstance(ChVehicleFactory&      factory,
+                                     ChSharedPtr<ChDriver>  driver)
+: m_driver(driver)
+{
+  m_vehicle = factory.CreateVehicle();
+  m_terrain = factory.CreateTerrain(*m_vehicle.get_ptr());
+  m_powertrain = factory.CreatePowertrain(*m_vehicle.get_ptr());
+
+  m_sim = new ChVehicleSimulation(*m_vehicle.get_ptr(), *m_driver.get_ptr(), *m_terrain.get_ptr(), m_powertrain);
+
+  for (int i = 0; i < m_sim->GetNumWheels(); i++) {
+    ChWheelID wheel_id(i);
+    m_sim->SetTire(wheel_id, factory.CreateTire(*m_vehicle.get_ptr(), *m_terrain.get_ptr(), wheel_id));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// The simulation object references the modules and must be destroyed first.
+// -----------------------------------------------------------------------------
+ChVehicleInstance::~ChVehicleInstance()
+{
+  delete m_sim;
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,125 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Factory interface for creating complete, independent vehicle simulations,
+// and a container owning all modules of one such simulation.
+//
+// Since a vehicle is made of many Chrono bodies, links, and shafts, it cannot
+// simply be copied.  Instead, an identical vehicle is constructed (in its own
+// ChSystem) by a user-provided factory and then brought to the desired state
+// with ChVehicleSimulation::Restore().
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_FACTORY_H
+#define CH_VEHICLE_FACTORY_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChVehicleSimulation.h"
+
+namespace chrono {
+
+///
+/// Base class for a vehicle simulation factory.
+/// A concrete factory must create, every time it is called, a new set of
+/// modules. The vehicle must be created with its own ChSystem and must be
+/// initialized. Factory functions are always invoked from a single thread.
+///
+class CH_SUBSYS_API ChVehicleFactory
+{
+public:
+
+  virtual ~ChVehicleFactory() {}
+
+  /// Create and initialize a new vehicle, in its own Chrono system.
+  virtual ChSharedPtr<ChVehicle> CreateVehicle() = 0;
+
+  /// Create the terrain for the specified vehicle.
+  virtual ChSharedPtr<ChTerrain> CreateTerrain(
+    ChVehicle&  vehicle     ///< [in] vehicle, as returned by CreateVehicle()
+    ) = 0;
+
+  /// Create and initialize the powertrain for the specified vehicle.
+  virtual ChSharedPtr<ChPowertrain> CreatePowertrain(
+    ChVehicle&  vehicle     ///< [in] vehicle, as returned by CreateVehicle()
+    ) = 0;
+
+  /// Create and initialize the tire for the specified wheel.
+  virtual ChSharedPtr<ChTire> CreateTire(
+    ChVehicle&        vehicle,    ///< [in] vehicle, as returned by CreateVehicle()
+    const ChTerrain&  terrain,    ///< [in] terrain, as returned by CreateTerrain()
+    const ChWheelID&  wheel_id    ///< [in] wheel identifier
+    ) = 0;
+};
+
+
+///
+/// Container for all modules of one vehicle simulation.
+/// A ChVehicleInstance creates all modules using the specified factory and
+/// owns them, together with the associated ChVehicleSimulation.
+///
+class CH_SUBSYS_API ChVehicleInstance : public ChShared
+{
+public:
+
+  ChVehicleInstance(
+    ChVehicleFactory&      factory,   ///< [in] factory used to create the modules
+    ChSharedPtr<ChDriver>  driver     ///< [in] handle to the driver system
+    );
+
+  ~ChVehicleInstance();
+
+  /// Get the simulation object for this instance.
+  ChVehicleSimulation& GetSimulation() { return *m_sim; }
+
+  /// Get a handle to the vehicle.
+  ChSharedPtr<ChVehicle> GetVehicle() const { return m_vehicle; }
+
+  /// Get a handle to the driver.
+  ChSharedPtr<ChDriver> GetDriver() const { return m_driver; }
+
+  /// Get a handle to the terrain.
+  ChSharedPtr<ChTerrain> GetTerrain() const { return m_terrain; }
+
+  /// Get a handle to the powertrain.
+  ChSharedPtr<ChPowertrain> GetPowertrain() const { return m_powertrain; }
+
+private:
+
+  // Instances cannot be copied.
+  ChVehicleInstance(const ChVehicleInstance&);
+  ChVehicleInstance& operator=(const ChVehicleInstance&);
+
+  ChSharedPtr<ChVehicle>     m_vehicle;     ///< handle to the vehicle
+  ChSharedPtr<ChDriver>      m_driver;      ///< handle to the driver
+  ChSharedPtr<ChTerrain>     m_terrain;     ///< handle to the terrain
+  ChSharedPtr<ChPowertrain>  m_powertrain;  ///< handle to the powertrain
+  ChVehicleSimulation*       m_sim;         ///< simulation loop object
+};
+
+
+} // end namespace chrono
+
+
+#endif
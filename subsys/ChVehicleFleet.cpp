@@ -0,0 +1,748 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Fleet runner for many independent vehicle simulations.
+//
+// =============================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+#include "core/ChTimer.h"
+
+#include "subsys/ChVehicleFleet.h"
+#include "subsys/ChVehicleFactory.h"
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/vehicle/Vehicle.h"
+#include "subsys/powertrain/SimplePowertrain.h"
+#include "subsys/terrain/RigidTerrain.h"
+#include "subsys/tire/RigidTire.h"
+#include "subsys/tire/LugreTire.h"
+
+#include "rapidjson/filereadstream.h"
+
+using namespace rapidjson;
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Small deterministic random number generator (SplitMix64), so that each job
+// generates the same perturbations regardless of thread assignment.
+// -----------------------------------------------------------------------------
+namespace {
+
+class JobRandom
+{
+public:
+  JobRandom(unsigned int seed) : m_state(0x9E3779B97F4A7C15ULL * (seed + 1)) {}
+
+  /// Return a uniformly distributed number in [-1, 1].
+  double Uniform()
+  {
+    unsigned long long z = (m_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return 2.0 * (double)(z >> 11) / 9007199254740992.0 - 1.0;
+  }
+
+private:
+  unsigned long long m_state;
+};
+
+
+// Locate the numeric value at the specified '/'-separated path (array elements
+// are identified by their index). Return NULL if there is no such value.
+Value* FindValue(Value& root, const std::string& path)
+{
+  Value* v = &root;
+  std::string::size_type start = 0;
+
+  while (v && start <= path.size()) {
+    std::string::size_type end = path.find('/', start);
+    if (end == std::string::npos)
+      end = path.size();
+    std::string key = path.substr(start, end - start);
+    start = end + 1;
+
+    if (v->IsObject()) {
+      Value::MemberIterator m = v->FindMember(key.c_str());
+      v = (m == v->MemberEnd()) ? NULL : &m->value;
+    } else if (v->IsArray()) {
+      SizeType i = (SizeType)atoi(key.c_str());
+      v = (i < v->Size()) ? &(*v)[i] : NULL;
+    } else {
+      v = NULL;
+    }
+
+    if (end == path.size())
+      break;
+  }
+
+  return (v && v->IsNumber()) ? v : NULL;
+}
+
+// Set a numeric value, preserving integer values as integers.
+void SetNumber(Value& v, double val)
+{
+  if (v.IsInt())
+    v.SetInt((int)std::floor(val + 0.5));
+  else
+    v.SetDouble(val);
+}
+
+// Read a JSON file. Return false if the file cannot be opened or parsed.
+bool ReadDocument(const std::string& filename, Document& d)
+{
+  FILE* fp = fopen(filename.c_str(), "r");
+  if (!fp)
+    return false;
+
+  char readBuffer[65536];
+  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+  d.ParseStream(is);
+
+  fclose(fp);
+
+  return !d.HasParseError() && d.IsObject();
+}
+
+// Report an invalid member of a job specification.
+void ReportInvalid(const std::string& job, const std::string& member, const char* expected)
+{
+  GetLog() << "ChVehicleFleet: " << job.c_str() << ": " << member.c_str() << " must be " << expected << "\n";
+}
+
+// Load all modifiers for the given JSON object, grouped by target file
+// ("Vehicle", "Tire", "Powertrain", or the path of a subsystem file).
+// Return false (and report) if the object or any modifier value is invalid.
+bool LoadModifiers(const Value&                            a,
+                   const std::string&                      job,
+                   const std::string&                      group,
+                   std::vector<ChVehicleFleet::Modifier>&  mods)
+{
+  if (!a.IsObject()) {
+    ReportInvalid(job, group, "an object");
+    return false;
+  }
+
+  for (Value::ConstMemberIterator t = a.MemberBegin(); t != a.MemberEnd(); ++t) {
+    std::string target = t->name.GetString();
+    if (!t->value.IsObject()) {
+      ReportInvalid(job, group + " " + target, "an object");
+      return false;
+    }
+    for (Value::ConstMemberIterator m = t->value.MemberBegin(); m != t->value.MemberEnd(); ++m) {
+      ChVehicleFleet::Modifier mod;
+      mod.target = target;
+      mod.path = m->name.GetString();
+      if (!m->value.IsNumber()) {
+        ReportInvalid(job, group + " " + target + " " + mod.path, "a number");
+        return false;
+      }
+      mod.value = m->value.GetDouble();
+      mods.push_back(mod);
+    }
+  }
+
+  return true;
+}
+
+// Read an optional numeric member. Return false (and report) if the member
+// exists but is not a number; 'val' is left unchanged if the member is absent.
+bool GetDouble(const Value& a, const std::string& job, const char* name, double& val)
+{
+  Value::ConstMemberIterator m = a.FindMember(name);
+  if (m == a.MemberEnd())
+    return true;
+  if (!m->value.IsNumber()) {
+    ReportInvalid(job, name, "a number");
+    return false;
+  }
+  val = m->value.GetDouble();
+  return true;
+}
+
+// Read an optional unsigned integer member (see GetDouble).
+bool GetUint(const Value& a, const std::string& job, const char* name, unsigned int& val)
+{
+  Value::ConstMemberIterator m = a.FindMember(name);
+  if (m == a.MemberEnd())
+    return true;
+  if (!m->value.IsUint()) {
+    ReportInvalid(job, name, "a non-negative integer");
+    return false;
+  }
+  val = m->value.GetUint();
+  return true;
+}
+
+// Read an optional string member (see GetDouble).
+bool GetString(const Value& a, const std::string& job, const char* name, std::string& val)
+{
+  Value::ConstMemberIterator m = a.FindMember(name);
+  if (m == a.MemberEnd())
+    return true;
+  if (!m->value.IsString()) {
+    ReportInvalid(job, name, "a string");
+    return false;
+  }
+  val = m->value.GetString();
+  return true;
+}
+
+// Read an optional 3D vector member, given as an array of 3 numbers (see GetDouble).
+bool GetVector(const Value& a, const std::string& job, const char* name, ChVector<>& val)
+{
+  Value::ConstMemberIterator m = a.FindMember(name);
+  if (m == a.MemberEnd())
+    return true;
+  const Value& v = m->value;
+  if (!v.IsArray() || v.Size() != 3 || !v[0u].IsNumber() || !v[1u].IsNumber() || !v[2u].IsNumber()) {
+    ReportInvalid(job, name, "an array of 3 numbers");
+    return false;
+  }
+  val = ChVector<>(v[0u].GetDouble(), v[1u].GetDouble(), v[2u].GetDouble());
+  return true;
+}
+
+} // end anonymous namespace
+
+
+// -----------------------------------------------------------------------------
+// Factory creating the modules of a job from the shared parsed specifications.
+// Specifications modified by the job are replaced with job-local copies.
+// The factory only reads shared data, so that jobs can be built concurrently.
+// -----------------------------------------------------------------------------
+class ChVehicleFleet::Factory : public ChVehicleFactory
+{
+public:
+  Factory(const Job& job) : m_vehicle(NULL), m_tire(NULL), m_powertrain(NULL), m_job(job) {}
+
+  ~Factory()
+  {
+    std::map<std::string, Document*>::iterator it;
+    for (it = m_copies.begin(); it != m_copies.end(); ++it)
+      delete it->second;
+  }
+
+  virtual ChSharedPtr<ChVehicle> CreateVehicle()
+  {
+    ChSharedPtr<Vehicle> vehicle(new Vehicle(*m_vehicle, m_subsystems));
+    vehicle->Initialize(ChCoordsys<>(m_job.init_loc, QUNIT));
+    return vehicle;
+  }
+
+  virtual ChSharedPtr<ChTerrain> CreateTerrain(ChVehicle& vehicle)
+  {
+    return ChSharedPtr<ChTerrain>(new RigidTerrain(vehicle.GetSystem(),
+                                                   m_job.terrain_height,
+                                                   m_job.terrain_length,
+                                                   m_job.terrain_width,
+                                                   m_job.terrain_mu));
+  }
+
+  virtual ChSharedPtr<ChPowertrain> CreatePowertrain(ChVehicle& vehicle)
+  {
+    ChSharedPtr<SimplePowertrain> powertrain(new SimplePowertrain(*m_powertrain));
+    powertrain->Initialize();
+    return powertrain;
+  }
+
+  virtual ChSharedPtr<ChTire> CreateTire(ChVehicle&        vehicle,
+                                         const ChTerrain&  terrain,
+                                         const ChWheelID&  wheel_id)
+  {
+    std::string subtype = (*m_tire)["Template"].GetString();
+
+    if (subtype.compare("LugreTire") == 0) {
+      ChSharedPtr<LugreTire> tire(new LugreTire(*m_tire, terrain));
+      tire->Initialize();
+      return tire;
+    }
+
+    ChSharedPtr<RigidTire> tire(new RigidTire(*m_tire, terrain));
+    tire->Initialize(vehicle.GetWheelBody(wheel_id));
+    return tire;
+  }
+
+  // Return a job-local copy of the specification targeted by a modifier
+  // (created at the first call). Return NULL if the job does not use it.
+  Document* GetModifiable(const std::string& target)
+  {
+    std::string file = target;
+    if (target.compare("Vehicle") == 0)
+      file = m_job.vehicle_file;
+    else if (target.compare("Tire") == 0)
+      file = m_job.tire_file;
+    else if (target.compare("Powertrain") == 0)
+      file = m_job.powertrain_file;
+
+    std::map<std::string, Document*>::iterator it = m_copies.find(file);
+    if (it != m_copies.end())
+      return it->second;
+
+    const Document* source = NULL;
+    Vehicle::DocumentMap::iterator sub = m_subsystems.find(file);
+    if (sub != m_subsystems.end())
+      source = sub->second;
+    else if (file == m_job.vehicle_file)
+      source = m_vehicle;
+    else if (file == m_job.tire_file)
+      source = m_tire;
+    else if (file == m_job.powertrain_file)
+      source = m_powertrain;
+
+    if (!source)
+      return NULL;
+
+    Document* copy = new Document;
+    copy->CopyFrom(*source, copy->GetAllocator());
+    m_copies[file] = copy;
+
+    if (sub != m_subsystems.end())
+      sub->second = copy;
+    if (file == m_job.vehicle_file)
+      m_vehicle = copy;
+    if (file == m_job.tire_file)
+      m_tire = copy;
+    if (file == m_job.powertrain_file)
+      m_powertrain = copy;
+
+    return copy;
+  }
+
+  const Document*       m_vehicle;
+  const Document*       m_tire;
+  const Document*       m_powertrain;
+  Vehicle::DocumentMap  m_subsystems;
+
+private:
+  const Job&                        m_job;
+  std::map<std::string, Document*>  m_copies;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChVehicleFleet::Job::Job()
+: duration(10),
+  step_size(1e-3),
+  init_loc(0, 0, 1.0),
+  terrain_height(0),
+  terrain_length(200),
+  terrain_width(200),
+  terrain_mu(0.8),
+  seed(0)
+{
+}
+
+ChVehicleFleet::ChVehicleFleet()
+: m_num_threads(0),
+  m_wall_time(0)
+{
+}
+
+ChVehicleFleet::~ChVehicleFleet()
+{
+  std::map<std::string, Document*>::iterator d;
+  for (d = m_documents.begin(); d != m_documents.end(); ++d)
+    delete d->second;
+
+  std::map<std::string, std::vector<ChDataDriver::Entry>* >::iterator m;
+  for (m = m_maneuvers.begin(); m != m_maneuvers.end(); ++m)
+    delete m->second;
+}
+
+
+// -----------------------------------------------------------------------------
+// Load jobs from a JSON job list file. Job seeds default to the global seed
+// plus the job index.
+// -----------------------------------------------------------------------------
+bool ChVehicleFleet::LoadJobs(const std::string& filename)
+{
+  Document d;
+  if (!ReadDocument(filename, d)) {
+    GetLog() << "ChVehicleFleet: cannot read job file " << filename.c_str() << "\n";
+    return false;
+  }
+
+  if (!d.HasMember("Jobs") || !d["Jobs"].IsArray()) {
+    GetLog() << "ChVehicleFleet: no job list in " << filename.c_str() << "\n";
+    return false;
+  }
+
+  unsigned int seed = 0;
+  if (!GetUint(d, filename, "Seed", seed))
+    return false;
+
+  const Value& jobs = d["Jobs"];
+  std::vector<Job> new_jobs;
+
+  for (SizeType i = 0; i < jobs.Size(); i++) {
+    const Value& a = jobs[i];
+    Job job;
+
+    std::ostringstream name;
+    name << "job_" << m_jobs.size() + new_jobs.size();
+    job.name = name.str();
+    job.seed = seed + (unsigned int)(m_jobs.size() + new_jobs.size());
+
+    if (!a.IsObject()) {
+      ReportInvalid(job.name, "job specification", "an object");
+      return false;
+    }
+
+    bool ok = GetString(a, job.name, "Name", job.name);
+
+    ok = ok && GetString(a, job.name, "Vehicle", job.vehicle_file)
+            && GetString(a, job.name, "Tire", job.tire_file)
+            && GetString(a, job.name, "Powertrain", job.powertrain_file)
+            && GetString(a, job.name, "Maneuver", job.maneuver_file)
+            && GetDouble(a, job.name, "Duration", job.duration)
+            && GetDouble(a, job.name, "Step Size", job.step_size)
+            && GetUint(a, job.name, "Seed", job.seed)
+            && GetVector(a, job.name, "Initial Location", job.init_loc);
+
+    if (ok && a.HasMember("Terrain")) {
+      const Value& t = a["Terrain"];
+      if (!t.IsObject()) {
+        ReportInvalid(job.name, "Terrain", "an object");
+        ok = false;
+      } else {
+        ok = GetDouble(t, job.name, "Height", job.terrain_height)
+          && GetDouble(t, job.name, "Length", job.terrain_length)
+          && GetDouble(t, job.name, "Width", job.terrain_width)
+          && GetDouble(t, job.name, "Friction", job.terrain_mu);
+      }
+    }
+
+    if (ok && a.HasMember("Overrides"))
+      ok = LoadModifiers(a["Overrides"], job.name, "Overrides", job.overrides);
+    if (ok && a.HasMember("Perturbations"))
+      ok = LoadModifiers(a["Perturbations"], job.name, "Perturbations", job.perturbations);
+
+    if (!ok) {
+      GetLog() << "ChVehicleFleet: invalid job list in " << filename.c_str() << "\n";
+      return false;
+    }
+
+    new_jobs.push_back(job);
+  }
+
+  m_jobs.insert(m_jobs.end(), new_jobs.begin(), new_jobs.end());
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Shared input data. The Get functions parse and cache a file and are only
+// called from a single thread; the Find functions only look up the cached data
+// (a file which could not be loaded is cached as NULL).
+// -----------------------------------------------------------------------------
+const Document* ChVehicleFleet::GetDocument(const std::string& filename)
+{
+  std::map<std::string, Document*>::iterator it = m_documents.find(filename);
+  if (it != m_documents.end())
+    return it->second;
+
+  Document* d = new Document;
+  if (!ReadDocument(vehicle::GetDataFile(filename), *d)) {
+    GetLog() << "ChVehicleFleet: cannot read " << filename.c_str() << "\n";
+    delete d;
+    d = NULL;
+  }
+
+  m_documents[filename] = d;
+  return d;
+}
+
+const std::vector<ChDataDriver::Entry>* ChVehicleFleet::GetManeuver(const std::string& filename)
+{
+  std::map<std::string, std::vector<ChDataDriver::Entry>* >::iterator it = m_maneuvers.find(filename);
+  if (it != m_maneuvers.end())
+    return it->second;
+
+  std::vector<ChDataDriver::Entry>* data = new std::vector<ChDataDriver::Entry>;
+
+  std::ifstream ifile(vehicle::GetDataFile(filename).c_str());
+  std::string line;
+
+  while (std::getline(ifile, line)) {
+    std::istringstream iss(line);
+    double time, steering, throttle, braking;
+    iss >> time >> steering >> throttle >> braking;
+    if (iss.fail())
+      break;
+    data->push_back(ChDataDriver::Entry(time, steering, throttle, braking));
+  }
+
+  if (data->empty()) {
+    GetLog() << "ChVehicleFleet: no driver inputs in " << filename.c_str() << "\n";
+    delete data;
+    data = NULL;
+  }
+
+  m_maneuvers[filename] = data;
+  return data;
+}
+
+const Document* ChVehicleFleet::FindDocument(const std::string& filename) const
+{
+  std::map<std::string, Document*>::const_iterator it = m_documents.find(filename);
+  return (it == m_documents.end()) ? NULL : it->second;
+}
+
+const std::vector<ChDataDriver::Entry>* ChVehicleFleet::FindManeuver(const std::string& filename) const
+{
+  std::map<std::string, std::vector<ChDataDriver::Entry>* >::const_iterator it = m_maneuvers.find(filename);
+  return (it == m_maneuvers.end()) ? NULL : it->second;
+}
+
+
+// -----------------------------------------------------------------------------
+// Parse all input files up front (serially), including all subsystem files
+// referenced by the vehicle specifications, then run the jobs concurrently.
+// Dynamic scheduling with a chunk size of one lets threads which finish a
+// short job immediately pick up the next pending one.
+// -----------------------------------------------------------------------------
+int ChVehicleFleet::Run()
+{
+  ChTimer<double> timer;
+  timer.start();
+
+  for (size_t i = 0; i < m_jobs.size(); i++) {
+    const Document* vehicle_doc = GetDocument(m_jobs[i].vehicle_file);
+    if (vehicle_doc && m_subsystems.find(m_jobs[i].vehicle_file) == m_subsystems.end()) {
+      std::vector<std::string>& files = m_subsystems[m_jobs[i].vehicle_file];
+      Vehicle::GetSubsystemFiles(*vehicle_doc, files);
+      for (size_t k = 0; k < files.size(); k++)
+        GetDocument(files[k]);
+    }
+    GetDocument(m_jobs[i].tire_file);
+    GetDocument(m_jobs[i].powertrain_file);
+    GetManeuver(m_jobs[i].maneuver_file);
+  }
+
+  int num_jobs = (int)m_jobs.size();
+  m_results.resize(num_jobs);
+
+  int num_threads = (m_num_threads > 0) ? m_num_threads : 1;
+#ifdef _OPENMP
+  if (m_num_threads <= 0)
+    num_threads = omp_get_max_threads();
+#endif
+  num_threads = std::min<>(num_threads, std::max<>(num_jobs, 1));
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+  for (int i = 0; i < num_jobs; i++)
+    RunJob(i);
+
+  timer.stop();
+  m_wall_time = timer();
+
+  int num_valid = 0;
+  for (int i = 0; i < num_jobs; i++) {
+    if (m_results[i].valid)
+      num_valid++;
+    for (size_t k = 0; k < m_results[i].warnings.size(); k++)
+      GetLog() << "ChVehicleFleet: " << m_jobs[i].name.c_str() << ": " << m_results[i].warnings[k].c_str() << "\n";
+  }
+
+  return num_valid;
+}
+
+
+// -----------------------------------------------------------------------------
+// Set up and simulate one job. The shared data is only read (a file missing
+// from the cache makes the job fail); the overrides and perturbations are
+// applied to job-local copies of the files they modify. Jobs run concurrently,
+// so set-up warnings are stored in the job result and logged by Run().
+// -----------------------------------------------------------------------------
+void ChVehicleFleet::RunJob(int index)
+{
+  const Job& job = m_jobs[index];
+  Result& result = m_results[index];
+
+  ChTimer<double> timer;
+  timer.start();
+
+  result.valid = false;
+  result.final_pos = ChVector<>(0, 0, 0);
+  result.final_speed = 0;
+  result.distance = 0;
+  result.max_lat_acc = 0;
+  result.max_roll = 0;
+  result.cpu_time = 0;
+  result.warnings.clear();
+
+  Factory factory(job);
+  factory.m_vehicle = FindDocument(job.vehicle_file);
+  factory.m_tire = FindDocument(job.tire_file);
+  factory.m_powertrain = FindDocument(job.powertrain_file);
+  const std::vector<ChDataDriver::Entry>* maneuver = FindManeuver(job.maneuver_file);
+
+  if (!factory.m_vehicle)
+    result.warnings.push_back("cannot read vehicle file " + job.vehicle_file);
+  if (!factory.m_tire)
+    result.warnings.push_back("cannot read tire file " + job.tire_file);
+  if (!factory.m_powertrain)
+    result.warnings.push_back("cannot read powertrain file " + job.powertrain_file);
+  if (!maneuver)
+    result.warnings.push_back("cannot read maneuver file " + job.maneuver_file);
+  if (!result.warnings.empty())
+    return;
+
+  std::map<std::string, std::vector<std::string> >::const_iterator files = m_subsystems.find(job.vehicle_file);
+  if (files == m_subsystems.end()) {
+    result.warnings.push_back("no subsystem files for " + job.vehicle_file);
+    return;
+  }
+
+  for (size_t k = 0; k < files->second.size(); k++) {
+    const Document* d = FindDocument(files->second[k]);
+    if (!d)
+      result.warnings.push_back("cannot read subsystem file " + files->second[k]);
+    else
+      factory.m_subsystems[files->second[k]] = d;
+  }
+  if (!result.warnings.empty())
+    return;
+
+  for (size_t k = 0; k < job.overrides.size(); k++) {
+    const Modifier& mod = job.overrides[k];
+    Document* d = factory.GetModifiable(mod.target);
+    Value* v = d ? FindValue(*d, mod.path) : NULL;
+    if (v)
+      SetNumber(*v, mod.value);
+    else
+      result.warnings.push_back("no numeric parameter " + mod.path + " in " + mod.target);
+  }
+
+  JobRandom rng(job.seed);
+
+  for (size_t k = 0; k < job.perturbations.size(); k++) {
+    const Modifier& mod = job.perturbations[k];
+    double factor = 1 + mod.value * rng.Uniform();
+    Document* d = factory.GetModifiable(mod.target);
+    Value* v = d ? FindValue(*d, mod.path) : NULL;
+    if (v)
+      SetNumber(*v, v->GetDouble() * factor);
+    else
+      result.warnings.push_back("no numeric parameter " + mod.path + " in " + mod.target);
+  }
+
+  ChSharedPtr<ChDataDriver> driver(new ChDataDriver(*maneuver));
+  ChVehicleInstance* instance = new ChVehicleInstance(factory, driver);
+  if (!instance->GetPowertrain().IsNull())
+    instance->GetPowertrain()->SetVerbose(false);
+
+  ChVehicleSimulation& sim = instance->GetSimulation();
+  ChSharedPtr<ChBodyAuxRef> chassis = instance->GetVehicle()->GetChassis();
+
+  ChVector<> prev_pos = chassis->GetFrame_REF_to_abs().GetPos();
+
+  while (sim.GetTime() < job.duration - 1e-10) {
+    sim.Step(std::min<double>(job.step_size, job.duration - sim.GetTime()));
+
+    ChVector<> pos = chassis->GetFrame_REF_to_abs().GetPos();
+    result.distance += (pos - prev_pos).Length();
+    prev_pos = pos;
+
+    const ChQuaternion<>& q = chassis->GetRot();
+    double lat_acc = q.RotateBack(chassis->GetPos_dtdt()).y;
+    double roll = std::atan2(2 * (q.e0 * q.e1 + q.e2 * q.e3), 1 - 2 * (q.e1 * q.e1 + q.e2 * q.e2));
+    result.max_lat_acc = std::max<double>(result.max_lat_acc, std::abs(lat_acc));
+    result.max_roll = std::max<double>(result.max_roll, std::abs(roll));
+  }
+
+  result.final_pos = prev_pos;
+  result.final_speed = instance->GetVehicle()->GetVehicleSpeed();
+  result.valid = true;
+
+  delete instance;
+
+  timer.stop();
+  result.cpu_time = timer();
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChVehicleFleet::WriteResults(const std::string& filename) const
+{
+  std::ofstream ofile(filename.c_str());
+  if (!ofile.is_open()) {
+    GetLog() << "ChVehicleFleet: cannot open " << filename.c_str() << "\n";
+    return false;
+  }
+
+  ofile << "name,seed,valid,x,y,z,speed,distance,max_lat_acc,max_roll,cpu_time,warnings" << std::endl;
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    const Result& r = m_results[i];
+    ofile << m_jobs[i].name << "," << m_jobs[i].seed << "," << (r.valid ? 1 : 0) << ","
+          << r.final_pos.x << "," << r.final_pos.y << "," << r.final_pos.z << ","
+          << r.final_speed << "," << r.distance << "," << r.max_lat_acc << ","
+          << r.max_roll << "," << r.cpu_time << ",\"";
+    for (size_t k = 0; k < r.warnings.size(); k++)
+      ofile << (k > 0 ? "; " : "") << r.warnings[k];
+    ofile << "\"" << std::endl;
+  }
+
+  ofile.close();
+  return true;
+}
+
+void ChVehicleFleet::LogSummary() const
+{
+  int num_valid = 0;
+  double cpu_time = 0;
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    if (m_results[i].valid)
+      num_valid++;
+    cpu_time += m_results[i].cpu_time;
+  }
+
+  GetLog() << "\n---- Fleet summary\n";
+  GetLog() << "   Jobs completed:   " << num_valid << " / " << (int)m_results.size() << "\n";
+  GetLog() << "   Wall-clock time:  " << m_wall_time << "\n";
+  GetLog() << "   Total job time:   " << cpu_time << "\n";
+  if (m_wall_time > 0)
+    GetLog() << "   Speedup:          " << cpu_time / m_wall_time << "\n";
+
+  for (size_t i = 0; i < m_results.size(); i++) {
+    if (m_results[i].valid)
+      continue;
+    GetLog() << "   Failed job " << m_jobs[i].name.c_str() << ":";
+    for (size_t k = 0; k < m_results[i].warnings.size(); k++)
+      GetLog() << (k > 0 ? ";" : "") << " " << m_results[i].warnings[k].c_str();
+    GetLog() << "\n";
+  }
+}
+
+
+} // end namespace chrono
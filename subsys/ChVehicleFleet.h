@@ -0,0 +1,182 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Fleet runner for many independent vehicle simulations.
+//
+// A fleet is a list of jobs. Each job specifies JSON files for the vehicle,
+// tire, and powertrain models, a driver maneuver file, rigid terrain settings,
+// and optional parameter overrides and random perturbations applied to the
+// JSON specifications. All input files (including all subsystem files
+// referenced by the vehicle specification) are parsed once, before any job is
+// started, and shared by all jobs which use them; a job only copies the files
+// it modifies. Jobs are executed concurrently (using OpenMP, if available,
+// with dynamic scheduling so that idle threads pick up the next pending job).
+//
+// Each job has its own random number generator, seeded deterministically from
+// the job seed, so that results do not depend on the execution order or the
+// number of threads.
+//
+// A job list file has the following structure (all paths are relative to the
+// vehicle data directory):
+//
+// {
+//   "Seed": 1,
+//   "Jobs": [
+//     {
+//       "Name":       "run_0",
+//       "Vehicle":    "hmmwv/vehicle/HMMWV_Vehicle.json",
+//       "Tire":       "hmmwv/tire/HMMWV_RigidTire.json",
+//       "Powertrain": "hmmwv/powertrain/HMMWV_SimplePowertrain.json",
+//       "Maneuver":   "generic/driver/Sample_Maneuver.txt",
+//       "Duration":   10.0,
+//       "Step Size":  1e-3,
+//       "Terrain":    { "Height": 0, "Length": 200, "Width": 200, "Friction": 0.8 },
+//       "Overrides":     { "Vehicle": { "Chassis/Mass": 2500 } },
+//       "Perturbations": { "Tire":    { "Coefficient of Friction": 0.1 },
+//                          "hmmwv/suspension/HMMWV_DoubleWishboneFront.json":
+//                                     { "Spring/Spring Coefficient": 0.2 } }
+//     }
+//   ]
+// }
+//
+// Modifiers are grouped by the file they apply to: "Vehicle", "Tire", and
+// "Powertrain" refer to the job's files, any other name is the path of one of
+// the subsystem files (suspension, steering, driveline, wheel, brake) used by
+// the job's vehicle. Overrides replace numeric values, identified by a
+// '/'-separated path (array elements are selected by their index).
+// Perturbations scale numeric values by a uniformly distributed factor in
+// [1-r, 1+r].
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_FLEET_H
+#define CH_VEHICLE_FLEET_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "core/ChShared.h"
+#include "core/ChVector.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/driver/ChDataDriver.h"
+
+#include "rapidjson/document.h"
+
+namespace chrono {
+
+///
+/// Runner for a fleet of independent vehicle simulations.
+///
+class CH_SUBSYS_API ChVehicleFleet : public ChShared
+{
+public:
+
+  /// Modification of a numeric JSON parameter.
+  struct Modifier {
+    std::string  target;   ///< file to modify ("Vehicle", "Tire", "Powertrain", or a subsystem file)
+    std::string  path;     ///< '/'-separated path to the parameter
+    double       value;    ///< new value (override) or relative range (perturbation)
+  };
+
+  /// Specification of a single simulation job.
+  struct Job {
+    Job();
+
+    std::string            name;             ///< job name (used in output)
+    std::string            vehicle_file;     ///< vehicle JSON specification
+    std::string            tire_file;        ///< tire JSON specification (RigidTire or LugreTire)
+    std::string            powertrain_file;  ///< powertrain JSON specification (SimplePowertrain)
+    std::string            maneuver_file;    ///< driver inputs data file
+    double                 duration;         ///< simulation length
+    double                 step_size;        ///< simulation step size
+    ChVector<>             init_loc;         ///< initial chassis location
+    double                 terrain_height;   ///< rigid terrain height
+    double                 terrain_length;   ///< rigid terrain length (X direction)
+    double                 terrain_width;    ///< rigid terrain width (Y direction)
+    double                 terrain_mu;       ///< rigid terrain coefficient of friction
+    std::vector<Modifier>  overrides;        ///< parameter overrides
+    std::vector<Modifier>  perturbations;    ///< random parameter perturbations
+    unsigned int           seed;             ///< seed for the job random number generator
+  };
+
+  /// Summary results of a single simulation job.
+  struct Result {
+    bool        valid;          ///< false if the job could not be set up
+    ChVector<>  final_pos;      ///< final chassis position
+    double      final_speed;    ///< final vehicle speed
+    double      distance;       ///< distance traveled by the chassis reference frame
+    double      max_lat_acc;    ///< peak (absolute) chassis lateral acceleration
+    double      max_roll;       ///< peak (absolute) chassis roll angle
+    double      cpu_time;       ///< wall-clock time for this job
+    std::vector<std::string>  warnings;  ///< set-up warnings and failure reasons (reported after the run)
+  };
+
+  ChVehicleFleet();
+  ~ChVehicleFleet();
+
+  /// Load a list of jobs from the specified JSON file.
+  /// The jobs are appended to the current list. Return false on error.
+  bool LoadJobs(const std::string& filename);
+
+  /// Append the specified job to the list.
+  void AddJob(const Job& job) { m_jobs.push_back(job); }
+
+  /// Get the number of jobs.
+  int GetNumJobs() const { return (int)m_jobs.size(); }
+
+  /// Set the number of threads (default: 0, use all available).
+  void SetNumThreads(int num_threads) { m_num_threads = num_threads; }
+
+  /// Run all jobs. Return the number of jobs completed successfully.
+  int Run();
+
+  /// Get the results (available after Run).
+  const std::vector<Result>& GetResults() const { return m_results; }
+
+  /// Write the job results to a CSV file. The last column lists the warnings
+  /// of each job (for a failed job, the reason it could not be set up).
+  bool WriteResults(const std::string& filename) const;
+
+  /// Log a summary of the fleet results, including the reasons of any failed jobs.
+  void LogSummary() const;
+
+private:
+
+  class Factory;
+
+  const rapidjson::Document* GetDocument(const std::string& filename);
+  const std::vector<ChDataDriver::Entry>* GetManeuver(const std::string& filename);
+
+  const rapidjson::Document* FindDocument(const std::string& filename) const;
+  const std::vector<ChDataDriver::Entry>* FindManeuver(const std::string& filename) const;
+
+  void RunJob(int index);
+
+  std::vector<Job>     m_jobs;          ///< list of jobs
+  std::vector<Result>  m_results;       ///< job results
+  int                  m_num_threads;   ///< number of threads (0: all available)
+  double               m_wall_time;     ///< total wall-clock time for the last run
+
+  std::map<std::string, rapidjson::Document*>                m_documents;   ///< shared parsed JSON files
+  std::map<std::string, std::vector<ChDataDriver::Entry>* >  m_maneuvers;   ///< shared parsed maneuvers
+  std::map<std::string, std::vector<std::string> >           m_subsystems;  ///< subsystem files of each vehicle file
+};
+
+
+} // end namespace chrono
+
+
+#endif
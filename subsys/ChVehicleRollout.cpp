@@ -0,0 +1,149 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Parallel branched rollouts from a common vehicle simulation state.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+#include "subsys/ChVehicleRollout.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// A branch uses a data driver which is given the candidate input sequence
+// before each rollout. It is created with a single (zero) entry. Branches are
+// advanced in parallel, so powertrain messages are disabled.
+// -----------------------------------------------------------------------------
+ChVehicleRollout::Branch::Branch(ChVehicleFactory& factory)
+: driver(new ChDataDriver(std::vector<ChDataDriver::Entry>(1, ChDataDriver::Entry(0, 0, 0, 0))))
+{
+  instance = ChSharedPtr<ChVehicleInstance>(new ChVehicleInstance(factory, driver));
+  if (!instance->GetPowertrain().IsNull())
+    instance->GetPowertrain()->SetVerbose(false);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChVehicleRollout::ChVehicleRollout(ChVehicleFactory& factory)
+: m_factory(factory),
+  m_step(1e-3),
+  m_num_threads(0)
+{
+}
+
+ChVehicleRollout::~ChVehicleRollout()
+{
+  for (size_t i = 0; i < m_branches.size(); i++)
+    delete m_branches[i];
+}
+
+
+// -----------------------------------------------------------------------------
+// Create any missing branches (serially, since factories are not required to
+// be thread-safe), then simulate all branches concurrently. All branches read
+// the start state directly from the shared (read-only) buffer.
+// -----------------------------------------------------------------------------
+bool ChVehicleRollout::Run(const ChStateBuffer&               start,
+                           const std::vector<InputSequence>&  inputs,
+                           double                             duration,
+                           std::vector<Metrics>&              metrics)
+{
+  int num_branches = (int)inputs.size();
+
+  while ((int)m_branches.size() < num_branches)
+    m_branches.push_back(new Branch(m_factory));
+
+  metrics.resize(num_branches);
+
+  int num_threads = (m_num_threads > 0) ? m_num_threads : 1;
+#ifdef _OPENMP
+  if (m_num_threads <= 0)
+    num_threads = omp_get_max_threads();
+#endif
+  num_threads = std::min<>(num_threads, std::max<>(num_branches, 1));
+
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (int k = 0; k < num_branches; k++) {
+    m_branches[k]->state.View(start);
+    RunBranch(*m_branches[k], inputs[k], duration, metrics[k]);
+  }
+
+  for (int k = 0; k < num_branches; k++) {
+    if (!metrics[k].valid)
+      return false;
+  }
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Restore the start state, load the (time-shifted) input sequence, and simulate
+// the branch, tracking the summary metrics at each step.
+// -----------------------------------------------------------------------------
+void ChVehicleRollout::RunBranch(Branch&              branch,
+                                 const InputSequence& input,
+                                 double               duration,
+                                 Metrics&             metrics)
+{
+  ChVehicleSimulation& sim = branch.instance->GetSimulation();
+  ChVehicle& vehicle = sim.GetVehicle();
+
+  metrics.valid = sim.Restore(branch.state);
+  metrics.max_lat_acc = 0;
+  metrics.max_tire_force = 0;
+
+  if (!metrics.valid)
+    return;
+
+  double t0 = sim.GetTime();
+
+  branch.data = input;
+  if (branch.data.empty())
+    branch.data.push_back(ChDataDriver::Entry(0, 0, 0, 0));
+  for (size_t i = 0; i < branch.data.size(); i++)
+    branch.data[i].m_time += t0;
+  branch.driver->SetData(branch.data);
+
+  double t_end = t0 + duration;
+
+  while (sim.GetTime() < t_end - 1e-10) {
+    sim.Step(std::min<double>(m_step, t_end - sim.GetTime()));
+
+    ChSharedPtr<ChBodyAuxRef> chassis = vehicle.GetChassis();
+    double lat_acc = chassis->GetRot().RotateBack(chassis->GetPos_dtdt()).y;
+    metrics.max_lat_acc = std::max<double>(metrics.max_lat_acc, std::abs(lat_acc));
+
+    const ChTireForces& forces = sim.GetTireForces();
+    for (size_t i = 0; i < forces.size(); i++)
+      metrics.max_tire_force = std::max<double>(metrics.max_tire_force, forces[i].force.Length());
+  }
+
+  metrics.final_pos = vehicle.GetChassisPos();
+  metrics.final_rot = vehicle.GetChassisRot();
+  metrics.final_speed = vehicle.GetVehicleSpeed();
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,113 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Parallel branched rollouts from a common vehicle simulation state.
+//
+// Starting from a snapshot of a vehicle simulation (see
+// ChVehicleSimulation::Snapshot), a set of candidate driver input sequences is
+// evaluated by simulating each of them on an independent copy of the vehicle.
+// Copies (branches) are created once, with a user-provided ChVehicleFactory,
+// and reused for subsequent evaluations. Branches are simulated concurrently
+// using OpenMP, if available.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_ROLLOUT_H
+#define CH_VEHICLE_ROLLOUT_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChStateBuffer.h"
+#include "subsys/ChVehicleFactory.h"
+#include "subsys/driver/ChDataDriver.h"
+
+namespace chrono {
+
+///
+/// Evaluation of candidate driver input sequences through parallel rollouts.
+///
+class CH_SUBSYS_API ChVehicleRollout : public ChShared
+{
+public:
+
+  /// Driver input sequence for one branch.
+  /// Entry times are relative to the start of the rollout.
+  typedef std::vector<ChDataDriver::Entry> InputSequence;
+
+  ///
+  /// Summary metrics for one branch.
+  ///
+  struct Metrics {
+    bool            valid;            ///< false if the start state could not be restored
+    ChVector<>      final_pos;        ///< final chassis position
+    ChQuaternion<>  final_rot;        ///< final chassis orientation
+    double          final_speed;      ///< final vehicle speed
+    double          max_lat_acc;      ///< peak (absolute) chassis lateral acceleration
+    double          max_tire_force;   ///< largest tire force magnitude over all tires
+  };
+
+  ChVehicleRollout(
+    ChVehicleFactory& factory    ///< [in] factory used to create the branches
+    );
+
+  ~ChVehicleRollout();
+
+  /// Set the step size used for simulating the branches (default: 1e-3).
+  void SetStepsize(double step) { m_step = step; }
+
+  /// Set the number of threads (default: 0, use all available).
+  void SetNumThreads(int num_threads) { m_num_threads = num_threads; }
+
+  /// Get the number of branches created so far.
+  int GetNumBranches() const { return (int)m_branches.size(); }
+
+  /// Evaluate the specified driver input sequences.
+  /// Each sequence is simulated for the given duration, starting from the
+  /// provided simulation state. Additional branches are created as needed.
+  /// Return false if any of the branches could not be restored to the start
+  /// state.
+  bool Run(
+    const ChStateBuffer&               start,     ///< [in] snapshot of the starting state
+    const std::vector<InputSequence>&  inputs,    ///< [in] candidate driver input sequences
+    double                             duration,  ///< [in] rollout duration
+    std::vector<Metrics>&              metrics    ///< [out] summary metrics, one per sequence
+    );
+
+private:
+
+  struct Branch {
+    Branch(ChVehicleFactory& factory);
+
+    ChSharedPtr<ChDataDriver>       driver;
+    ChSharedPtr<ChVehicleInstance>  instance;
+    ChStateBuffer                   state;
+    InputSequence                   data;
+  };
+
+  void RunBranch(Branch& branch, const InputSequence& input, double duration, Metrics& metrics);
+
+  ChVehicleFactory&      m_factory;      ///< factory for creating branches
+  std::vector<Branch*>   m_branches;     ///< list of branches
+  double                 m_step;         ///< simulation step size
+  int                    m_num_threads;  ///< number of threads (0: all available)
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,697 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Simulation driver for a complete vehicle system.
+//
+// =============================================================================
+
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#include "subsys/ChVehicleSimulation.h"
+#include "subsys/ChProfiler.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// Constructors.
+// The powertrain can be specified through a shared pointer (kept alive by this
+// object) or by reference (owned by the caller).
+// -----------------------------------------------------------------------------
+ChVehicleSimulation::ChVehicleSimulation(ChVehicle&                 vehicle,
+                                         ChDriver&                  driver,
+                                         ChTerrain&                 terrain,
+                                         ChSharedPtr<ChPowertrain>  powertrain)
+: m_vehicle(vehicle),
+  m_driver(driver),
+  m_terrain(terrain),
+  m_powertrain(powertrain.get_ptr()),
+  m_powertrain_handle(powertrain)
+{
+  Init();
+}
+
+ChVehicleSimulation::ChVehicleSimulation(ChVehicle&     vehicle,
+                                         ChDriver&      driver,
+                                         ChTerrain&     terrain,
+                                         ChPowertrain&  powertrain)
+: m_vehicle(vehicle),
+  m_driver(driver),
+  m_terrain(terrain),
+  m_powertrain(&powertrain)
+{
+  Init();
+}
+
+
+// -----------------------------------------------------------------------------
+// Size the inter-module communication buffers based on the number of vehicle
+// axles and fill the vehicle state snapshot, from which all wheel states are
+// read. Note that the vehicle must have been initialized at this point.
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::Init()
+{
+  m_step_number = 0;
+  m_driveshaft_speed = 0;
+  m_powertrain_torque = 0;
+  m_throttle = 0;
+  m_steering = 0;
+  m_braking = 0;
+  m_coupling = HOLD;
+  m_primed = false;
+
+  m_num_wheels = 2 * m_vehicle.GetNumberAxles();
+
+  m_tires.resize(m_num_wheels, NULL);
+  m_tire_handles.resize(m_num_wheels);
+  m_tire_forces.resize(m_num_wheels);
+  m_wheel_states.resize(m_num_wheels);
+
+  m_prev.tire_forces.resize(m_num_wheels);
+  m_prev.wheel_states.resize(m_num_wheels);
+  m_curr.tire_forces.resize(m_num_wheels);
+  m_curr.wheel_states.resize(m_num_wheels);
+
+  m_time = m_vehicle.GetSystem()->GetChTime();
+
+  m_vehicle.UpdateStateSnapshot();
+
+#if PROFILING_ENABLED
+  m_tire_regions.resize(2 * m_num_wheels);
+  for (int i = 0; i < m_num_wheels; i++) {
+    std::ostringstream name;
+    name << "Tire " << i;
+    m_tire_regions[2 * i] = ChProfiler::GetInstance().GetRegion(name.str() + "::Update");
+    m_tire_regions[2 * i + 1] = ChProfiler::GetInstance().GetRegion(name.str() + "::Advance");
+  }
+#endif
+
+  for (int m = 0; m < NUM_MODULES; m++) {
+    m_module_step[m] = 0;
+    m_module_time[m] = m_time;
+    m_module_count[m] = 0;
+    m_sample_time[m][0] = m_time;
+    m_sample_time[m][1] = m_time;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::SetTire(const ChWheelID&     wheel_id,
+                                  ChSharedPtr<ChTire>  tire)
+{
+  assert(wheel_id.id() < m_num_wheels);
+
+  m_tires[wheel_id.id()] = tire.get_ptr();
+  m_tire_handles[wheel_id.id()] = tire;
+}
+
+void ChVehicleSimulation::SetTire(const ChWheelID&  wheel_id,
+                                  ChTire&           tire)
+{
+  assert(wheel_id.id() < m_num_wheels);
+
+  m_tires[wheel_id.id()] = &tire;
+  m_tire_handles[wheel_id.id()] = ChSharedPtr<ChTire>();
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChVehicleSimulation::CheckModules() const
+{
+  if (!m_powertrain) {
+    GetLog() << "ChVehicleSimulation: no powertrain specified\n";
+    return false;
+  }
+
+  for (int i = 0; i < m_num_wheels; i++) {
+    if (!m_tires[i]) {
+      GetLog() << "ChVehicleSimulation: no tire specified for wheel " << i << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Collect output data from modules (for inter-module communication), then
+// update all modules (process inputs from other modules).
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::Update()
+{
+  m_throttle = m_driver.GetThrottle();
+  m_steering = m_driver.GetSteering();
+  m_braking = m_driver.GetBraking();
+
+  m_powertrain_torque = m_powertrain->GetOutputTorque();
+
+  for (int i = 0; i < m_num_wheels; i++)
+    m_tire_forces[i] = m_tires[i]->GetTireForce();
+
+  const ChVehicleStateSnapshot& snapshot = m_vehicle.GetStateSnapshot();
+  m_wheel_states = snapshot.wheel_states;
+  m_driveshaft_speed = snapshot.driveshaft_speed;
+
+  m_time = m_vehicle.GetSystem()->GetChTime();
+
+  {
+    CH_PROFILE_SCOPE("Driver::Update");
+    m_driver.Update(m_time);
+  }
+
+  {
+    CH_PROFILE_SCOPE("Terrain::Update");
+    m_terrain.Update(m_time);
+  }
+
+  for (int i = 0; i < m_num_wheels; i++) {
+    CH_PROFILE_SCOPE_ID(m_tire_regions[2 * i]);
+    m_tires[i]->Update(m_time, m_wheel_states[i]);
+  }
+
+  {
+    CH_PROFILE_SCOPE("Powertrain::Update");
+    m_powertrain->Update(m_time, m_throttle, m_driveshaft_speed);
+  }
+
+  {
+    CH_PROFILE_SCOPE("Vehicle::Update");
+    m_vehicle.Update(m_time, m_steering, m_braking, m_powertrain_torque, m_tire_forces);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Advance simulation for one timestep for all modules.
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::Advance(double step)
+{
+  {
+    CH_PROFILE_SCOPE("Driver::Advance");
+    m_driver.Advance(step);
+  }
+
+  {
+    CH_PROFILE_SCOPE("Terrain::Advance");
+    m_terrain.Advance(step);
+  }
+
+  for (int i = 0; i < m_num_wheels; i++) {
+    CH_PROFILE_SCOPE_ID(m_tire_regions[2 * i + 1]);
+    m_tires[i]->Advance(step);
+  }
+
+  {
+    CH_PROFILE_SCOPE("Powertrain::Advance");
+    m_powertrain->Advance(step);
+  }
+
+  {
+    CH_PROFILE_SCOPE("Vehicle::Advance");
+    m_vehicle.Advance(step);
+  }
+
+  m_time = m_vehicle.GetSystem()->GetChTime();
+  m_step_number++;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::SetModuleStepsize(Module module,
+                                            double step)
+{
+  m_module_step[module] = step;
+  m_primed = false;
+}
+
+bool ChVehicleSimulation::IsMultirate() const
+{
+  for (int m = 0; m < NUM_MODULES; m++) {
+    if (m_module_step[m] > 0)
+      return true;
+  }
+
+  return false;
+}
+
+void ChVehicleSimulation::Step(double step)
+{
+  if (IsMultirate()) {
+    AdvanceMultirate(step);
+  } else {
+    Update();
+    Advance(step);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Snapshot and restore all modules, in a fixed order, followed by the
+// simulation and multi-rate scheduling data.
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::Snapshot(ChStateBuffer& buffer) const
+{
+  m_vehicle.Snapshot(buffer);
+  m_driver.Snapshot(buffer);
+  m_powertrain->Snapshot(buffer);
+  for (int i = 0; i < m_num_wheels; i++)
+    m_tires[i]->Snapshot(buffer);
+
+  buffer.Write(m_time);
+  buffer.Write(m_step_number);
+  buffer.Write(m_primed);
+  buffer.WriteArray(m_module_time, NUM_MODULES);
+  buffer.WriteArray(m_module_count, NUM_MODULES);
+  buffer.WriteArray(&m_sample_time[0][0], 2 * NUM_MODULES);
+
+  const ModuleOutputs* outputs[2] = { &m_prev, &m_curr };
+  for (int k = 0; k < 2; k++) {
+    buffer.Write(outputs[k]->throttle);
+    buffer.Write(outputs[k]->steering);
+    buffer.Write(outputs[k]->braking);
+    buffer.Write(outputs[k]->powertrain_torque);
+    buffer.Write(outputs[k]->driveshaft_speed);
+    buffer.WriteArray(&outputs[k]->tire_forces[0], m_num_wheels);
+    buffer.WriteArray(&outputs[k]->wheel_states[0], m_num_wheels);
+  }
+}
+
+bool ChVehicleSimulation::Restore(ChStateBuffer& buffer)
+{
+  buffer.Rewind();
+
+  if (!m_vehicle.Restore(buffer) ||
+      !m_driver.Restore(buffer) ||
+      !m_powertrain->Restore(buffer))
+    return false;
+
+  for (int i = 0; i < m_num_wheels; i++) {
+    if (!m_tires[i]->Restore(buffer))
+      return false;
+  }
+
+  if (!buffer.Read(m_time) ||
+      !buffer.Read(m_step_number) ||
+      !buffer.Read(m_primed) ||
+      !buffer.ReadArray(m_module_time, NUM_MODULES) ||
+      !buffer.ReadArray(m_module_count, NUM_MODULES) ||
+      !buffer.ReadArray(&m_sample_time[0][0], 2 * NUM_MODULES))
+    return false;
+
+  ModuleOutputs* outputs[2] = { &m_prev, &m_curr };
+  for (int k = 0; k < 2; k++) {
+    if (!buffer.Read(outputs[k]->throttle) ||
+        !buffer.Read(outputs[k]->steering) ||
+        !buffer.Read(outputs[k]->braking) ||
+        !buffer.Read(outputs[k]->powertrain_torque) ||
+        !buffer.Read(outputs[k]->driveshaft_speed) ||
+        !buffer.ReadArray(&outputs[k]->tire_forces[0], m_num_wheels) ||
+        !buffer.ReadArray(&outputs[k]->wheel_states[0], m_num_wheels))
+      return false;
+  }
+
+  return buffer.AtEnd();
+}
+
+
+// -----------------------------------------------------------------------------
+// Record module outputs for multi-rate exchange. The current outputs become the
+// previous ones and new outputs are collected, time-stamped with the current
+// time of the corresponding module.
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::SampleDriver()
+{
+  m_prev.throttle = m_curr.throttle;
+  m_prev.steering = m_curr.steering;
+  m_prev.braking = m_curr.braking;
+
+  m_curr.throttle = m_driver.GetThrottle();
+  m_curr.steering = m_driver.GetSteering();
+  m_curr.braking = m_driver.GetBraking();
+
+  m_sample_time[DRIVER_MODULE][0] = m_sample_time[DRIVER_MODULE][1];
+  m_sample_time[DRIVER_MODULE][1] = m_module_time[DRIVER_MODULE];
+}
+
+void ChVehicleSimulation::SampleTires()
+{
+  for (int i = 0; i < m_num_wheels; i++) {
+    m_prev.tire_forces[i] = m_curr.tire_forces[i];
+    m_curr.tire_forces[i] = m_tires[i]->GetTireForce();
+  }
+
+  m_sample_time[TIRE_MODULE][0] = m_sample_time[TIRE_MODULE][1];
+  m_sample_time[TIRE_MODULE][1] = m_module_time[TIRE_MODULE];
+}
+
+void ChVehicleSimulation::SamplePowertrain()
+{
+  m_prev.powertrain_torque = m_curr.powertrain_torque;
+  m_curr.powertrain_torque = m_powertrain->GetOutputTorque();
+
+  m_sample_time[POWERTRAIN_MODULE][0] = m_sample_time[POWERTRAIN_MODULE][1];
+  m_sample_time[POWERTRAIN_MODULE][1] = m_module_time[POWERTRAIN_MODULE];
+}
+
+void ChVehicleSimulation::SampleVehicle()
+{
+  const ChVehicleStateSnapshot& snapshot = m_vehicle.GetStateSnapshot();
+
+  m_prev.wheel_states.swap(m_curr.wheel_states);
+  m_curr.wheel_states = snapshot.wheel_states;
+
+  m_prev.driveshaft_speed = m_curr.driveshaft_speed;
+  m_curr.driveshaft_speed = snapshot.driveshaft_speed;
+
+  m_sample_time[VEHICLE_MODULE][0] = m_sample_time[VEHICLE_MODULE][1];
+  m_sample_time[VEHICLE_MODULE][1] = m_module_time[VEHICLE_MODULE];
+}
+
+// Synchronize all module times with the current simulation time and collect
+// initial outputs (the previous outputs are set equal to the current ones).
+void ChVehicleSimulation::PrimeOutputs()
+{
+  m_time = m_vehicle.GetSystem()->GetChTime();
+
+  for (int m = 0; m < NUM_MODULES; m++)
+    m_module_time[m] = m_time;
+
+  SampleDriver();
+  SampleTires();
+  SamplePowertrain();
+  SampleVehicle();
+
+  SampleDriver();
+  SampleTires();
+  SamplePowertrain();
+  SampleVehicle();
+
+  m_primed = true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Calculate the weight of the most recent output of the specified module when
+// its data is needed at the given time. Modules are always scheduled in
+// increasing order of their current time, so the requested time lies between
+// the times of the previous and most recent outputs.
+// -----------------------------------------------------------------------------
+double ChVehicleSimulation::GetWeight(Module module,
+                                      double time) const
+{
+  double t0 = m_sample_time[module][0];
+  double t1 = m_sample_time[module][1];
+
+  if (time >= t1 - 1e-10 || t1 - t0 < 1e-10)
+    return 1;
+
+  if (m_coupling == HOLD)
+    return 0;
+
+  double w = (time - t0) / (t1 - t0);
+
+  return (w < 0) ? 0 : w;
+}
+
+static inline double Interpolate(double v0, double v1, double w)
+{
+  return v0 + w * (v1 - v0);
+}
+
+static inline ChVector<> Interpolate(const ChVector<>& v0, const ChVector<>& v1, double w)
+{
+  return v0 + (v1 - v0) * w;
+}
+
+static inline ChQuaternion<> Interpolate(const ChQuaternion<>& q0, const ChQuaternion<>& q1, double w)
+{
+  // Normalized linear interpolation, along the shortest path
+  double s = (q0.e0 * q1.e0 + q0.e1 * q1.e1 + q0.e2 * q1.e2 + q0.e3 * q1.e3 < 0) ? -1 : 1;
+  ChQuaternion<> q((1 - w) * q0.e0 + w * s * q1.e0,
+                   (1 - w) * q0.e1 + w * s * q1.e1,
+                   (1 - w) * q0.e2 + w * s * q1.e2,
+                   (1 - w) * q0.e3 + w * s * q1.e3);
+  double len = std::sqrt(q.e0 * q.e0 + q.e1 * q.e1 + q.e2 * q.e2 + q.e3 * q.e3);
+
+  return ChQuaternion<>(q.e0 / len, q.e1 / len, q.e2 / len, q.e3 / len);
+}
+
+
+// -----------------------------------------------------------------------------
+// Multi-rate advance over one outer step.
+// At each event, the module with the smallest current time is processed: its
+// inputs are obtained from the outputs of the other modules (held or
+// interpolated), it is updated and advanced by its own step size (truncated at
+// the end of the outer step), and its new outputs are recorded. Ties are broken
+// in the order driver, terrain, tires, powertrain, vehicle, which reproduces
+// the single-rate exchange when all modules use the same step size and HOLD
+// coupling.
+// -----------------------------------------------------------------------------
+void ChVehicleSimulation::AdvanceMultirate(double step)
+{
+  if (!m_primed)
+    PrimeOutputs();
+
+  double t_end = m_time + step;
+
+  while (true) {
+    int next = -1;
+    for (int m = 0; m < NUM_MODULES; m++) {
+      if (m_module_time[m] < t_end - 1e-10 && (next < 0 || m_module_time[m] < m_module_time[next] - 1e-10))
+        next = m;
+    }
+
+    if (next < 0)
+      break;
+
+    double t = m_module_time[next];
+    double h = (m_module_step[next] > 0) ? m_module_step[next] : step;
+    h = std::min<double>(h, t_end - t);
+
+    switch (next) {
+    case DRIVER_MODULE:
+    {
+      {
+        CH_PROFILE_SCOPE("Driver::Update");
+        m_driver.Update(t);
+      }
+      {
+        CH_PROFILE_SCOPE("Driver::Advance");
+        m_driver.Advance(h);
+      }
+      m_module_time[next] = t + h;
+      SampleDriver();
+      break;
+    }
+
+    case TERRAIN_MODULE:
+    {
+      {
+        CH_PROFILE_SCOPE("Terrain::Update");
+        m_terrain.Update(t);
+      }
+      {
+        CH_PROFILE_SCOPE("Terrain::Advance");
+        m_terrain.Advance(h);
+      }
+      m_module_time[next] = t + h;
+      break;
+    }
+
+    case TIRE_MODULE:
+    {
+      double w = GetWeight(VEHICLE_MODULE, t);
+      for (int i = 0; i < m_num_wheels; i++) {
+        const ChWheelState& s0 = m_prev.wheel_states[i];
+        const ChWheelState& s1 = m_curr.wheel_states[i];
+        m_wheel_states[i].pos = Interpolate(s0.pos, s1.pos, w);
+        m_wheel_states[i].rot = Interpolate(s0.rot, s1.rot, w);
+        m_wheel_states[i].lin_vel = Interpolate(s0.lin_vel, s1.lin_vel, w);
+        m_wheel_states[i].ang_vel = Interpolate(s0.ang_vel, s1.ang_vel, w);
+        m_wheel_states[i].omega = Interpolate(s0.omega, s1.omega, w);
+        {
+          CH_PROFILE_SCOPE_ID(m_tire_regions[2 * i]);
+          m_tires[i]->Update(t, m_wheel_states[i]);
+        }
+        {
+          CH_PROFILE_SCOPE_ID(m_tire_regions[2 * i + 1]);
+          m_tires[i]->Advance(h);
+        }
+      }
+      m_module_time[next] = t + h;
+      SampleTires();
+      break;
+    }
+
+    case POWERTRAIN_MODULE:
+    {
+      m_throttle = Interpolate(m_prev.throttle, m_curr.throttle, GetWeight(DRIVER_MODULE, t));
+      m_driveshaft_speed = Interpolate(m_prev.driveshaft_speed, m_curr.driveshaft_speed, GetWeight(VEHICLE_MODULE, t));
+      {
+        CH_PROFILE_SCOPE("Powertrain::Update");
+        m_powertrain->Update(t, m_throttle, m_driveshaft_speed);
+      }
+      {
+        CH_PROFILE_SCOPE("Powertrain::Advance");
+        m_powertrain->Advance(h);
+      }
+      m_module_time[next] = t + h;
+      SamplePowertrain();
+      break;
+    }
+
+    case VEHICLE_MODULE:
+    {
+      double wd = GetWeight(DRIVER_MODULE, t);
+      m_steering = Interpolate(m_prev.steering, m_curr.steering, wd);
+      m_braking = Interpolate(m_prev.braking, m_curr.braking, wd);
+      m_powertrain_torque = Interpolate(m_prev.powertrain_torque, m_curr.powertrain_torque, GetWeight(POWERTRAIN_MODULE, t));
+      double wt = GetWeight(TIRE_MODULE, t);
+      for (int i = 0; i < m_num_wheels; i++) {
+        const ChTireForce& f0 = m_prev.tire_forces[i];
+        const ChTireForce& f1 = m_curr.tire_forces[i];
+        m_tire_forces[i].force = Interpolate(f0.force, f1.force, wt);
+        m_tire_forces[i].point = Interpolate(f0.point, f1.point, wt);
+        m_tire_forces[i].moment = Interpolate(f0.moment, f1.moment, wt);
+      }
+      {
+        CH_PROFILE_SCOPE("Vehicle::Update");
+        m_vehicle.Update(t, m_steering, m_braking, m_powertrain_torque, m_tire_forces);
+      }
+      {
+        CH_PROFILE_SCOPE("Vehicle::Advance");
+        m_vehicle.Advance(h);
+      }
+      m_module_time[next] = t + h;
+      SampleVehicle();
+      break;
+    }
+    }
+
+    m_module_count[next]++;
+  }
+
+  m_time = t_end;
+  m_step_number++;
+}
+
+
+// -----------------------------------------------------------------------------
+// Simulate until the specified final time. The last step is shortened, if
+// necessary, so that the simulation ends exactly at t_end.
+// -----------------------------------------------------------------------------
+int ChVehicleSimulation::Run(double t_end,
+                             double step)
+{
+  if (!CheckModules())
+    return 0;
+
+  int num_steps = 0;
+
+  while (m_time < t_end - 1e-10) {
+    double h = std::min<double>(step, t_end - m_time);
+    Step(h);
+    num_steps++;
+    if (!m_termination.IsNull() && m_termination->Check(m_vehicle, m_time) != ChVehicleTermination::NONE)
+      break;
+  }
+
+  return num_steps;
+}
+
+
+// -----------------------------------------------------------------------------
+// Static equilibrium through kinetic damping. The vehicle is considered at rest
+// once all body speeds stayed below the tolerance for a short time interval
+// (the speed is checked before any velocity reset).
+// -----------------------------------------------------------------------------
+bool ChVehicleSimulation::Settle(double tolerance,
+                                 double max_time,
+                                 double step)
+{
+  const double quiet_interval = 0.05;
+
+  ChSystem* system = m_vehicle.GetSystem();
+  double t0 = system->GetChTime();
+  double energy_prev = 0;
+  double quiet = 0;
+  bool converged = false;
+
+  while (system->GetChTime() - t0 < max_time) {
+    double time = system->GetChTime();
+
+    m_powertrain_torque = m_powertrain->GetOutputTorque();
+    for (int i = 0; i < m_num_wheels; i++)
+      m_tire_forces[i] = m_tires[i]->GetTireForce();
+    const ChVehicleStateSnapshot& snapshot = m_vehicle.GetStateSnapshot();
+    m_wheel_states = snapshot.wheel_states;
+    m_driveshaft_speed = snapshot.driveshaft_speed;
+
+    for (int i = 0; i < m_num_wheels; i++)
+      m_tires[i]->Update(time, m_wheel_states[i]);
+    m_powertrain->Update(time, 0, m_driveshaft_speed);
+    m_vehicle.Update(time, 0, 1, m_powertrain_torque, m_tire_forces);
+
+    for (int i = 0; i < m_num_wheels; i++)
+      m_tires[i]->Advance(step);
+    m_powertrain->Advance(step);
+    m_vehicle.Advance(step);
+
+    quiet = (m_vehicle.GetMaxBodySpeed() < tolerance) ? quiet + step : 0;
+    if (quiet >= quiet_interval) {
+      converged = true;
+      break;
+    }
+
+    double energy = m_vehicle.GetKineticEnergy();
+    if (energy < energy_prev) {
+      m_vehicle.ZeroVelocities();
+      energy = 0;
+    }
+    energy_prev = energy;
+  }
+
+  // Start from rest, at the original time, with the tire transient states
+  // (e.g. bristle deflections, transient slips) reset.
+  system->SetChTime(t0);
+  m_vehicle.ZeroVelocities();
+
+  for (int i = 0; i < m_num_wheels; i++)
+    m_tires[i]->ResetState();
+
+  m_time = t0;
+  m_step_number = 0;
+  m_primed = false;
+  for (int m = 0; m < NUM_MODULES; m++) {
+    m_module_time[m] = t0;
+    m_module_count[m] = 0;
+  }
+
+  if (!converged)
+    GetLog() << "ChVehicleSimulation: vehicle not at rest after settling for " << max_time << " s\n";
+
+  return converged;
+}
+
+
+} // end namespace chrono
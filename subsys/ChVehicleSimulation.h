@@ -0,0 +1,292 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Simulation driver for a complete vehicle system.
+//
+// A ChVehicleSimulation object ties together the vehicle, driver, terrain,
+// powertrain, and tire modules and performs the inter-module data exchange
+// (driver inputs, powertrain torque, tire forces, driveshaft speed, and wheel
+// states) followed by the Update and Advance of all modules, in the same order
+// used by the stand-alone demo programs.
+//
+// All inter-module communication buffers are allocated once, at construction,
+// and reused at every step.
+//
+// Optionally, each module can be assigned its own step size (multi-rate
+// co-simulation). In that case, a module is updated and advanced only at its
+// own rate and receives the outputs of the other modules either held at their
+// most recent value or linearly interpolated between the two most recent
+// exchanged values.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_SIMULATION_H
+#define CH_VEHICLE_SIMULATION_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChSubsysDefs.h"
+#include "subsys/ChVehicle.h"
+#include "subsys/ChDriver.h"
+#include "subsys/ChTerrain.h"
+#include "subsys/ChTire.h"
+#include "subsys/ChPowertrain.h"
+#include "subsys/ChVehicleTermination.h"
+
+namespace chrono {
+
+///
+/// Simulation loop for a vehicle system and its associated modules.
+/// The vehicle, driver, and terrain are typically created by the caller (on
+/// the stack) and are only referenced by this object.  The powertrain and tire
+/// modules (one tire for each vehicle wheel, indexed by wheel ID) can be
+/// specified either through shared pointers, in which case this object keeps
+/// them alive, or by reference, in which case the caller retains ownership and
+/// must keep them alive for the lifetime of this object.
+///
+class CH_SUBSYS_API ChVehicleSimulation : public ChShared
+{
+public:
+
+  /// Simulation modules, for the purpose of multi-rate scheduling.
+  enum Module {
+    DRIVER_MODULE,
+    TERRAIN_MODULE,
+    TIRE_MODULE,
+    POWERTRAIN_MODULE,
+    VEHICLE_MODULE,
+    NUM_MODULES
+  };
+
+  /// Coupling between modules running at different rates.
+  enum Coupling {
+    HOLD,     ///< use the most recent output available at the current time
+    LINEAR    ///< linear interpolation between the two most recent outputs
+  };
+
+  ChVehicleSimulation(
+    ChVehicle&                 vehicle,     ///< [in] vehicle system
+    ChDriver&                  driver,      ///< [in] driver system
+    ChTerrain&                 terrain,     ///< [in] terrain system
+    ChSharedPtr<ChPowertrain>  powertrain   ///< [in] handle to the powertrain system
+    );
+
+  ChVehicleSimulation(
+    ChVehicle&                 vehicle,     ///< [in] vehicle system
+    ChDriver&                  driver,      ///< [in] driver system
+    ChTerrain&                 terrain,     ///< [in] terrain system
+    ChPowertrain&              powertrain   ///< [in] powertrain system (not owned)
+    );
+
+  virtual ~ChVehicleSimulation() {}
+
+  /// Attach the tire system for the specified wheel.
+  /// A tire must be attached to each of the 2 * GetNumberAxles() vehicle wheels
+  /// before starting the simulation.
+  void SetTire(
+    const ChWheelID&     wheel_id,  ///< [in] wheel identifier
+    ChSharedPtr<ChTire>  tire       ///< [in] handle to the tire system
+    );
+
+  /// Attach the tire system for the specified wheel.
+  /// The tire is not owned by this object and must outlive it.
+  void SetTire(
+    const ChWheelID&     wheel_id,  ///< [in] wheel identifier
+    ChTire&              tire       ///< [in] tire system (not owned)
+    );
+
+  /// Get the tire attached to the specified wheel (NULL if not set).
+  ChTire* GetTire(const ChWheelID& wheel_id) const { return m_tires[wheel_id.id()]; }
+
+  /// Get the number of wheels (and tires) of the simulated vehicle.
+  int GetNumWheels() const { return m_num_wheels; }
+
+  /// Get a reference to the simulated vehicle.
+  ChVehicle& GetVehicle() { return m_vehicle; }
+
+  /// Get a reference to the driver system.
+  ChDriver& GetDriver() { return m_driver; }
+
+  /// Get a reference to the terrain system.
+  ChTerrain& GetTerrain() { return m_terrain; }
+
+  /// Get the powertrain system.
+  ChPowertrain* GetPowertrain() const { return m_powertrain; }
+
+  /// Get the current simulation time.
+  double GetTime() const { return m_time; }
+
+  /// Get the number of steps taken so far.
+  int GetStepNumber() const { return m_step_number; }
+
+  /// Get the tire forces collected at the last call to Update().
+  const ChTireForces& GetTireForces() const { return m_tire_forces; }
+
+  /// Get the wheel states collected at the last call to Update().
+  const ChWheelStates& GetWheelStates() const { return m_wheel_states; }
+
+  /// Set the step size (inverse of the exchange rate) for the specified module.
+  /// A value of zero (default) indicates that the module is advanced with the
+  /// step size passed to Step().  As soon as any module is assigned a non-zero
+  /// step size, Step() switches to multi-rate scheduling.
+  void SetModuleStepsize(Module module, double step);
+
+  /// Get the step size for the specified module (zero if not set).
+  double GetModuleStepsize(Module module) const { return m_module_step[module]; }
+
+  /// Set the coupling type used to pass data between modules in multi-rate mode.
+  void SetCoupling(Coupling coupling) { m_coupling = coupling; }
+
+  /// Get the coupling type used in multi-rate mode.
+  Coupling GetCoupling() const { return m_coupling; }
+
+  /// Return true if multi-rate scheduling is enabled.
+  bool IsMultirate() const;
+
+  /// Get the number of steps taken so far by the specified module.
+  /// Only meaningful in multi-rate mode.
+  int GetModuleStepCount(Module module) const { return m_module_count[module]; }
+
+  /// Check that all modules required for simulation were specified.
+  /// Returns false (and prints a message) if a tire is missing.
+  bool CheckModules() const;
+
+  /// Collect module outputs and update all modules at the current time.
+  /// Driver inputs, powertrain torque, tire forces, driveshaft speed, and wheel
+  /// states are gathered into the internal buffers, and then passed to the
+  /// Update functions of the driver, terrain, tires, powertrain, and vehicle.
+  void Update();
+
+  /// Advance the state of all modules by the specified time step.
+  /// This function should be called after Update().
+  void Advance(double step);
+
+  /// Perform one complete simulation step.
+  /// In single-rate mode, this is Update() followed by Advance(). In multi-rate
+  /// mode, each module is advanced to the end of the step at its own rate.
+  void Step(double step);
+
+  /// Append the state of the complete simulation to the specified buffer.
+  /// This includes the states of the vehicle, driver, powertrain, and tire
+  /// systems, as well as the multi-rate scheduling data.
+  void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the state of the complete simulation from the specified buffer.
+  /// The buffer is read from the beginning. Return false if it does not
+  /// contain a compatible state (in which case the simulation state is
+  /// undefined).
+  bool Restore(ChStateBuffer& buffer);
+
+  /// Attach early-termination criteria, evaluated by Run() after each step.
+  void SetTermination(ChSharedPtr<ChVehicleTermination> termination) { m_termination = termination; }
+
+  /// Get a handle to the early-termination criteria (may be empty).
+  ChSharedPtr<ChVehicleTermination> GetTermination() const { return m_termination; }
+
+  /// Simulate until the specified final time, using a constant step size.
+  /// If termination criteria were attached, the simulation stops as soon as
+  /// one of them is met (see ChVehicleTermination::GetReason).
+  /// Returns the number of steps taken.
+  int Run(
+    double t_end,   ///< [in] final simulation time
+    double step     ///< [in] step size
+    );
+
+  /// Bring the vehicle to static equilibrium on the terrain.
+  /// The vehicle, tires, and powertrain are simulated with zero throttle and
+  /// steering and full braking (the driver and terrain are not advanced), using
+  /// kinetic damping: all velocities are set to zero whenever the total kinetic
+  /// energy passes a peak. This converges to the rest configuration (spring
+  /// compression, tire deflection, chassis height and pitch) much faster than
+  /// letting the vehicle settle dynamically. On return, all velocities are zero,
+  /// the internal tire states are reset (see ChTire::ResetState), and the
+  /// simulation time is reset to its value at the time of the call.
+  /// Return false if the vehicle did not come to rest within the allotted time.
+  bool Settle(
+    double tolerance = 1e-3,   ///< [in] body speed below which the vehicle is considered at rest
+    double max_time = 5.0,     ///< [in] maximum settling time
+    double step = 1e-3         ///< [in] step size
+    );
+
+protected:
+
+  ChVehicle&                         m_vehicle;        ///< reference to the vehicle system
+  ChDriver&                          m_driver;         ///< reference to the driver system
+  ChTerrain&                         m_terrain;        ///< reference to the terrain system
+  ChPowertrain*                      m_powertrain;     ///< pointer to the powertrain system
+  std::vector<ChTire*>               m_tires;          ///< list of tires, indexed by wheel ID
+  ChSharedPtr<ChPowertrain>          m_powertrain_handle;  ///< keeps a shared powertrain alive (if any)
+  std::vector<ChSharedPtr<ChTire> >  m_tire_handles;   ///< keep shared tires alive (if any)
+
+  int                                m_num_wheels;     ///< number of vehicle wheels
+  double                             m_time;           ///< current simulation time
+  int                                m_step_number;    ///< number of steps taken
+
+  // Inter-module communication data (allocated at construction)
+  ChTireForces                       m_tire_forces;    ///< tire forces, indexed by wheel ID
+  ChWheelStates                      m_wheel_states;   ///< wheel states, indexed by wheel ID
+  double                             m_driveshaft_speed;   ///< driveshaft angular speed
+  double                             m_powertrain_torque;  ///< powertrain output torque
+  double                             m_throttle;       ///< driver throttle input
+  double                             m_steering;       ///< driver steering input
+  double                             m_braking;        ///< driver braking input
+
+  // Multi-rate scheduling data
+  double                             m_module_step[NUM_MODULES];   ///< per-module step size (0: outer step)
+  double                             m_module_time[NUM_MODULES];   ///< per-module current time
+  int                                m_module_count[NUM_MODULES];  ///< per-module number of steps
+  Coupling                           m_coupling;       ///< coupling type between modules
+  bool                               m_primed;         ///< true if exchanged outputs were initialized
+
+  ChSharedPtr<ChVehicleTermination>  m_termination;    ///< early-termination criteria (optional)
+  std::vector<int>                   m_tire_regions;   ///< profiling regions for tire Update/Advance (if enabled)
+
+private:
+
+  /// Outputs exchanged between modules in multi-rate mode.
+  struct ModuleOutputs {
+    double         throttle;
+    double         steering;
+    double         braking;
+    double         powertrain_torque;
+    double         driveshaft_speed;
+    ChTireForces   tire_forces;
+    ChWheelStates  wheel_states;
+  };
+
+  void AdvanceMultirate(double step);
+
+  void PrimeOutputs();
+  void SampleDriver();
+  void SampleTires();
+  void SamplePowertrain();
+  void SampleVehicle();
+
+  void Init();
+
+  double GetWeight(Module module, double time) const;
+
+  ModuleOutputs  m_prev;                         ///< previously exchanged module outputs
+  ModuleOutputs  m_curr;                         ///< most recently exchanged module outputs
+  double         m_sample_time[NUM_MODULES][2];  ///< times of previous and most recent outputs
+};
+
+
+} // end namespace chrono
+
+
+#endif
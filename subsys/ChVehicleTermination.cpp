@@ -0,0 +1,162 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Early-termination criteria for vehicle simulations.
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+
+#include "subsys/ChVehicleTermination.h"
+
+
+namespace chrono {
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChVehicleTermination::ChVehicleTermination()
+: m_max_roll(0),
+  m_max_pitch(0),
+  m_check_bounds(false),
+  m_xmin(0),
+  m_xmax(0),
+  m_ymin(0),
+  m_ymax(0),
+  m_stop_speed(0),
+  m_stop_duration(0),
+  m_max_violation(0),
+  m_violation_interval(10),
+  m_end_time(0)
+{
+  Reset();
+}
+
+void ChVehicleTermination::SetTerrainBounds(double xmin,
+                                            double xmax,
+                                            double ymin,
+                                            double ymax)
+{
+  m_check_bounds = true;
+  m_xmin = xmin;
+  m_xmax = xmax;
+  m_ymin = ymin;
+  m_ymax = ymax;
+}
+
+void ChVehicleTermination::SetStopCriterion(double speed,
+                                            double duration)
+{
+  m_stop_speed = speed;
+  m_stop_duration = duration;
+}
+
+void ChVehicleTermination::SetMaxConstraintViolation(double tolerance,
+                                                     int    interval)
+{
+  m_max_violation = tolerance;
+  m_violation_interval = std::max<>(interval, 1);
+}
+
+void ChVehicleTermination::Reset()
+{
+  m_stop_start = -1;
+  m_num_checks = 0;
+  m_reason = NONE;
+  m_time = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// All kinematic criteria use the vehicle state snapshot, so that no additional
+// queries of the Chrono system are needed (except for the constraint check).
+// -----------------------------------------------------------------------------
+ChVehicleTermination::Reason ChVehicleTermination::Check(const ChVehicle& vehicle,
+                                                         double           time)
+{
+  if (m_reason != NONE)
+    return m_reason;
+
+  const ChVehicleStateSnapshot& s = vehicle.GetStateSnapshot();
+  const ChQuaternion<>& q = s.chassis.rot;
+
+  Reason reason = NONE;
+
+  if (m_max_roll > 0) {
+    double roll = std::atan2(2 * (q.e0 * q.e1 + q.e2 * q.e3), 1 - 2 * (q.e1 * q.e1 + q.e2 * q.e2));
+    if (std::abs(roll) > m_max_roll)
+      reason = ROLLOVER;
+  }
+
+  if (reason == NONE && m_max_pitch > 0) {
+    double sp = 2 * (q.e0 * q.e2 - q.e3 * q.e1);
+    double pitch = std::asin(std::max<>(-1.0, std::min<>(1.0, sp)));
+    if (std::abs(pitch) > m_max_pitch)
+      reason = PITCHOVER;
+  }
+
+  if (reason == NONE && m_check_bounds) {
+    const ChVector<>& p = s.chassis.pos;
+    if (p.x < m_xmin || p.x > m_xmax || p.y < m_ymin || p.y > m_ymax)
+      reason = OFF_TERRAIN;
+  }
+
+  if (reason == NONE && m_stop_speed > 0) {
+    if (s.speed < m_stop_speed) {
+      if (m_stop_start < 0)
+        m_stop_start = time;
+      else if (time - m_stop_start >= m_stop_duration)
+        reason = STOPPED;
+    } else {
+      m_stop_start = -1;
+    }
+  }
+
+  if (reason == NONE && m_max_violation > 0 && m_num_checks % m_violation_interval == 0) {
+    if (vehicle.GetMaxConstraintViolation() > m_max_violation)
+      reason = CONSTRAINT_VIOLATION;
+  }
+
+  if (reason == NONE && m_end_time > 0 && time >= m_end_time)
+    reason = MANEUVER_FINISHED;
+
+  m_num_checks++;
+
+  if (reason != NONE) {
+    m_reason = reason;
+    m_time = time;
+  }
+
+  return reason;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const char* ChVehicleTermination::GetReasonName(Reason reason)
+{
+  switch (reason) {
+  case ROLLOVER:             return "rollover";
+  case PITCHOVER:            return "pitch-over";
+  case OFF_TERRAIN:          return "off terrain";
+  case STOPPED:              return "stopped";
+  case CONSTRAINT_VIOLATION: return "constraint violation";
+  case MANEUVER_FINISHED:    return "maneuver finished";
+  default:                   return "none";
+  }
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,133 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Early-termination criteria for vehicle simulations.
+//
+// A set of inexpensive predicates evaluated after each simulation step:
+//   - chassis roll or pitch angle above a limit
+//   - chassis reference frame outside a rectangular (terrain) region
+//   - vehicle speed below a threshold for a given duration
+//   - joint constraint violation above a tolerance
+//   - end of the driver maneuver reached
+// All criteria are disabled by default. The first criterion that is met stops
+// the simulation and is recorded, together with the time at which it occurred.
+//
+// =============================================================================
+
+#ifndef CH_VEHICLE_TERMINATION_H
+#define CH_VEHICLE_TERMINATION_H
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+#include "subsys/ChVehicle.h"
+
+namespace chrono {
+
+///
+/// Early-termination criteria for a vehicle simulation.
+///
+class CH_SUBSYS_API ChVehicleTermination : public ChShared
+{
+public:
+
+  /// Reason for terminating a simulation.
+  enum Reason {
+    NONE,                    ///< no criterion was met
+    ROLLOVER,                ///< chassis roll angle above limit
+    PITCHOVER,               ///< chassis pitch angle above limit
+    OFF_TERRAIN,             ///< chassis outside the terrain bounds
+    STOPPED,                 ///< vehicle speed below threshold for too long
+    CONSTRAINT_VIOLATION,    ///< joint constraint violation above tolerance
+    MANEUVER_FINISHED        ///< end of driver maneuver reached
+  };
+
+  ChVehicleTermination();
+  ~ChVehicleTermination() {}
+
+  /// Enable the rollover criterion (absolute chassis roll angle, in radians).
+  void SetRollLimit(double angle) { m_max_roll = angle; }
+
+  /// Enable the pitch-over criterion (absolute chassis pitch angle, in radians).
+  void SetPitchLimit(double angle) { m_max_pitch = angle; }
+
+  /// Enable the off-terrain criterion, with the given bounds in the XY plane.
+  void SetTerrainBounds(double xmin, double xmax, double ymin, double ymax);
+
+  /// Enable the off-terrain criterion for a terrain patch centered at the origin
+  /// (e.g., a RigidTerrain of the given dimensions).
+  void SetTerrainSize(double sizeX, double sizeY) { SetTerrainBounds(-sizeX / 2, sizeX / 2, -sizeY / 2, sizeY / 2); }
+
+  /// Enable the stopped-vehicle criterion.
+  /// The simulation is terminated once the vehicle speed remained below the
+  /// specified threshold for the given duration.
+  void SetStopCriterion(double speed, double duration);
+
+  /// Enable the constraint-violation criterion.
+  /// Since this requires a traversal of all joints, the violation is only
+  /// checked every 'interval' calls to Check().
+  void SetMaxConstraintViolation(double tolerance, int interval = 10);
+
+  /// Enable the end-of-maneuver criterion (e.g., ChDataDriver::GetEndTime()).
+  void SetManeuverEndTime(double time) { m_end_time = time; }
+
+  /// Clear the termination status (to be called before reusing this object
+  /// for a new simulation).
+  void Reset();
+
+  /// Evaluate all enabled criteria for the given vehicle at the given time.
+  /// Once a criterion was met, the same reason is returned until Reset().
+  Reason Check(
+    const ChVehicle& vehicle,   ///< [in] simulated vehicle (after a call to Advance)
+    double           time       ///< [in] current simulation time
+    );
+
+  /// Return true if a termination criterion was met.
+  bool IsTerminated() const { return m_reason != NONE; }
+
+  /// Get the reason for termination.
+  Reason GetReason() const { return m_reason; }
+
+  /// Get the time at which the termination criterion was met.
+  double GetTime() const { return m_time; }
+
+  /// Get a descriptive name for the specified reason.
+  static const char* GetReasonName(Reason reason);
+
+private:
+
+  double  m_max_roll;         ///< roll limit (disabled if not positive)
+  double  m_max_pitch;        ///< pitch limit (disabled if not positive)
+  bool    m_check_bounds;     ///< off-terrain criterion enabled?
+  double  m_xmin;             ///< terrain bounds
+  double  m_xmax;
+  double  m_ymin;
+  double  m_ymax;
+  double  m_stop_speed;       ///< speed threshold (disabled if not positive)
+  double  m_stop_duration;    ///< time below speed threshold before termination
+  double  m_max_violation;    ///< constraint violation tolerance (disabled if not positive)
+  int     m_violation_interval;   ///< number of calls between constraint checks
+  double  m_end_time;         ///< end of maneuver (disabled if not positive)
+
+  double  m_stop_start;       ///< time at which the speed dropped below threshold (negative if moving)
+  int     m_num_checks;       ///< number of calls to Check()
+  Reason  m_reason;           ///< termination reason
+  double  m_time;             ///< termination time
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -68,6 +68,18 @@ ChDataDriver::ChDataDriver(const std::vector<Entry>& data,
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDataDriver::SetData(const std::vector<Entry>& data,
+                           bool                      sorted)
+{
+  m_data = data;
+
+  if (!sorted)
+    std::sort(m_data.begin(), m_data.end(), ChDataDriver::compare);
+}
+
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChDataDriver::Update(double time)
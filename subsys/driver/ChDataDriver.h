@@ -52,6 +52,13 @@ public:
                bool                      sorted = true);
   ~ChDataDriver() {}
 
+  /// Replace the driver input data.
+  void SetData(const std::vector<Entry>& data,
+               bool                      sorted = true);
+
+  /// Get the time of the last driver input entry (end of the maneuver).
+  double GetEndTime() const { return m_data.empty() ? 0 : m_data.back().m_time; }
+
   virtual void Update(double time);
 
 private:
@@ -181,6 +181,39 @@ void ChShaftsPowertrain::SetDriveMode(ChPowertrain::DriveMode mmode)
 }
 
 
+// -----------------------------------------------------------------------------
+// Snapshot and restore. The transmission ratio of the gearbox is reset to
+// match the restored gear (or neutral).
+// -----------------------------------------------------------------------------
+void ChShaftsPowertrain::Snapshot(ChStateBuffer& buffer) const
+{
+  ChPowertrain::Snapshot(buffer);
+  buffer.Write(m_current_gear);
+  buffer.Write(m_last_time_gearshift);
+}
+
+bool ChShaftsPowertrain::Restore(ChStateBuffer& buffer)
+{
+  int gear;
+
+  if (!ChPowertrain::Restore(buffer) ||
+      !buffer.Read(gear) ||
+      !buffer.Read(m_last_time_gearshift))
+    return false;
+
+  if (m_drive_mode == NEUTRAL) {
+    m_current_gear = gear;
+    if (m_gears)
+      m_gears->SetTransmissionRatio(1e20);
+  }
+  else {
+    SetSelectedGear(gear);
+  }
+
+  return true;
+}
+
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChShaftsPowertrain::Update(double time,
@@ -205,7 +238,8 @@ void ChShaftsPowertrain::Update(double time,
   if (gearshaft_speed > 2500 * CH_C_2PI / 60.0) {
     // upshift if possible
     if (m_current_gear + 1 < m_gear_ratios.size()) {
-      GetLog() << "SHIFT UP " << m_current_gear << " -> " << m_current_gear + 1 << "\n";
+      if (m_verbose)
+        GetLog() << "SHIFT UP " << m_current_gear << " -> " << m_current_gear + 1 << "\n";
       SetSelectedGear(m_current_gear + 1);
       m_last_time_gearshift = time;
     }
@@ -213,7 +247,8 @@ void ChShaftsPowertrain::Update(double time,
   else if (gearshaft_speed < 1500 * CH_C_2PI / 60.0) {
     // downshift if possible
     if (m_current_gear - 1 > 0) {
-      GetLog() << "SHIFT DOWN " << m_current_gear << " -> " << m_current_gear - 1 << "\n";
+      if (m_verbose)
+        GetLog() << "SHIFT DOWN " << m_current_gear << " -> " << m_current_gear - 1 << "\n";
       SetSelectedGear(m_current_gear - 1);
       m_last_time_gearshift = time;
     }
@@ -107,6 +107,13 @@ public:
   /// state, this function does nothing.
   virtual void Advance(double step) {}
 
+  /// Append the state of this powertrain (drive mode, current gear, and time
+  /// of the last gear shift) to the specified buffer.
+  virtual void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the state of this powertrain from the specified buffer.
+  virtual bool Restore(ChStateBuffer& buffer);
+
 protected:
 
   /// Set up the gears, i.e. the transmission ratios of the various gears.
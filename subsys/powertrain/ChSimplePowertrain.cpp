@@ -52,6 +52,26 @@ void ChSimplePowertrain::SetDriveMode(ChPowertrain::DriveMode mode)
   }
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSimplePowertrain::Snapshot(ChStateBuffer& buffer) const
+{
+  ChPowertrain::Snapshot(buffer);
+  buffer.Write(m_current_gear_ratio);
+  buffer.Write(m_motorSpeed);
+  buffer.Write(m_motorTorque);
+  buffer.Write(m_shaftTorque);
+}
+
+bool ChSimplePowertrain::Restore(ChStateBuffer& buffer)
+{
+  return ChPowertrain::Restore(buffer) &&
+         buffer.Read(m_current_gear_ratio) &&
+         buffer.Read(m_motorSpeed) &&
+         buffer.Read(m_motorTorque) &&
+         buffer.Read(m_shaftTorque);
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void ChSimplePowertrain::Update(double time,
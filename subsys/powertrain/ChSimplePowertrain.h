@@ -86,6 +86,12 @@ public:
   /// This function does nothing for this simplified powertrain model.
   virtual void Advance(double step) {}
 
+  /// Append the state of this powertrain to the specified buffer.
+  virtual void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the state of this powertrain from the specified buffer.
+  virtual bool Restore(ChStateBuffer& buffer);
+
 protected:
 
   /// Return the forward gear ratio (single gear transmission)
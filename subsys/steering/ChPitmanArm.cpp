@@ -246,4 +246,14 @@ void ChPitmanArm::LogConstraintViolations()
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPitmanArm::GetConstraintLinks(std::vector<ChLink*>& links) const
+{
+  links.push_back(m_revolute.get_ptr());
+  links.push_back(m_universal.get_ptr());
+  links.push_back(m_revsph.get_ptr());
+}
+
+
 }  // end namespace chrono
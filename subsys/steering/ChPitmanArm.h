@@ -74,6 +74,9 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations();
 
+  /// Append the constraints of the steering mechanism to the given list.
+  virtual void GetConstraintLinks(std::vector<ChLink*>& links) const;
+
 protected:
 
   /// Identifiers for the various hardpoints.
@@ -148,4 +148,13 @@ void ChRackPinion::LogConstraintViolations()
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChRackPinion::GetConstraintLinks(std::vector<ChLink*>& links) const
+{
+  links.push_back(m_prismatic.get_ptr());
+  links.push_back(m_actuator.get_ptr());
+}
+
+
 }  // end namespace chrono
@@ -73,6 +73,9 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations();
 
+  /// Append the constraints of the steering mechanism to the given list.
+  virtual void GetConstraintLinks(std::vector<ChLink*>& links) const;
+
 protected:
 
   /// Return the mass of the steering link.
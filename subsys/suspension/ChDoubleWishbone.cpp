@@ -495,4 +495,17 @@ void ChDoubleWishbone::AddVisualizationSpindle(ChSharedBodyPtr spindle,
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDoubleWishbone::GetConstraintLinks(ChVehicleSide side, std::vector<ChLink*>& links) const
+{
+  links.push_back(m_revoluteLCA[side].get_ptr());
+  links.push_back(m_revoluteUCA[side].get_ptr());
+  links.push_back(m_revolute[side].get_ptr());
+  links.push_back(m_sphericalLCA[side].get_ptr());
+  links.push_back(m_sphericalUCA[side].get_ptr());
+  links.push_back(m_distTierod[side].get_ptr());
+}
+
+
 } // end namespace chrono
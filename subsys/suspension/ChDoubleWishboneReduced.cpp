@@ -267,4 +267,17 @@ void ChDoubleWishboneReduced::LogConstraintViolations(ChVehicleSide side)
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChDoubleWishboneReduced::GetConstraintLinks(ChVehicleSide side, std::vector<ChLink*>& links) const
+{
+  links.push_back(m_revolute[side].get_ptr());
+  links.push_back(m_distUCA_F[side].get_ptr());
+  links.push_back(m_distUCA_B[side].get_ptr());
+  links.push_back(m_distLCA_F[side].get_ptr());
+  links.push_back(m_distLCA_B[side].get_ptr());
+  links.push_back(m_distTierod[side].get_ptr());
+}
+
+
 } // end namespace chrono
@@ -79,6 +79,9 @@ public:
   /// Log current constraint violations.
   virtual void LogConstraintViolations(ChVehicleSide side);
 
+  /// Append the constraints of the specified side to the given list.
+  virtual void GetConstraintLinks(ChVehicleSide side, std::vector<ChLink*>& links) const;
+
 protected:
 
   /// Identifiers for the various hardpoints.
@@ -615,4 +615,19 @@ void ChMultiLink::AddVisualizationSpindle(ChSharedBodyPtr spindle,
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChMultiLink::GetConstraintLinks(ChVehicleSide side, std::vector<ChLink*>& links) const
+{
+  links.push_back(m_revoluteUA[side].get_ptr());
+  links.push_back(m_revolute[side].get_ptr());
+  links.push_back(m_sphericalUA[side].get_ptr());
+  links.push_back(m_sphericalLateralUpright[side].get_ptr());
+  links.push_back(m_sphericalTLUpright[side].get_ptr());
+  links.push_back(m_universalLateralChassis[side].get_ptr());
+  links.push_back(m_universalTLChassis[side].get_ptr());
+  links.push_back(m_distTierod[side].get_ptr());
+}
+
+
 } // end namespace chrono
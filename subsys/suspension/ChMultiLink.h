@@ -76,27 +76,33 @@ public:
     ChSharedPtr<ChBody>        tierod_body  ///< [in] body to which tireods are connected
     );
 
+  /// This suspension has separate spring and shock elements.
+  virtual bool HasSpringShock() const { return true; }
+
   /// Get the force in the spring element.
-  double GetSpringForce(ChVehicleSide side) const { return m_spring[side]->Get_SpringReact(); }
+  virtual double GetSpringForce(ChVehicleSide side) const { return m_spring[side]->Get_SpringReact(); }
 
   /// Get the current length of the spring element
-  double GetSpringLength(ChVehicleSide side) const { return m_spring[side]->Get_SpringLength(); }
+  virtual double GetSpringLength(ChVehicleSide side) const { return m_spring[side]->Get_SpringLength(); }
 
   /// Get the current deformation of the spring element.
   double GetSpringDeformation(ChVehicleSide side) const { return m_spring[side]->Get_SpringDeform(); }
 
   /// Get the force in the shock (damper) element.
-  double GetShockForce(ChVehicleSide side) const { return m_shock[side]->Get_SpringReact(); }
+  virtual double GetShockForce(ChVehicleSide side) const { return m_shock[side]->Get_SpringReact(); }
 
   /// Get the current length of the shock (damper) element.
   double GetShockLength(ChVehicleSide side) const { return m_shock[side]->Get_SpringLength(); }
 
   /// Get the current deformation velocity of the shock (damper) element.
-  double GetShockVelocity(ChVehicleSide side) const { return m_shock[side]->Get_SpringVelocity(); }
+  virtual double GetShockVelocity(ChVehicleSide side) const { return m_shock[side]->Get_SpringVelocity(); }
 
   /// Log current constraint violations.
   virtual void LogConstraintViolations(ChVehicleSide side);
 
+  /// Append the constraints of the specified side to the given list.
+  virtual void GetConstraintLinks(ChVehicleSide side, std::vector<ChLink*>& links) const;
+
   /// Log the locations of all hardpoints.
   /// The reported locations are expressed in the suspension reference frame.
   /// By default, these values are reported in SI units (meters), but can be
@@ -469,4 +469,17 @@ void ChSolidAxle::AddVisualizationKnuckle(ChSharedBodyPtr   knuckle,
 }
 
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChSolidAxle::GetConstraintLinks(ChVehicleSide side, std::vector<ChLink*>& links) const
+{
+  links.push_back(m_revoluteKingpin[side].get_ptr());
+  links.push_back(m_sphericalUpperLink[side].get_ptr());
+  links.push_back(m_sphericalLowerLink[side].get_ptr());
+  links.push_back(m_universalUpperLink[side].get_ptr());
+  links.push_back(m_universalLowerLink[side].get_ptr());
+  links.push_back(m_distTierod[side].get_ptr());
+}
+
+
 } // end namespace chrono
@@ -23,6 +23,7 @@
 #include <fstream>
 
 #include "subsys/suspensionTest/SuspensionTest.h"
+#include "subsys/ChTelemetryWriter.h"
 
 #include "assets/ChSphereShape.h"
 #include "assets/ChCylinderShape.h"
@@ -77,7 +78,8 @@ static ChQuaternion<> loadQuaternion(const Value& a)
 // Constructor guaranteers that <ChBody> objects are Added to the system here
 // Links are added to the system during Initialize()
 SuspensionTest::SuspensionTest(const std::string& filename): 
-  m_num_axles(1), m_save_log_to_file(false), m_log_file_exists(false), m_log_what(0)
+  m_num_axles(1), m_save_log_to_file(false), m_log_file_exists(false), m_log_what(0),
+  m_log_writer(NULL), m_log_stream(-1)
 {
 
   // Open and parse the input file
@@ -320,11 +322,13 @@ void SuspensionTest::Update(double       time,
 // creates a new file (or overwrites old existing one), and sets the first row w/ headers
 // for easy postprocessing with python pandas scripts
 void SuspensionTest::Save_DebugLog(int what,
-                                   const std::string& filename)
+                                   const std::string& filename,
+                                   ChTelemetryWriter* writer)
 {
   m_log_file_name = filename;
   m_save_log_to_file = true;
   m_log_what = what;
+  m_log_writer = writer;
   
   create_fileHeader(what);
   m_log_file_exists = true;
@@ -427,33 +431,31 @@ void SuspensionTest::SaveLog()
     {
       std::cerr << "Must call Save_DebugLog() before trying to save the log data to file!!! \n\n\n";
     }
-    // open the file to append
-    // open the data file for writing the header
-  ChStreamOutAsciiFile ofile(m_log_file_name.c_str(), std::ios::app);
 
-    // write the simulation time first, and rig inputs
-    std::stringstream ss;
-    ss << GetChTime() <<","<< m_steer <<","<< m_postDisp[LEFT] /in2m <<","<< m_postDisp[RIGHT] / in2m;
+    // collect the rig inputs (the simulation time is written first)
+    double values[32];
+    int n = 0;
+    values[n++] = m_steer;
+    values[n++] = m_postDisp[LEFT] / in2m;
+    values[n++] = m_postDisp[RIGHT] / in2m;
 
-    // python pandas expects csv w/ no whitespace
     if( m_log_what & DBG_SPRINGS )
     {
-      ss << "," << GetSpringLength(FRONT_LEFT) / in2m << ","
-        << GetSpringLength(FRONT_RIGHT) / in2m << ","
-        << GetSpringDeformation(FRONT_LEFT) / in2m << ","
-        << GetSpringDeformation(FRONT_RIGHT) / in2m << ","
-        << GetSpringForce(FRONT_LEFT) / lbf2N << ","
-        << GetSpringForce(FRONT_RIGHT) / lbf2N;
-  
+      values[n++] = GetSpringLength(FRONT_LEFT) / in2m;
+      values[n++] = GetSpringLength(FRONT_RIGHT) / in2m;
+      values[n++] = GetSpringDeformation(FRONT_LEFT) / in2m;
+      values[n++] = GetSpringDeformation(FRONT_RIGHT) / in2m;
+      values[n++] = GetSpringForce(FRONT_LEFT) / lbf2N;
+      values[n++] = GetSpringForce(FRONT_RIGHT) / lbf2N;
     }
     if (m_log_what & DBG_SHOCKS)
     {
-      ss << "," << GetShockLength(FRONT_LEFT) / in2m << ","
-        << GetShockLength(FRONT_RIGHT) / in2m << ","
-        << GetShockVelocity(FRONT_LEFT) / in2m << ","
-        << GetShockVelocity(FRONT_RIGHT) / in2m << ","
-        << GetShockForce(FRONT_LEFT) / lbf2N << ","
-        << GetShockForce(FRONT_RIGHT) / lbf2N;
+      values[n++] = GetShockLength(FRONT_LEFT) / in2m;
+      values[n++] = GetShockLength(FRONT_RIGHT) / in2m;
+      values[n++] = GetShockVelocity(FRONT_LEFT) / in2m;
+      values[n++] = GetShockVelocity(FRONT_RIGHT) / in2m;
+      values[n++] = GetShockForce(FRONT_LEFT) / lbf2N;
+      values[n++] = GetShockForce(FRONT_RIGHT) / lbf2N;
     }
 
     if (m_log_what & DBG_CONSTRAINTS)
@@ -465,21 +467,42 @@ void SuspensionTest::SaveLog()
     // ",KA_L,KA_R,Koff_L,Koff_R,CA_L,CA_R,Coff_L,Coff_R,TA_L,TA_R,LCA_roll";
     if (m_log_what & DBG_SUSPENSIONTEST)
     {
-      ss <<","<< Get_KingpinAng(LEFT)*rad2deg <<","<< Get_KingpinAng(RIGHT)*rad2deg 
-        <<","<< Get_KingpinOffset(LEFT)/in2m <<","<< Get_KingpinOffset(RIGHT)/in2m
-        <<","<< Get_CasterAng(LEFT)*rad2deg <<","<< Get_CasterAng(RIGHT)*rad2deg 
-        <<","<< Get_CasterOffset(LEFT)/in2m <<","<< Get_CasterOffset(RIGHT)/in2m
-        <<","<< Get_ToeAng(LEFT)*rad2deg <<","<< Get_ToeAng(RIGHT)*rad2deg
-        <<","<< Get_LCArollAng();
+      values[n++] = Get_KingpinAng(LEFT)*rad2deg;
+      values[n++] = Get_KingpinAng(RIGHT)*rad2deg;
+      values[n++] = Get_KingpinOffset(LEFT)/in2m;
+      values[n++] = Get_KingpinOffset(RIGHT)/in2m;
+      values[n++] = Get_CasterAng(LEFT)*rad2deg;
+      values[n++] = Get_CasterAng(RIGHT)*rad2deg;
+      values[n++] = Get_CasterOffset(LEFT)/in2m;
+      values[n++] = Get_CasterOffset(RIGHT)/in2m;
+      values[n++] = Get_ToeAng(LEFT)*rad2deg;
+      values[n++] = Get_ToeAng(RIGHT)*rad2deg;
+      values[n++] = Get_LCArollAng();
       /*
-      ss << "," << GetActuatorDisp(FRONT_LEFT) / in2m << ","
-        << GetActuatorDisp(FRONT_RIGHT) / in2m << ","
-        << GetActuatorForce(FRONT_LEFT) / in2m << ","
-        << GetActuatorForce(FRONT_RIGHT) / in2m << ","
-        << GetActuatorMarkerDist(FRONT_LEFT) / in2m << ","
-        << GetActuatorMarkerDist(FRONT_RIGHT) / in2m;
+      values[n++] = GetActuatorDisp(FRONT_LEFT) / in2m;
+      values[n++] = GetActuatorDisp(FRONT_RIGHT) / in2m;
+      values[n++] = GetActuatorForce(FRONT_LEFT) / in2m;
+      values[n++] = GetActuatorForce(FRONT_RIGHT) / in2m;
+      values[n++] = GetActuatorMarkerDist(FRONT_LEFT) / in2m;
+      values[n++] = GetActuatorMarkerDist(FRONT_RIGHT) / in2m;
        */
     }
+
+    if (m_log_writer)
+    {
+      m_log_writer->Push(m_log_stream, GetChTime(), n, values);
+      return;
+    }
+
+    // open the file to append
+    ChStreamOutAsciiFile ofile(m_log_file_name.c_str(), std::ios::app);
+
+    // python pandas expects csv w/ no whitespace
+    std::stringstream ss;
+    ss << GetChTime();
+    for (int i = 0; i < n; i++)
+      ss << "," << values[i];
+
     // next line last, then write to file
     ss << "\n";
     ofile << ss.str().c_str();
@@ -866,8 +889,6 @@ void SuspensionTest::AddVisualize_post(ChSharedBodyPtr post_body,
 
 void SuspensionTest::create_fileHeader(int what)
 {
-  // open the data file for writing the header
-  ChStreamOutAsciiFile ofile(m_log_file_name.c_str());
   // write the headers, output types specified by "what"
   std::stringstream ss;
   ss << "time,steer,postDisp_L,postDisp_R";
@@ -889,9 +910,21 @@ void SuspensionTest::create_fileHeader(int what)
     ss << ",KA_L,KA_R,Koff_L,Koff_R,CA_L,CA_R,Coff_L,Coff_R,TA_L,TA_R,LCA_roll";
   }
 
-  // write to file, go to next line in file in prep. for next step.
-  ofile << ss.str().c_str();
-  ofile << "\n";
+  // with an asynchronous writer, the stream writes the header
+  if (m_log_writer)
+  {
+    m_log_stream = m_log_writer->AddStream(m_log_file_name, ss.str(), ',');
+    if (m_log_stream < 0)
+      m_log_writer = NULL;
+  }
+
+  if (!m_log_writer)
+  {
+    // write to file, go to next line in file in prep. for next step.
+    ChStreamOutAsciiFile ofile(m_log_file_name.c_str());
+    ofile << ss.str().c_str();
+    ofile << "\n";
+  }
 }
 
 
@@ -27,6 +27,8 @@
 
 namespace chrono {
 
+class ChTelemetryWriter;
+
 class CH_SUBSYS_API SuspensionTest : public ChSuspensionTest
 {
 public:
@@ -55,8 +57,11 @@ public:
 
   /// setup class to save the log to a file for python postprocessing.
   /// Usage: call after construction & Initialize(), else no data is saved.
+  /// If a telemetry writer is specified, the log is written through it (i.e.,
+  /// formatted and written in the background).
   void Save_DebugLog(int what,
-                     const std::string& out_filename = "log_SuspensionTest.csv");
+                     const std::string& out_filename = "log_SuspensionTest.csv",
+                     ChTelemetryWriter* writer = NULL);
 
   // Accessors
   double GetSpringForce(const ChWheelID& wheel_id) const;
@@ -100,6 +105,8 @@ private:
   bool m_log_file_exists;                     // written the headers for log file yet?
   std::string m_log_file_name;
   int m_log_what;
+  ChTelemetryWriter* m_log_writer;            // asynchronous writer for the log (may be NULL)
+  int m_log_stream;                           // stream identifier in m_log_writer
 
   // rig/steer inputs 
   double m_steer;
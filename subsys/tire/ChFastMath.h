@@ -0,0 +1,179 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Branch-free elementary functions for the batch tire model evaluators.
+//
+// These are the Cephes double precision approximations (range reduction
+// followed by a minimax polynomial or rational approximation), rewritten so
+// that all candidate results are computed and the range selections are done
+// with conditional moves instead of branches. When called from a simple loop
+// over contiguous arrays, the compiler can therefore vectorize the loop body
+// (SSE2/AVX/NEON). Note that GCC and Clang only if-convert floating point
+// selections when compiled with -fno-trapping-math.
+//
+// Accuracy, relative to the <cmath> functions:
+//   FastAtan       all x                          2 ulp
+//   FastSin/Cos    |x| < 2^30                     2 ulp (absolute 1e-16)
+//   FastExp        -708 < x < 709                 2 ulp
+//
+// =============================================================================
+
+#ifndef CH_FAST_MATH_H
+#define CH_FAST_MATH_H
+
+#include <cmath>
+#include <cstring>
+
+namespace chrono {
+
+// -----------------------------------------------------------------------------
+// Arc tangent.
+// -----------------------------------------------------------------------------
+inline double FastAtan(double x)
+{
+  static const double T3P8 = 2.41421356237309504880;      // tan(3 pi / 8)
+  static const double MOREBITS = 6.123233995736765886130e-17;
+
+  double sgn = (x < 0) ? -1.0 : 1.0;
+  double a = std::abs(x);
+
+  // Reduce to |xr| <= 0.66
+  bool big = a > T3P8;
+  bool mid = !big && a > 0.66;
+  double y0 = big ? 1.57079632679489661923 : (mid ? 0.78539816339744830962 : 0.0);
+  double xr_big = -1.0 / a;
+  double xr_mid = (a - 1.0) / (a + 1.0);
+  double xr = big ? xr_big : (mid ? xr_mid : a);
+  double more = big ? MOREBITS : (mid ? 0.5 * MOREBITS : 0.0);
+
+  double z = xr * xr;
+  double p = (((-8.750608600031904122785e-1 * z
+                - 1.615753718733365076637e1) * z
+                - 7.500855792314704667340e1) * z
+                - 1.228866684490136173410e2) * z
+                - 6.485021904942025371773e1;
+  double q = ((((z + 2.485846490142306297962e1) * z
+                   + 1.650270098316988542046e2) * z
+                   + 4.328810604912902668951e2) * z
+                   + 4.853903996359136964868e2) * z
+                   + 1.945506571482613964425e2;
+
+  return sgn * (y0 + (xr * z * p / q + xr + more));
+}
+
+// -----------------------------------------------------------------------------
+// Sine and cosine. Both share the reduction modulo pi/4; the reduced argument
+// z is then evaluated with either the sine or the cosine polynomial.
+// -----------------------------------------------------------------------------
+inline double FastSinPoly(double z, double zz)
+{
+  return z + z * zz * (((((1.58962301576546568060e-10 * zz
+                           - 2.50507477628578072866e-8) * zz
+                           + 2.75573136213857245213e-6) * zz
+                           - 1.98412698295895385996e-4) * zz
+                           + 8.33333333332211858878e-3) * zz
+                           - 1.66666666666666307295e-1);
+}
+
+inline double FastCosPoly(double zz)
+{
+  return 1.0 - 0.5 * zz + zz * zz * (((((-1.13585365213876817300e-11 * zz
+                                         + 2.08757008419747316778e-9) * zz
+                                         - 2.75573141792967388112e-7) * zz
+                                         + 2.48015872888517045348e-5) * zz
+                                         - 1.38888888888730564116e-3) * zz
+                                         + 4.16666666666665929218e-2);
+}
+
+inline double FastSin(double x)
+{
+  double sgn = (x < 0) ? -1.0 : 1.0;
+  double a = std::abs(x);
+
+  // Octant, rounded up to even
+  int j = (int)(a * 1.27323954473516268615);
+  j += (j & 1);
+  double y = (double)j;
+  j &= 7;
+  sgn = (j > 3) ? -sgn : sgn;
+  j = (j > 3) ? j - 4 : j;
+
+  // Extended precision modular arithmetic
+  double z = ((a - y * 7.85398125648498535156e-1) - y * 3.77489470793079817668e-8) - y * 2.69515142907905952645e-15;
+  double zz = z * z;
+
+  double ps = FastSinPoly(z, zz);
+  double pc = FastCosPoly(zz);
+
+  return sgn * ((j == 2) ? pc : ps);
+}
+
+inline double FastCos(double x)
+{
+  double a = std::abs(x);
+
+  int j = (int)(a * 1.27323954473516268615);
+  j += (j & 1);
+  double y = (double)j;
+  j &= 7;
+  double sgn = (j > 3) ? -1.0 : 1.0;
+  j = (j > 3) ? j - 4 : j;
+  sgn = (j > 1) ? -sgn : sgn;
+
+  double z = ((a - y * 7.85398125648498535156e-1) - y * 3.77489470793079817668e-8) - y * 2.69515142907905952645e-15;
+  double zz = z * z;
+
+  double ps = FastSinPoly(z, zz);
+  double pc = FastCosPoly(zz);
+
+  return sgn * ((j == 2) ? ps : pc);
+}
+
+// -----------------------------------------------------------------------------
+// Exponential, as 2^n * exp(r) with |r| <= ln(2)/2.
+// -----------------------------------------------------------------------------
+inline double FastExp(double x)
+{
+  x = (x < -708.0) ? -708.0 : ((x > 709.0) ? 709.0 : x);
+
+  // Nearest integer to x/ln(2) (truncation toward zero, which unlike floor()
+  // does not require SSE4.1 to vectorize)
+  double t = 1.4426950408889634073599 * x;
+  double px = (double)(int)(t + ((t < 0) ? -0.5 : 0.5));
+  x -= px * 6.93145751953125e-1;
+  x -= px * 1.42860682030941723212e-6;
+
+  double xx = x * x;
+  double p = x * ((1.26177193074810590878e-4 * xx + 3.02994407707441961300e-2) * xx + 9.99999999999999999910e-1);
+  double q = ((3.00198505138664455042e-6 * xx + 2.52448340349684104192e-3) * xx + 2.27265548208155028766e-1) * xx + 2.00000000000000000009e0;
+  x = 1.0 + 2.0 * p / (q - p);
+
+  // Scale by 2^px, assembling the exponent bits directly (ldexp is a library
+  // call and would prevent vectorization). Adding 2^52 places the biased
+  // exponent px + 1023 in the low mantissa bits.
+  double biased = px + 1023.0 + 4503599627370496.0;
+  unsigned long long bits;
+  std::memcpy(&bits, &biased, sizeof(double));
+  bits <<= 52;
+  double scale;
+  std::memcpy(&scale, &bits, sizeof(double));
+
+  return x * scale;
+}
+
+
+}  // end namespace chrono
+
+
+#endif
@@ -29,6 +29,7 @@
 #include "assets/ChColorAsset.h"
 
 #include "subsys/tire/ChLugreTire.h"
+#include "subsys/ChPerfCounters.h"
 
 
 namespace chrono {
@@ -57,7 +58,12 @@ void ChLugreTire::Initialize()
   SetLugreParams();
 
   // Initialize disc states
-  for (int id = 0; id < getNumDiscs(); id++) {
+  ResetState();
+}
+
+void ChLugreTire::ResetState()
+{
+  for (size_t id = 0; id < m_state.size(); id++) {
     m_state[id].z0 = 0;
     m_state[id].z1 = 0;
   }
@@ -91,6 +97,8 @@ void ChLugreTire::Initialize(ChSharedPtr<ChBody> wheel)
 void ChLugreTire::Update(double               time,
                          const ChWheelState&  wheel_state)
 {
+  CH_PERF_SCOPE("ChLugreTire::Update");
+
   double disc_radius = getRadius();
   const double* disc_locs = getDiscLocations();
 
@@ -163,6 +171,8 @@ void ChLugreTire::Update(double               time,
 // -----------------------------------------------------------------------------
 void ChLugreTire::Advance(double step)
 {
+  CH_PERF_SCOPE("ChLugreTire::Advance");
+
   for (int id = 0; id < getNumDiscs(); id++) {
 
     // Nothing to do if this disc is not in contact
@@ -240,5 +250,37 @@ void ChLugreTire::Advance(double step)
 }
 
 
+// -----------------------------------------------------------------------------
+// Snapshot and restore the tire internal state. The number of discs is stored
+// and checked on restore.
+// -----------------------------------------------------------------------------
+void ChLugreTire::Snapshot(ChStateBuffer& buffer) const
+{
+  int num_discs = (int)m_state.size();
+
+  buffer.Write(num_discs);
+  if (num_discs > 0) {
+    buffer.WriteArray(&m_state[0], m_state.size());
+    buffer.WriteArray(&m_data[0], m_data.size());
+  }
+  buffer.Write(m_tireForce);
+}
+
+bool ChLugreTire::Restore(ChStateBuffer& buffer)
+{
+  int num_discs;
+
+  if (!buffer.Read(num_discs) || num_discs != (int)m_state.size())
+    return false;
+
+  if (num_discs > 0) {
+    if (!buffer.ReadArray(&m_state[0], m_state.size()) ||
+        !buffer.ReadArray(&m_data[0], m_data.size()))
+      return false;
+  }
+
+  return buffer.Read(m_tireForce);
+}
+
 
 } // end namespace chrono
@@ -67,6 +67,16 @@ public:
   /// Advance the state of this tire by the specified time step.
   virtual void Advance(double step);
 
+  /// Append the internal state of this tire (disc bristle deflections and
+  /// current tire force) to the specified buffer.
+  virtual void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the internal state of this tire from the specified buffer.
+  virtual bool Restore(ChStateBuffer& buffer);
+
+  /// Reset the disc bristle deflections to zero.
+  virtual void ResetState();
+
   /// Set the value of the integration step size for the underlying dynamics.
   void SetStepsize(double val) { m_stepsize = val; }
 
@@ -376,6 +376,61 @@ struct bessel {
   double v_sigma;
 };
 
+// Magic Formula coefficients that only depend on the vertical load and the
+// camber, cached between steps. The remaining factors are applied per step,
+// as noted.
+struct loadCoefs {
+  bool   valid;       // false until the first evaluation
+  double Fz;          // vertical load at which the coefficients were evaluated
+  double gamma;       // camber gammaP at which the coefficients were evaluated
+  bool   valid_relax; // false until the first relaxation length evaluation
+  double Fz_relax;    // vertical load at which the relaxation lengths were evaluated
+
+  // pure longitudinal slip
+  double S_Hx;
+  double mu_x;
+  double K_x;
+  double C_x;
+  double D_x;
+  double B_x;
+  double E_x0;        // E_x = E_x0 * (1 - pex4 * sign(kappa_x)) * lex
+  double S_Vx;
+
+  // pure lateral slip
+  double S_Hy;
+  double mu_y;
+  double K_y;
+  double S_Vy;
+  double B_y;
+  double C_y;
+  double D_y;
+  double E_y0;        // E_y = E_y0 * (1 - E_y1 * sign(alpha_y)) * ley
+  double E_y1;
+
+  // pure slip aligning moment
+  double S_Hf;
+  double S_Ht;
+  double B_r;
+  double C_r;
+  double D_r0;        // D_r = D_r0 * cos'(alpha) * sign(V_cx) + z8 - 1
+  double B_t;
+  double C_t;
+  double D_t0;        // D_t0 without the sign(V_cx) factor
+  double D_tGamma;    // D_t = D_t0 * sign(V_cx) * D_tGamma * z5 * ltr
+  double E_t0;        // E_t = E_t0 * (1 + E_t1 * (2/pi) * atan(B_t * C_t * alpha_t))
+  double E_t1;
+
+  // combined slip
+  double B_xAlpha0;   // B_xAlpha = B_xAlpha0 * cos(atan(rbx2 * kappa)) * lxal
+  double E_xAlpha;
+  double S_HyKappa;
+  double B_yKappa0;   // B_yKappa = B_yKappa0 * cos(atan(rby2 * (alpha - rby3))) * lyka
+  double E_yKappa;
+  double D_VyKappa0;  // D_VyKappa = D_VyKappa0 * cos(atan(rvy4 * alpha)) * z2
+  double K_xy2;       // (K_x / K_y)^2
+  double s_gamma;     // camber term of the Mz moment arm s
+};
+
 } // end namespace chrono
 
 
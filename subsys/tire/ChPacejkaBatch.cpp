@@ -0,0 +1,216 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Stateless batch evaluator of the Pac2002 steady-state Magic Formula.
+//
+// =============================================================================
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "core/ChMathematics.h"
+
+#include "subsys/tire/ChPacejkaBatch.h"
+#include "subsys/tire/ChPac2002_data.h"
+#include "subsys/tire/ChFastMath.h"
+
+namespace chrono {
+
+
+// Inner term of the Magic Formula: atan(B*x - E*(B*x - atan(B*x)))
+static inline double MF_atan(double B, double E, double x)
+{
+  double Bx = B * x;
+  return FastAtan(Bx - E * (Bx - FastAtan(Bx)));
+}
+
+// cos(atan(x)), without transcendental calls
+static inline double cos_atan(double x)
+{
+  return 1.0 / std::sqrt(1.0 + x * x);
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPacejkaBatch::ChPacejkaBatch(const Pac2002_data& params)
+: m_params(params)
+{
+}
+
+
+// -----------------------------------------------------------------------------
+// Process the points in blocks. Results are computed into block-local arrays
+// (which cannot alias the inputs) and then copied to the requested outputs.
+// -----------------------------------------------------------------------------
+void ChPacejkaBatch::Evaluate(int n, const Inputs& in, const Outputs& out) const
+{
+  for (int offset = 0; offset < n; offset += BLOCK_SIZE)
+    EvaluateBlock(n, in, out, offset);
+}
+
+
+// -----------------------------------------------------------------------------
+// The equations below follow ChPacejkaTire::fusedSlipReactions, calc_Mx and
+// calc_My, with all zeta factors set to 1 and sign(V_cx) = 1. Terms of the form
+// cos(C*atan(x)) with C = 1 are evaluated as 1/sqrt(1+x^2).
+// -----------------------------------------------------------------------------
+void ChPacejkaBatch::EvaluateBlock(int n, const Inputs& in, const Outputs& out, int offset) const
+{
+  const int m = (n - offset < BLOCK_SIZE) ? n - offset : BLOCK_SIZE;
+
+  const double* kappa = in.kappa + offset;
+  const double* alpha = in.alpha + offset;
+  const double* gamma = in.gamma + offset;
+  const double* Fz = in.Fz + offset;
+
+  const longitudinal_coefficients& lon = m_params.longitudinal;
+  const lateral_coefficients& lat = m_params.lateral;
+  const aligning_coefficients& al = m_params.aligning;
+  const scaling_coefficients& sc = m_params.scaling;
+
+  const double fnomin = m_params.vertical.fnomin;
+  const double R0 = m_params.dimension.unloaded_radius;
+
+  // Rolling speed for My
+  double V_r[BLOCK_SIZE];
+  for (int i = 0; i < m; i++)
+    V_r[i] = in.V_r ? in.V_r[offset + i] : m_params.model.longvl;
+
+  // Load independent shape factors
+  const double C_x = lon.pcx1 * sc.lcx;
+  const double C_y = lat.pcy1 * sc.lcy;
+  const double C_t = al.qcz1;
+  const double C_xAlpha = lon.rcx1;
+  const double C_yKappa = lat.rcy1;
+  const double S_HxAlpha = lon.rhx1;
+  const double rbx3 = 1.0;
+
+  double Fx0[BLOCK_SIZE], Fy0[BLOCK_SIZE], Mz0[BLOCK_SIZE];
+  double Fx[BLOCK_SIZE], Fy[BLOCK_SIZE], Mx[BLOCK_SIZE], My[BLOCK_SIZE], Mz[BLOCK_SIZE];
+  double Dy[BLOCK_SIZE], SHf[BLOCK_SIZE], Kxy[BLOCK_SIZE];
+
+  for (int i = 0; i < m; i++) {
+    double k = kappa[i];
+    double a = alpha[i];
+    double g = gamma[i];
+    double fz = Fz[i];
+
+    double dfz = (fz - fnomin) / fnomin;
+    double dfz2 = dfz * dfz;
+    double g2 = g * g;
+    double ag = std::abs(g);
+    double cpa = 1.0 / std::sqrt(1.0 + a * a);
+
+    // Pure longitudinal slip
+    double S_Hx = (lon.phx1 + lon.phx2 * dfz) * sc.lhx;
+    double kappa_x = k + S_Hx;
+    double mu_x = (lon.pdx1 + lon.pdx2 * dfz) * (1.0 - lon.pdx3 * g2) * sc.lmux;
+    double K_x = fz * (lon.pkx1 + lon.pkx2 * dfz) * FastExp(lon.pkx3 * dfz) * sc.lkx;
+    double D_x = mu_x * fz;
+    double B_x = K_x / (C_x * D_x);
+    double sign_kap = (kappa_x >= 0) ? 1.0 : -1.0;
+    double E_x = (lon.pex1 + lon.pex2 * dfz + lon.pex3 * dfz2) * (1.0 - lon.pex4 * sign_kap) * sc.lex;
+    double S_Vx = fz * (lon.pvx1 + lon.pvx2 * dfz) * sc.lvx * sc.lmux;
+    double F_x0 = D_x * FastSin(C_x * MF_atan(B_x, E_x, kappa_x)) - S_Vx;
+
+    // Pure lateral slip
+    double mu_y = (lat.pdy1 + lat.pdy2 * dfz) * (1.0 - lat.pdy3 * g2) * sc.lmuy;
+    double D_y = mu_y * fz;
+    double K_y = lat.pky1 * fnomin * FastSin(2.0 * FastAtan(fz / (lat.pky2 * fnomin))) * (1.0 - lat.pky3 * ag) * sc.lyka;
+    double B_y = K_y / (C_y * D_y);
+    double S_Hy = (lat.phy1 + lat.phy2 * dfz) * sc.lhy + lat.phy3 * g;
+    double alpha_y = a + S_Hy;
+    double sign_alpha = (alpha_y >= 0) ? 1.0 : -1.0;
+    double E_y = (lat.pey1 + lat.pey2 * dfz) * (1.0 - (lat.pey3 + lat.pey4 * g) * sign_alpha) * sc.ley;
+    double S_Vy = fz * ((lat.pvy1 + lat.pvy2 * dfz) * sc.lvy + (lat.pvy3 + lat.pvy4 * dfz) * g) * sc.lmuy;
+    double F_y0 = D_y * FastSin(C_y * MF_atan(B_y, E_y, alpha_y)) + S_Vy;
+
+    // Pure slip aligning moment
+    double S_Hf = S_Hy + S_Vy / K_y;
+    double alpha_r = a + S_Hf;
+    double alpha_t = a + al.qhz1 + al.qhz2 * dfz + (al.qhz3 + al.qhz4 * dfz) * g;
+    double B_r = al.qbz9 * (sc.lky / sc.lmuy) + al.qbz10 * B_y * C_y;
+    double D_r = fz * R0 * ((al.qdz6 + al.qdz7 * dfz) * sc.lres + (al.qdz8 + al.qdz9 * dfz) * g) * sc.lmuy * cpa;
+    double B_t = (al.qbz1 + al.qbz2 * dfz + al.qbz3 * dfz2) * (1.0 + al.qbz4 * g + al.qbz5 * ag) * sc.lvyka / sc.lmuy;
+    double D_t = fz * (R0 / fnomin) * (al.qdz1 + al.qdz2 * dfz) * (1.0 + al.qdz3 * ag + al.qdz4 * g2) * sc.ltr;
+    double E_t = (al.qez1 + al.qez2 * dfz + al.qez3 * dfz2) * (1.0 + (al.qez4 + al.qez5 * g) * (2.0 / CH_C_PI) * FastAtan(B_t * C_t * alpha_t));
+    double t0 = D_t * FastCos(C_t * MF_atan(B_t, E_t, alpha_t)) * cpa;
+    double M_z0 = -t0 * F_y0 + D_r * cos_atan(B_r * alpha_r);
+
+    // Combined slip longitudinal force
+    double alpha_S = a + S_HxAlpha;
+    double B_xAlpha = (lon.rbx1 + rbx3 * g2) * cos_atan(lon.rbx2 * k) * sc.lxal;
+    double E_xAlpha = lon.rex1 + lon.rex2 * dfz;
+    double G_xAlpha0 = FastCos(C_xAlpha * MF_atan(B_xAlpha, E_xAlpha, S_HxAlpha));
+    double G_xAlpha = FastCos(C_xAlpha * MF_atan(B_xAlpha, E_xAlpha, alpha_S)) / G_xAlpha0;
+    double F_x = G_xAlpha * F_x0;
+
+    // Combined slip lateral force
+    double S_HyKappa = lat.rhy1 + lat.rhy2 * dfz;
+    double kappa_S = k + S_HyKappa;
+    double B_yKappa = lat.rby1 * cos_atan(lat.rby2 * (a - lat.rby3)) * sc.lyka;
+    double E_yKappa = lat.rey1 + lat.rey2 * dfz;
+    double D_VyKappa = mu_y * fz * (lat.rvy1 + lat.rvy2 * dfz + lat.rvy3 * g) * cos_atan(lat.rvy4 * a);
+    double S_VyKappa = D_VyKappa * FastSin(lat.rvy5 * FastAtan(lat.rvy6 * k)) * sc.lvyka;
+    double G_yKappa0 = FastCos(C_yKappa * MF_atan(B_yKappa, E_yKappa, S_HyKappa));
+    double G_yKappa = FastCos(C_yKappa * MF_atan(B_yKappa, E_yKappa, kappa_S)) / G_yKappa0;
+    double F_y = G_yKappa * F_y0 + S_VyKappa;
+
+    // Combined slip aligning moment
+    double s = R0 * (al.ssz1 + al.ssz2 * (F_y / fnomin) + (al.ssz3 + al.ssz4 * dfz) * g) * sc.ls;
+    double K_ratio = K_x / K_y;
+    double kk = K_ratio * k;
+    double sign_alpha_t = (alpha_t >= 0) ? 1.0 : -1.0;
+    double sign_alpha_r = (alpha_r >= 0) ? 1.0 : -1.0;
+    double alpha_t_eq = sign_alpha_t * std::sqrt(alpha_t * alpha_t + kk * kk);
+    double alpha_r_eq = sign_alpha_r * std::sqrt(alpha_r * alpha_r + kk * kk);
+    double M_zr = D_r * cos_atan(B_r * alpha_r_eq) * cpa;
+    double t = D_t * FastCos(C_t * MF_atan(B_t, E_t, alpha_t_eq)) * cpa;
+    double M_z = -t * (F_y - S_VyKappa) + M_zr + s * F_x;
+
+    // Overturning and rolling resistance moments
+    double M_x = fz * R0 * (m_params.overturning.qsx1 - m_params.overturning.qsx2 * g + m_params.overturning.qsx3 * (F_y / fnomin)) * sc.lmx;
+    double M_y = -fz * R0 * (m_params.rolling.qsy1 * FastAtan(V_r[i] / m_params.model.longvl) + m_params.rolling.qsy2 * (F_x / fnomin)) * sc.lmy;
+
+    Fx0[i] = F_x0;
+    Fy0[i] = F_y0;
+    Mz0[i] = M_z0;
+    Fx[i] = F_x;
+    Fy[i] = F_y;
+    Mx[i] = M_x;
+    My[i] = M_y;
+    Mz[i] = M_z;
+    Dy[i] = D_y;
+    SHf[i] = S_Hf;
+    Kxy[i] = K_ratio;
+  }
+
+  size_t bytes = m * sizeof(double);
+  if (out.Fx)         std::memcpy(out.Fx + offset, Fx, bytes);
+  if (out.Fy)         std::memcpy(out.Fy + offset, Fy, bytes);
+  if (out.Mx)         std::memcpy(out.Mx + offset, Mx, bytes);
+  if (out.My)         std::memcpy(out.My + offset, My, bytes);
+  if (out.Mz)         std::memcpy(out.Mz + offset, Mz, bytes);
+  if (out.Fx_pure)    std::memcpy(out.Fx_pure + offset, Fx0, bytes);
+  if (out.Fy_pure)    std::memcpy(out.Fy_pure + offset, Fy0, bytes);
+  if (out.Mz_pure)    std::memcpy(out.Mz_pure + offset, Mz0, bytes);
+  if (out.D_y)        std::memcpy(out.D_y + offset, Dy, bytes);
+  if (out.S_Hf)       std::memcpy(out.S_Hf + offset, SHf, bytes);
+  if (out.K_xy)       std::memcpy(out.K_xy + offset, Kxy, bytes);
+}
+
+
+}  // end namespace chrono
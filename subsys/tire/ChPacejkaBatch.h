@@ -0,0 +1,102 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Stateless batch evaluator of the Pac2002 steady-state Magic Formula.
+//
+// Evaluates the same equations as ChPacejkaTire::fusedSlipReactions, calc_Mx
+// and calc_My for arrays of (kappa, alpha, gamma, Fz) points. Inputs and
+// outputs are passed as separate contiguous arrays (structure of arrays);
+// points are processed in blocks with straight-line code and the branch-free
+// kernels of ChFastMath.h, so that the compiler can vectorize the inner loops.
+//
+// Assumptions (identical to the scalar path in steady state):
+//  - the inputs are the Magic Formula slips kappaP, alphaP = tan(alpha) and
+//    gammaP = sin(gamma), in the tire side convention of the parameter file
+//    (no m_sameSide flip is applied to the outputs);
+//  - forward rolling (V_cx > 0), so that cos'(alpha) = 1 / sqrt(1 + alphaP^2);
+//  - no spin slip (all zeta factors equal to 1);
+//  - the tire is in contact.
+//
+// Tolerance: the results agree with the per-step evaluation in
+// ChPacejkaTire::Advance to within a relative error of 1e-12 (absolute 1e-9 N
+// or N.m for outputs near zero); see tests/pacTest/test_pacBatch.cpp.
+//
+// =============================================================================
+
+#ifndef CH_PACEJKABATCH_H
+#define CH_PACEJKABATCH_H
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+struct Pac2002_data;
+
+///
+/// Stateless batch evaluator for the Pac2002 Magic Formula.
+///
+class CH_SUBSYS_API ChPacejkaBatch
+{
+public:
+
+  /// Input arrays, each of length n.
+  struct Inputs {
+    const double* kappa;   ///< longitudinal slip kappaP
+    const double* alpha;   ///< lateral slip alphaP = tan(alpha)
+    const double* gamma;   ///< camber gammaP = sin(gamma)
+    const double* Fz;      ///< vertical load [N]
+    const double* V_r;     ///< rolling speed omega*R_eff [m/s], used for My (if NULL, LONGVL is used)
+  };
+
+  /// Output arrays, each of length n. Any of these may be NULL.
+  struct Outputs {
+    double* Fx;            ///< combined slip longitudinal force
+    double* Fy;            ///< combined slip lateral force
+    double* Mx;            ///< overturning moment
+    double* My;            ///< rolling resistance moment
+    double* Mz;            ///< combined slip aligning moment
+    double* Fx_pure;       ///< pure slip longitudinal force
+    double* Fy_pure;       ///< pure slip lateral force
+    double* Mz_pure;       ///< pure slip aligning moment
+    double* D_y;           ///< lateral peak factor D_y
+    double* S_Hf;          ///< residual torque slip shift S_Hf = alpha_r - alpha
+    double* K_xy;          ///< stiffness ratio K_x / K_y
+  };
+
+  /// Construct a batch evaluator for the given set of tire parameters.
+  /// The parameters are referenced, not copied.
+  ChPacejkaBatch(const Pac2002_data& params);
+
+  /// Evaluate the Magic Formula at the n specified points.
+  void Evaluate(
+    int            n,     ///< [in] number of points
+    const Inputs&  in,    ///< [in] input arrays
+    const Outputs& out    ///< [out] output arrays
+    ) const;
+
+  /// Number of points processed per block.
+  static const int BLOCK_SIZE = 64;
+
+private:
+
+  void EvaluateBlock(int n, const Inputs& in, const Outputs& out, int offset) const;
+
+  const Pac2002_data& m_params;
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,543 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Readers and writer for the Pac2002 tire parameters.
+//
+// =============================================================================
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "core/ChLog.h"
+
+#include "subsys/tire/ChPacejkaParamFile.h"
+#include "subsys/tire/ChPac2002_data.h"
+#include "subsys/ChThreadSlot.h"
+
+namespace chrono {
+
+
+// Sections of the property file that are read. All others are skipped.
+enum Section {
+  NONE,
+  MODEL,
+  SHAPE,
+  DIMENSION,
+  VERTICAL,
+  LONG_SLIP_RANGE,
+  SLIP_ANGLE_RANGE,
+  INCLINATION_ANGLE_RANGE,
+  VERTICAL_FORCE_RANGE,
+  SCALING,
+  LONGITUDINAL,
+  OVERTURNING,
+  LATERAL,
+  ROLLING,
+  ALIGNING,
+  NUM_SECTIONS
+};
+
+static const char* section_names[NUM_SECTIONS] = {
+  "",
+  "MODEL",
+  "SHAPE",
+  "DIMENSION",
+  "VERTICAL",
+  "LONG_SLIP_RANGE",
+  "SLIP_ANGLE_RANGE",
+  "INCLINATION_ANGLE_RANGE",
+  "VERTICAL_FORCE_RANGE",
+  "SCALING_COEFFICIENTS",
+  "LONGITUDINAL_COEFFICIENTS",
+  "OVERTURNING_COEFFICIENTS",
+  "LATERAL_COEFFICIENTS",
+  "ROLLING_COEFFICIENTS",
+  "ALIGNING_COEFFICIENTS"
+};
+
+// Largest number of values in any section (more values than this are
+// counted, but not stored, and result in an error).
+static const int MAX_VALUES = 64;
+
+static const char binary_magic[8] = { 'C', 'H', 'P', 'A', 'C', 'T', 'I', 'R' };
+static const int byte_order_marker = 0x01020304;
+
+
+// -----------------------------------------------------------------------------
+// Text parsing utilities. These operate on [begin, end) character ranges of
+// the file buffer.
+// -----------------------------------------------------------------------------
+static inline bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* SkipSpace(const char* s, const char* end)
+{
+  while (s < end && IsSpace(*s))
+    s++;
+  return s;
+}
+
+// Match the name of a section header "[NAME]"; s points after the '['.
+static int FindSection(const char* s, const char* end)
+{
+  const char* close = static_cast<const char*>(std::memchr(s, ']', end - s));
+  if (!close)
+    return NONE;
+
+  size_t len = close - s;
+  for (int i = 1; i < NUM_SECTIONS; i++) {
+    if (std::strlen(section_names[i]) == len && std::strncmp(s, section_names[i], len) == 0)
+      return i;
+  }
+
+  return NONE;
+}
+
+// Convert the number starting at s (after any blanks). The token is copied to
+// a local buffer, so that the file buffer need not be null terminated.
+// Return a pointer past the token, or NULL if there is no number.
+static const char* ParseNumber(const char* s, const char* end, double& val)
+{
+  s = SkipSpace(s, end);
+
+  char token[64];
+  size_t len = 0;
+  while (s + len < end && len < sizeof(token) - 1 && !IsSpace(s[len]) && s[len] != '$')
+    len++;
+  if (len == 0)
+    return NULL;
+
+  std::memcpy(token, s, len);
+  token[len] = '\0';
+
+  char* stop;
+  val = std::strtod(token, &stop);
+  if (stop == token)
+    return NULL;
+
+  return s + (stop - token);
+}
+
+// Extract a quoted string value 'text'.
+static bool ParseString(const char* s, const char* end, std::string& val)
+{
+  s = SkipSpace(s, end);
+  if (s == end || *s != '\'')
+    return false;
+
+  const char* close = static_cast<const char*>(std::memchr(s + 1, '\'', end - s - 1));
+  if (!close)
+    return false;
+
+  val.assign(s + 1, close);
+  return true;
+}
+
+// Compare the key of a "KEY = value" entry.
+static bool KeyIs(const char* key, const char* key_end, const char* name)
+{
+  size_t len = std::strlen(name);
+  return (size_t)(key_end - key) == len && std::strncmp(key, name, len) == 0;
+}
+
+// Copy the values read for a coefficient section to the corresponding struct,
+// whose members are all doubles, in file order.
+template <typename T>
+static bool SetSection(T& s, const double* dat, int n, int section)
+{
+  if (n != (int)(sizeof(T) / sizeof(double))) {
+    GetLog() << " error reading " << section_names[section] << " section of pactire input file!!! \n\n";
+    return false;
+  }
+  std::memcpy(&s, dat, sizeof(T));
+  return true;
+}
+
+static bool CloseSection(int section, const double* dat, int n, Pac2002_data& params)
+{
+  switch (section) {
+  case DIMENSION:               return SetSection(params.dimension, dat, n, section);
+  case VERTICAL:                return SetSection(params.vertical, dat, n, section);
+  case LONG_SLIP_RANGE:         return SetSection(params.long_slip_range, dat, n, section);
+  case SLIP_ANGLE_RANGE:        return SetSection(params.slip_angle_range, dat, n, section);
+  case INCLINATION_ANGLE_RANGE: return SetSection(params.inclination_angle_range, dat, n, section);
+  case VERTICAL_FORCE_RANGE:    return SetSection(params.vertical_force_range, dat, n, section);
+  case SCALING:                 return SetSection(params.scaling, dat, n, section);
+  case LONGITUDINAL:            return SetSection(params.longitudinal, dat, n, section);
+  case OVERTURNING:             return SetSection(params.overturning, dat, n, section);
+  case LATERAL:                 return SetSection(params.lateral, dat, n, section);
+  case ROLLING:                 return SetSection(params.rolling, dat, n, section);
+  case ALIGNING:                return SetSection(params.aligning, dat, n, section);
+  default:                      return true;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Single pass over the lines of the file. A section starts at its "[NAME]"
+// header and ends at the next "$" separator line (or the next header).
+// -----------------------------------------------------------------------------
+bool ChPacejkaParamFile::ParseText(const char* text, size_t length, Pac2002_data& params)
+{
+  double dat[MAX_VALUES];
+  int n = 0;
+  int section = NONE;
+  bool found[NUM_SECTIONS] = { false };
+  bool ok = true;
+
+  params.shape.radial.clear();
+  params.shape.width.clear();
+
+  const char* p = text;
+  const char* end = text + length;
+
+  while (p < end) {
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (!eol)
+      eol = end;
+    const char* s = SkipSpace(p, eol);
+    p = eol + 1;
+
+    if (s == eol)
+      continue;
+
+    // Section header or separator: close the current section
+    if (*s == '[' || *s == '$') {
+      ok = CloseSection(section, dat, n, params) && ok;
+      section = (*s == '[') ? FindSection(s + 1, eol) : NONE;
+      found[section] = true;
+      n = 0;
+      continue;
+    }
+
+    // Comment or table header
+    if (section == NONE || *s == '!' || *s == '{')
+      continue;
+
+    // SHAPE table rows: radial width
+    if (section == SHAPE) {
+      double radial, width;
+      const char* next = ParseNumber(s, eol, radial);
+      if (next && ParseNumber(next, eol, width)) {
+        params.shape.radial.push_back(radial);
+        params.shape.width.push_back(width);
+      }
+      continue;
+    }
+
+    // KEY = value entries
+    const char* eq = static_cast<const char*>(std::memchr(s, '=', eol - s));
+    if (!eq)
+      continue;
+    const char* key_end = eq;
+    while (key_end > s && IsSpace(key_end[-1]))
+      key_end--;
+
+    if (section == MODEL) {
+      // token value type changes in this section
+      double val;
+      if (KeyIs(s, key_end, "PROPERTY_FILE_FORMAT"))
+        ok = ParseString(eq + 1, eol, params.model.property_file_format) && ok;
+      else if (KeyIs(s, key_end, "TYRESIDE"))
+        ok = ParseString(eq + 1, eol, params.model.tyreside) && ok;
+      else if (KeyIs(s, key_end, "USE_MODE") && ParseNumber(eq + 1, eol, val))
+        params.model.use_mode = (int)val;
+      else if (KeyIs(s, key_end, "VXLOW") && ParseNumber(eq + 1, eol, val))
+        params.model.vxlow = val;
+      else if (KeyIs(s, key_end, "LONGVL") && ParseNumber(eq + 1, eol, val))
+        params.model.longvl = val;
+      continue;
+    }
+
+    double val = 0;
+    if (!ParseNumber(eq + 1, eol, val)) {
+      GetLog() << " error reading " << section_names[section] << " section of pactire input file!!! \n\n";
+      ok = false;
+    }
+    if (n < MAX_VALUES)
+      dat[n] = val;
+    n++;
+  }
+
+  ok = CloseSection(section, dat, n, params) && ok;
+
+  for (int i = 1; i < NUM_SECTIONS; i++) {
+    if (!found[i]) {
+      GetLog() << " missing " << section_names[i] << " section in pactire input file!!! \n\n";
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+
+// -----------------------------------------------------------------------------
+// Binary format utilities.
+// -----------------------------------------------------------------------------
+static void Append(std::vector<char>& buf, const void* data, size_t size)
+{
+  const char* c = static_cast<const char*>(data);
+  buf.insert(buf.end(), c, c + size);
+}
+
+static void AppendInt(std::vector<char>& buf, int val)
+{
+  Append(buf, &val, sizeof(int));
+}
+
+static void AppendString(std::vector<char>& buf, const std::string& val)
+{
+  AppendInt(buf, (int)val.size());
+  Append(buf, val.data(), val.size());
+}
+
+template <typename T>
+static void AppendSection(std::vector<char>& buf, const T& s)
+{
+  AppendInt(buf, (int)(sizeof(T) / sizeof(double)));
+  Append(buf, &s, sizeof(T));
+}
+
+// Sequential reader over the binary buffer, with bounds checks.
+class BinaryReader {
+public:
+  BinaryReader(const char* data, size_t length) : m_p(data), m_end(data + length) {}
+
+  bool Read(void* data, size_t size) {
+    if ((size_t)(m_end - m_p) < size)
+      return false;
+    std::memcpy(data, m_p, size);
+    m_p += size;
+    return true;
+  }
+
+  bool ReadInt(int& val) { return Read(&val, sizeof(int)); }
+
+  bool ReadString(std::string& val) {
+    int len;
+    if (!ReadInt(len) || len < 0 || m_end - m_p < len)
+      return false;
+    val.assign(m_p, m_p + len);
+    m_p += len;
+    return true;
+  }
+
+  bool ReadDoubles(std::vector<double>& val, int n) {
+    val.resize(n);
+    return n == 0 || Read(&val[0], n * sizeof(double));
+  }
+
+  template <typename T>
+  bool ReadSection(T& s) {
+    int n;
+    return ReadInt(n) && n == (int)(sizeof(T) / sizeof(double)) && Read(&s, sizeof(T));
+  }
+
+  bool AtEnd() const { return m_p == m_end; }
+
+private:
+  const char* m_p;
+  const char* m_end;
+};
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChPacejkaParamFile::IsBinary(const char* data, size_t length)
+{
+  return length >= sizeof(binary_magic) && std::memcmp(data, binary_magic, sizeof(binary_magic)) == 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChPacejkaParamFile::WriteBinary(const std::string& filename, const Pac2002_data& params)
+{
+  std::vector<char> buf;
+
+  Append(buf, binary_magic, sizeof(binary_magic));
+  AppendInt(buf, BINARY_VERSION);
+  AppendInt(buf, byte_order_marker);
+  AppendInt(buf, (int)sizeof(double));
+
+  AppendString(buf, params.model.property_file_format);
+  AppendString(buf, params.model.tyreside);
+  AppendInt(buf, params.model.use_mode);
+  Append(buf, &params.model.vxlow, sizeof(double));
+  Append(buf, &params.model.longvl, sizeof(double));
+
+  int num_shape = (int)params.shape.radial.size();
+  AppendInt(buf, num_shape);
+  if (num_shape > 0) {
+    Append(buf, &params.shape.radial[0], num_shape * sizeof(double));
+    Append(buf, &params.shape.width[0], num_shape * sizeof(double));
+  }
+
+  AppendSection(buf, params.dimension);
+  AppendSection(buf, params.vertical);
+  AppendSection(buf, params.long_slip_range);
+  AppendSection(buf, params.slip_angle_range);
+  AppendSection(buf, params.inclination_angle_range);
+  AppendSection(buf, params.vertical_force_range);
+  AppendSection(buf, params.scaling);
+  AppendSection(buf, params.longitudinal);
+  AppendSection(buf, params.overturning);
+  AppendSection(buf, params.lateral);
+  AppendSection(buf, params.rolling);
+  AppendSection(buf, params.aligning);
+
+  std::ofstream outFile(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!outFile.is_open()) {
+    GetLog() << " couldn't open " << filename.c_str() << " for writing \n";
+    return false;
+  }
+  outFile.write(&buf[0], buf.size());
+
+  return outFile.good();
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+bool ChPacejkaParamFile::ParseBinary(const char* data, size_t length, Pac2002_data& params)
+{
+  if (!IsBinary(data, length))
+    return false;
+
+  BinaryReader reader(data + sizeof(binary_magic), length - sizeof(binary_magic));
+
+  int version, marker, double_size;
+  if (!reader.ReadInt(version) || !reader.ReadInt(marker) || !reader.ReadInt(double_size))
+    return false;
+  if (version != BINARY_VERSION || marker != byte_order_marker || double_size != (int)sizeof(double)) {
+    GetLog() << " incompatible binary pactire file (version " << version << ") \n";
+    return false;
+  }
+
+  int num_shape;
+  bool ok = reader.ReadString(params.model.property_file_format) &&
+            reader.ReadString(params.model.tyreside) &&
+            reader.ReadInt(params.model.use_mode) &&
+            reader.Read(&params.model.vxlow, sizeof(double)) &&
+            reader.Read(&params.model.longvl, sizeof(double)) &&
+            reader.ReadInt(num_shape) && num_shape >= 0 &&
+            reader.ReadDoubles(params.shape.radial, num_shape) &&
+            reader.ReadDoubles(params.shape.width, num_shape) &&
+            reader.ReadSection(params.dimension) &&
+            reader.ReadSection(params.vertical) &&
+            reader.ReadSection(params.long_slip_range) &&
+            reader.ReadSection(params.slip_angle_range) &&
+            reader.ReadSection(params.inclination_angle_range) &&
+            reader.ReadSection(params.vertical_force_range) &&
+            reader.ReadSection(params.scaling) &&
+            reader.ReadSection(params.longitudinal) &&
+            reader.ReadSection(params.overturning) &&
+            reader.ReadSection(params.lateral) &&
+            reader.ReadSection(params.rolling) &&
+            reader.ReadSection(params.aligning) &&
+            reader.AtEnd();
+
+  if (!ok)
+    GetLog() << " corrupt or incompatible binary pactire file \n";
+
+  return ok;
+}
+
+
+// -----------------------------------------------------------------------------
+// Load the whole file with a single read, then parse it in memory.
+// -----------------------------------------------------------------------------
+bool ChPacejkaParamFile::Read(const std::string& filename, Pac2002_data& params)
+{
+  std::ifstream inFile(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!inFile.is_open())
+    return false;
+
+  inFile.seekg(0, std::ios::end);
+  std::streamoff length = inFile.tellg();
+  inFile.seekg(0, std::ios::beg);
+  if (length <= 0)
+    return false;
+
+  std::vector<char> buf((size_t)length);
+  if (!inFile.read(&buf[0], length))
+    return false;
+
+  if (IsBinary(&buf[0], buf.size()))
+    return ParseBinary(&buf[0], buf.size(), params);
+
+  return ParseText(&buf[0], buf.size(), params);
+}
+
+
+// -----------------------------------------------------------------------------
+// Parsed parameters are cached per file name. Concurrent requests for a file
+// not yet in the cache may parse it more than once, but only the first result
+// is kept.
+// -----------------------------------------------------------------------------
+typedef std::map<std::string, Pac2002_data> ParamCache;
+
+static ParamCache& GetParamCache()
+{
+  static ParamCache cache;
+  return cache;
+}
+
+static ChSpinLock& GetParamCacheLock()
+{
+  static ChSpinLock lock;
+  return lock;
+}
+
+bool ChPacejkaParamFile::ReadCached(const std::string& filename, Pac2002_data& params)
+{
+  ParamCache& cache = GetParamCache();
+  ChSpinLock& lock = GetParamCacheLock();
+
+  lock.Lock();
+  ParamCache::iterator it = cache.find(filename);
+  bool found = (it != cache.end());
+  if (found)
+    params = it->second;
+  lock.Unlock();
+
+  if (found)
+    return true;
+
+  if (!Read(filename, params))
+    return false;
+
+  lock.Lock();
+  cache.insert(ParamCache::value_type(filename, params));
+  lock.Unlock();
+
+  return true;
+}
+
+void ChPacejkaParamFile::ClearCache()
+{
+  ChSpinLock& lock = GetParamCacheLock();
+  lock.Lock();
+  GetParamCache().clear();
+  lock.Unlock();
+}
+
+
+}  // end namespace chrono
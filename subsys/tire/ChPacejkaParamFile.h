@@ -0,0 +1,109 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Readers and writer for the Pac2002 tire parameters.
+//
+// Text property files (.tir) are parsed in a single pass over an in-memory
+// copy of the file, without any per-line allocations: each line is classified
+// by its first character (section header, comment, or KEY = value entry) and
+// numeric values are converted in place. Within a section, values are stored
+// in the order in which they appear in the file, which must match the order of
+// the members of the corresponding struct in ChPac2002_data.h.
+//
+// The binary format is a compact image of the parsed parameters:
+//
+//   header   "CHPACTIR", format version, byte order marker, sizeof(double)
+//   MODEL    property file format and tire side strings, use mode, VXLOW, LONGVL
+//   SHAPE    number of rows, radial and width columns
+//   sections for each coefficient struct (DIMENSION, VERTICAL, the four
+//            RANGES, SCALING, LONGITUDINAL, OVERTURNING, LATERAL, ROLLING,
+//            ALIGNING): number of values, followed by the values
+//
+// All integers are 32 bit and all values are stored in the byte order of the
+// machine that wrote the file; a file written with a different byte order,
+// format version, or struct layout is rejected.
+//
+// =============================================================================
+
+#ifndef CH_PACEJKAPARAMFILE_H
+#define CH_PACEJKAPARAMFILE_H
+
+#include <string>
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+struct Pac2002_data;
+
+///
+/// Reading and writing of Pac2002 tire parameter files.
+///
+class CH_SUBSYS_API ChPacejkaParamFile
+{
+public:
+
+  /// Version of the binary format written by WriteBinary().
+  static const int BINARY_VERSION = 1;
+
+  /// Load the tire parameters from the specified file, which can be either a
+  /// text property file or a binary file created with WriteBinary().
+  /// Return false if the file cannot be read or is not valid.
+  static bool Read(
+    const std::string& filename,   ///< [in] name of the .tir or binary file
+    Pac2002_data&      params      ///< [out] tire parameters
+    );
+
+  /// Same as Read(), but the parameters are parsed only the first time a given
+  /// file is requested and later requests return a copy of the cached values.
+  /// Tires constructed from the same file thus share a single parse.
+  static bool ReadCached(
+    const std::string& filename,   ///< [in] name of the .tir or binary file
+    Pac2002_data&      params      ///< [out] tire parameters
+    );
+
+  /// Release all cached parameters (e.g., after a parameter file was modified).
+  static void ClearCache();
+
+  /// Parse a text property file already loaded in memory.
+  /// Return false if a required section is missing or incomplete.
+  static bool ParseText(
+    const char*   text,     ///< [in] file contents (need not be null terminated)
+    size_t        length,   ///< [in] number of characters
+    Pac2002_data& params    ///< [out] tire parameters
+    );
+
+  /// Write the tire parameters to the specified file in binary format.
+  static bool WriteBinary(
+    const std::string&  filename,   ///< [in] name of the output file
+    const Pac2002_data& params      ///< [in] tire parameters
+    );
+
+  /// Decode tire parameters in binary format, already loaded in memory.
+  /// Return false if the data is not a valid binary parameter file.
+  static bool ParseBinary(
+    const char*   data,     ///< [in] file contents
+    size_t        length,   ///< [in] number of bytes
+    Pac2002_data& params    ///< [out] tire parameters
+    );
+
+  /// Return true if the data starts with the binary format header.
+  static bool IsBinary(const char* data, size_t length);
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -0,0 +1,406 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Precomputed lookup table of the Pac2002 steady-state Magic Formula.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/ChLog.h"
+
+#include "subsys/tire/ChPacejkaTable.h"
+#include "subsys/tire/ChPacejkaBatch.h"
+#include "subsys/tire/ChPac2002_data.h"
+#include "subsys/tire/ChFastMath.h"
+
+namespace chrono {
+
+
+// Slip angles are limited to this value, so that tan(alpha) stays finite
+static const double max_slip_angle = 1.5698;
+
+static const char* channel_names[ChPacejkaTable::NUM_CHANNELS] = {
+  "Fx", "Fy", "Mz", "Fx_pure", "Fy_pure", "Mz_pure", "D_y", "S_Hf", "K_xy"
+};
+
+
+// -----------------------------------------------------------------------------
+// Table axes
+// -----------------------------------------------------------------------------
+void ChPacejkaTable::Axis::Set(int num, double x_min, double x_max, double c)
+{
+  n = num;
+  scale = c;
+  u_min = (c > 0) ? std::atan(x_min / c) : x_min;
+  double u_max = (c > 0) ? std::atan(x_max / c) : x_max;
+  du = (u_max - u_min) / (n - 1);
+}
+
+double ChPacejkaTable::Axis::Coordinate(double x) const
+{
+  return (scale > 0) ? FastAtan(x / scale) : x;
+}
+
+double ChPacejkaTable::Axis::Node(int i) const
+{
+  double u = u_min + i * du;
+  return (scale > 0) ? scale * std::tan(u) : u;
+}
+
+// Return the index of the cell containing x and the local coordinate t in
+// [0,1] within that cell. Values outside the axis range are clamped.
+int ChPacejkaTable::Axis::Locate(double x, double& t) const
+{
+  double s = (Coordinate(x) - u_min) / du;
+  if (s < 0)
+    s = 0;
+  if (s > n - 1)
+    s = n - 1;
+
+  int i = (int)s;
+  if (i > n - 2)
+    i = n - 2;
+  t = s - i;
+
+  return i;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+ChPacejkaTable::ChPacejkaTable()
+{
+}
+
+
+// -----------------------------------------------------------------------------
+// Build the table, optionally refining the slip axes until the estimated
+// interpolation error in the forces is below the requested tolerance.
+// -----------------------------------------------------------------------------
+bool ChPacejkaTable::Build(const Pac2002_data& params, const Settings& settings)
+{
+  m_settings = settings;
+  m_data.clear();
+
+  if (m_settings.num_kappa < 2 || m_settings.num_alpha < 2 || m_settings.num_gamma < 2 || m_settings.num_Fz < 2) {
+    GetLog() << "ChPacejkaTable: at least 2 nodes are required in each direction\n";
+    return false;
+  }
+
+  if (m_settings.kappa_scale <= 0 || m_settings.alpha_scale <= 0) {
+    GetLog() << "ChPacejkaTable: slip axis scales must be positive\n";
+    return false;
+  }
+
+  while (true) {
+    if (!Fill(params))
+      return false;
+
+    if (m_settings.tolerance <= 0)
+      return true;
+
+    ErrorReport report = EstimateError(params);
+    static const int forces[] = { FX, FY, FX_PURE, FY_PURE };
+    double err = 0;
+    for (int j = 0; j < 4; j++) {
+      int c = forces[j];
+      if (report.peak[c] > 0 && report.max_error[c] / report.peak[c] > err)
+        err = report.max_error[c] / report.peak[c];
+    }
+
+    if (err <= m_settings.tolerance)
+      return true;
+
+    int num_kappa = (3 * m_settings.num_kappa) / 2;
+    int num_alpha = (3 * m_settings.num_alpha) / 2;
+    double num_nodes = (double)num_kappa * num_alpha * m_settings.num_gamma * m_settings.num_Fz;
+    if (num_nodes > m_settings.max_nodes) {
+      GetLog() << "ChPacejkaTable: tolerance not reached with " << m_settings.max_nodes
+               << " nodes (error = " << err << ")\n";
+      return true;
+    }
+
+    m_settings.num_kappa = num_kappa;
+    m_settings.num_alpha = num_alpha;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Set up the axes and evaluate the Magic Formula at all nodes.
+// -----------------------------------------------------------------------------
+bool ChPacejkaTable::Fill(const Pac2002_data& params)
+{
+  m_data.clear();
+
+  double alp_min = std::max(params.slip_angle_range.alpmin, -max_slip_angle);
+  double alp_max = std::min(params.slip_angle_range.alpmax, max_slip_angle);
+  // A non-positive load is not valid in the Magic Formula
+  double Fz_min = std::max(params.vertical_force_range.fzmin, 0.01 * params.vertical.fnomin);
+  double Fz_max = params.vertical_force_range.fzmax;
+
+  if (params.long_slip_range.kpumin >= params.long_slip_range.kpumax ||
+      alp_min >= alp_max ||
+      params.inclination_angle_range.cammin >= params.inclination_angle_range.cammax ||
+      Fz_min >= Fz_max) {
+    GetLog() << "ChPacejkaTable: invalid RANGES in tire parameters\n";
+    return false;
+  }
+
+  m_kappa.Set(m_settings.num_kappa, params.long_slip_range.kpumin, params.long_slip_range.kpumax, m_settings.kappa_scale);
+  m_alpha.Set(m_settings.num_alpha, std::tan(alp_min), std::tan(alp_max), m_settings.alpha_scale);
+  m_gamma.Set(m_settings.num_gamma, std::sin(params.inclination_angle_range.cammin), std::sin(params.inclination_angle_range.cammax), 0);
+  m_Fz.Set(m_settings.num_Fz, Fz_min, Fz_max, 0);
+
+  // Node coordinates, in the table storage order
+  int num_nodes = m_kappa.n * m_alpha.n * m_gamma.n * m_Fz.n;
+  std::vector<double> kappa(num_nodes), alpha(num_nodes), gamma(num_nodes), Fz(num_nodes);
+
+  int node = 0;
+  for (int iF = 0; iF < m_Fz.n; iF++) {
+    for (int ig = 0; ig < m_gamma.n; ig++) {
+      for (int ia = 0; ia < m_alpha.n; ia++) {
+        for (int ik = 0; ik < m_kappa.n; ik++) {
+          kappa[node] = m_kappa.Node(ik);
+          alpha[node] = m_alpha.Node(ia);
+          gamma[node] = m_gamma.Node(ig);
+          Fz[node] = m_Fz.Node(iF);
+          node++;
+        }
+      }
+    }
+  }
+
+  // Evaluate all channels and interleave them per node
+  std::vector<double> values(NUM_CHANNELS * num_nodes);
+  double* v = &values[0];
+
+  ChPacejkaBatch::Inputs in = { &kappa[0], &alpha[0], &gamma[0], &Fz[0], NULL };
+  ChPacejkaBatch::Outputs out = { 0 };
+  out.Fx = v + FX * num_nodes;
+  out.Fy = v + FY * num_nodes;
+  out.Mz = v + MZ * num_nodes;
+  out.Fx_pure = v + FX_PURE * num_nodes;
+  out.Fy_pure = v + FY_PURE * num_nodes;
+  out.Mz_pure = v + MZ_PURE * num_nodes;
+  out.D_y = v + D_Y * num_nodes;
+  out.S_Hf = v + S_HF * num_nodes;
+  out.K_xy = v + K_XY * num_nodes;
+
+  ChPacejkaBatch batch(params);
+  batch.Evaluate(num_nodes, in, out);
+
+  m_data.resize(NUM_CHANNELS * num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+      double val = values[c * num_nodes + i];
+      if (val != val) {
+        GetLog() << "ChPacejkaTable: Magic Formula undefined at kappa = " << kappa[i] << ", alpha = " << alpha[i]
+                 << ", gamma = " << gamma[i] << ", Fz = " << Fz[i] << "\n";
+        m_data.clear();
+        return false;
+      }
+      m_data[i * NUM_CHANNELS + c] = val;
+    }
+  }
+
+  return true;
+}
+
+
+size_t ChPacejkaTable::Index(int ik, int ia, int ig, int iF) const
+{
+  return NUM_CHANNELS * (((size_t)(iF * m_gamma.n + ig) * m_alpha.n + ia) * m_kappa.n + ik);
+}
+
+
+// -----------------------------------------------------------------------------
+// Interpolation. The stencil along each axis is either the 2 nodes of the
+// cell (linear weights) or the 4 nodes around it (Catmull-Rom weights, with
+// the indices clamped at the ends of the axis).
+// -----------------------------------------------------------------------------
+static int LinearStencil(int i, double t, int* idx, double* w)
+{
+  idx[0] = i;
+  idx[1] = i + 1;
+  w[0] = 1 - t;
+  w[1] = t;
+  return 2;
+}
+
+static int CubicStencil(int i, double t, int n, int* idx, double* w)
+{
+  idx[0] = (i > 0) ? i - 1 : 0;
+  idx[1] = i;
+  idx[2] = i + 1;
+  idx[3] = (i + 2 < n) ? i + 2 : n - 1;
+
+  double t2 = t * t;
+  double t3 = t2 * t;
+  w[0] = -0.5 * t3 + t2 - 0.5 * t;
+  w[1] = 1.5 * t3 - 2.5 * t2 + 1;
+  w[2] = -1.5 * t3 + 2 * t2 + 0.5 * t;
+  w[3] = 0.5 * t3 - 0.5 * t2;
+  return 4;
+}
+
+void ChPacejkaTable::Evaluate(double kappa, double alpha, double gamma, double Fz, double* values) const
+{
+  double acc[NUM_CHANNELS];
+  for (int c = 0; c < NUM_CHANNELS; c++)
+    acc[c] = 0;
+
+  if (!m_data.empty()) {
+    double tk, ta, tg, tF;
+    int i_k = m_kappa.Locate(kappa, tk);
+    int i_a = m_alpha.Locate(alpha, ta);
+    int i_g = m_gamma.Locate(gamma, tg);
+    int i_F = m_Fz.Locate(Fz, tF);
+
+    int ik[4], ia[4], ig[2], iF[2];
+    double wk[4], wa[4], wg[2], wF[2];
+    int nk, na;
+
+    if (m_settings.cubic) {
+      nk = CubicStencil(i_k, tk, m_kappa.n, ik, wk);
+      na = CubicStencil(i_a, ta, m_alpha.n, ia, wa);
+    } else {
+      nk = LinearStencil(i_k, tk, ik, wk);
+      na = LinearStencil(i_a, ta, ia, wa);
+    }
+    LinearStencil(i_g, tg, ig, wg);
+    LinearStencil(i_F, tF, iF, wF);
+
+    // Accumulate in a local array (the output cannot alias the table data)
+    const double* data = &m_data[0];
+    for (int f = 0; f < 2; f++) {
+      for (int g = 0; g < 2; g++) {
+        double wfg = wF[f] * wg[g];
+        for (int a = 0; a < na; a++) {
+          double wfga = wfg * wa[a];
+          const double* row = data + Index(0, ia[a], ig[g], iF[f]);
+          for (int k = 0; k < nk; k++) {
+            double w = wfga * wk[k];
+            const double* v = row + NUM_CHANNELS * ik[k];
+            for (int c = 0; c < NUM_CHANNELS; c++)
+              acc[c] += w * v[c];
+          }
+        }
+      }
+    }
+  }
+
+  for (int c = 0; c < NUM_CHANNELS; c++)
+    values[c] = acc[c];
+}
+
+
+// -----------------------------------------------------------------------------
+// Error estimation. Sample points are taken from an additive recurrence
+// sequence (quasi-random, uniform in the table coordinates).
+// -----------------------------------------------------------------------------
+void ChPacejkaTable::Sample(int k, double& kappa, double& alpha, double& gamma, double& Fz) const
+{
+  // Inverse powers of the generalized golden ratio in 4 dimensions
+  static const double a[4] = { 0.8566748838545029, 0.7338918566271260, 0.6287067210378087, 0.5385972572236101 };
+  double s[4];
+  for (int d = 0; d < 4; d++) {
+    double x = 0.5 + a[d] * (k + 1);
+    s[d] = x - std::floor(x);
+  }
+
+  double u;
+  u = m_kappa.u_min + s[0] * (m_kappa.n - 1) * m_kappa.du;
+  kappa = m_kappa.scale * std::tan(u);
+  u = m_alpha.u_min + s[1] * (m_alpha.n - 1) * m_alpha.du;
+  alpha = m_alpha.scale * std::tan(u);
+  gamma = m_gamma.u_min + s[2] * (m_gamma.n - 1) * m_gamma.du;
+  Fz = m_Fz.u_min + s[3] * (m_Fz.n - 1) * m_Fz.du;
+}
+
+ChPacejkaTable::ErrorReport ChPacejkaTable::EstimateError(const Pac2002_data& params, int num_samples) const
+{
+  ErrorReport report;
+  report.num_samples = 0;
+  for (int c = 0; c < NUM_CHANNELS; c++) {
+    report.max_error[c] = 0;
+    report.rms_error[c] = 0;
+    report.peak[c] = 0;
+  }
+
+  if (m_data.empty() || num_samples <= 0)
+    return report;
+
+  for (size_t i = 0; i < m_data.size(); i++) {
+    int c = (int)(i % NUM_CHANNELS);
+    if (std::abs(m_data[i]) > report.peak[c])
+      report.peak[c] = std::abs(m_data[i]);
+  }
+
+  // Exact values at the sample points
+  std::vector<double> kappa(num_samples), alpha(num_samples), gamma(num_samples), Fz(num_samples);
+  for (int i = 0; i < num_samples; i++)
+    Sample(i, kappa[i], alpha[i], gamma[i], Fz[i]);
+
+  std::vector<double> exact(NUM_CHANNELS * num_samples);
+  double* v = &exact[0];
+
+  ChPacejkaBatch::Inputs in = { &kappa[0], &alpha[0], &gamma[0], &Fz[0], NULL };
+  ChPacejkaBatch::Outputs out = { 0 };
+  out.Fx = v + FX * num_samples;
+  out.Fy = v + FY * num_samples;
+  out.Mz = v + MZ * num_samples;
+  out.Fx_pure = v + FX_PURE * num_samples;
+  out.Fy_pure = v + FY_PURE * num_samples;
+  out.Mz_pure = v + MZ_PURE * num_samples;
+  out.D_y = v + D_Y * num_samples;
+  out.S_Hf = v + S_HF * num_samples;
+  out.K_xy = v + K_XY * num_samples;
+
+  ChPacejkaBatch batch(params);
+  batch.Evaluate(num_samples, in, out);
+
+  // Compare with the interpolated values
+  double values[NUM_CHANNELS];
+  for (int i = 0; i < num_samples; i++) {
+    Evaluate(kappa[i], alpha[i], gamma[i], Fz[i], values);
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+      double err = std::abs(values[c] - exact[c * num_samples + i]);
+      if (err > report.max_error[c])
+        report.max_error[c] = err;
+      report.rms_error[c] += err * err;
+    }
+  }
+
+  for (int c = 0; c < NUM_CHANNELS; c++)
+    report.rms_error[c] = std::sqrt(report.rms_error[c] / num_samples);
+  report.num_samples = num_samples;
+
+  return report;
+}
+
+void ChPacejkaTable::LogError(const ErrorReport& report)
+{
+  GetLog() << "\n---- Pacejka lookup table error (" << report.num_samples << " samples)\n";
+  GetLog() << "  channel        max error     RMS error     peak value\n";
+  for (int c = 0; c < NUM_CHANNELS; c++) {
+    GetLog() << "  " << channel_names[c] << "\t" << report.max_error[c] << "\t"
+             << report.rms_error[c] << "\t" << report.peak[c] << "\n";
+  }
+}
+
+
+} // end namespace chrono
@@ -0,0 +1,163 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Precomputed lookup table of the Pac2002 steady-state Magic Formula.
+//
+// The pure and combined slip reactions are tabulated over a 4D grid of
+// kappa x tan(alpha) x gamma x Fz, covering the ranges of the RANGES section
+// of the tire parameter file, and are then evaluated by interpolation.
+//
+// The kappa and tan(alpha) axes are not uniform: the nodes are uniformly
+// spaced in u = atan(x / c), which concentrates them in the small slip region
+// where the forces vary rapidly, while still covering arbitrarily large slips
+// (slip angles are limited to 89.9 degrees). The gamma (as gammaP = sin(gamma))
+// and Fz axes are uniform. Interpolation is either multilinear, or cubic
+// (Catmull-Rom) in the two slip directions and linear in gamma and Fz. Inputs
+// outside the table range are clamped to the range.
+//
+// The table is filled with ChPacejkaBatch and therefore uses the same
+// steady-state assumptions (see ChPacejkaBatch.h).
+//
+// =============================================================================
+
+#ifndef CH_PACEJKATABLE_H
+#define CH_PACEJKATABLE_H
+
+#include <vector>
+
+#include "core/ChShared.h"
+
+#include "subsys/ChApiSubsys.h"
+
+namespace chrono {
+
+struct Pac2002_data;
+
+///
+/// Lookup table for the Pac2002 steady-state Magic Formula.
+///
+class CH_SUBSYS_API ChPacejkaTable : public ChShared
+{
+public:
+
+  /// Tabulated quantities.
+  enum Channel {
+    FX,           ///< combined slip longitudinal force
+    FY,           ///< combined slip lateral force
+    MZ,           ///< combined slip aligning moment
+    FX_PURE,      ///< pure slip longitudinal force
+    FY_PURE,      ///< pure slip lateral force
+    MZ_PURE,      ///< pure slip aligning moment
+    D_Y,          ///< lateral peak factor
+    S_HF,         ///< residual torque slip shift
+    K_XY,         ///< stiffness ratio K_x / K_y
+    NUM_CHANNELS
+  };
+
+  /// Table size and accuracy settings.
+  struct Settings {
+    Settings()
+      : num_kappa(41), num_alpha(41), num_gamma(5), num_Fz(9),
+        kappa_scale(0.2), alpha_scale(0.3),
+        cubic(true), tolerance(0), max_nodes(1000000) {}
+
+    int    num_kappa;    ///< number of nodes in kappa
+    int    num_alpha;    ///< number of nodes in tan(alpha)
+    int    num_gamma;    ///< number of nodes in gamma
+    int    num_Fz;       ///< number of nodes in Fz
+    double kappa_scale;  ///< node clustering scale c for kappa (smaller values cluster more nodes near 0)
+    double alpha_scale;  ///< node clustering scale c for tan(alpha)
+    bool   cubic;        ///< cubic interpolation in kappa and alpha (otherwise multilinear)
+    double tolerance;    ///< if positive, refine the slip axes until the estimated force error is below this fraction of the peak force
+    int    max_nodes;    ///< upper limit on the number of nodes when refining
+  };
+
+  /// Interpolation error with respect to the exact formula, for each channel.
+  struct ErrorReport {
+    int    num_samples;                ///< number of sample points
+    double max_error[NUM_CHANNELS];    ///< maximum absolute error
+    double rms_error[NUM_CHANNELS];    ///< RMS error
+    double peak[NUM_CHANNELS];         ///< maximum absolute tabulated value
+  };
+
+  ChPacejkaTable();
+
+  /// Build the table for the specified tire parameters.
+  /// Return false if the settings or the parameter ranges are invalid.
+  bool Build(
+    const Pac2002_data& params,    ///< [in] tire parameters
+    const Settings&     settings   ///< [in] table size and accuracy settings
+    );
+
+  /// Return true if the table was successfully built.
+  bool IsBuilt() const { return !m_data.empty(); }
+
+  /// Interpolate all channels at the specified point.
+  void Evaluate(
+    double  kappa,    ///< [in] longitudinal slip kappaP
+    double  alpha,    ///< [in] lateral slip alphaP = tan(alpha)
+    double  gamma,    ///< [in] camber gammaP = sin(gamma)
+    double  Fz,       ///< [in] vertical load
+    double* values    ///< [out] interpolated values, NUM_CHANNELS entries
+    ) const;
+
+  /// Estimate the interpolation error against the exact formula, using the
+  /// specified number of pseudo-random points sampled uniformly in the table
+  /// coordinates.
+  ErrorReport EstimateError(
+    const Pac2002_data& params,            ///< [in] tire parameters used to build the table
+    int                 num_samples = 10000 ///< [in] number of sample points
+    ) const;
+
+  /// Print the specified error report.
+  static void LogError(const ErrorReport& report);
+
+  /// Return the settings actually used (after any refinement).
+  const Settings& GetSettings() const { return m_settings; }
+
+  /// Return the memory used by the table, in bytes.
+  size_t GetMemorySize() const { return m_data.size() * sizeof(double); }
+
+private:
+
+  // Uniform axis in the (possibly warped) coordinate u
+  struct Axis {
+    int    n;
+    double scale;    // c for a warped axis, 0 for a uniform axis
+    double u_min;
+    double du;
+
+    void   Set(int num, double x_min, double x_max, double c);
+    double Coordinate(double x) const;
+    double Node(int i) const;
+    int    Locate(double x, double& t) const;
+  };
+
+  bool Fill(const Pac2002_data& params);
+  void Sample(int k, double& kappa, double& alpha, double& gamma, double& Fz) const;
+  size_t Index(int ik, int ia, int ig, int iF) const;
+
+  Settings            m_settings;
+  Axis                m_kappa;
+  Axis                m_alpha;
+  Axis                m_gamma;
+  Axis                m_Fz;
+  std::vector<double> m_data;    ///< NUM_CHANNELS values per node, kappa fastest
+};
+
+
+} // end namespace chrono
+
+
+#endif
@@ -18,11 +18,18 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <map>
 
 #include "core/ChTimer.h"
 
 #include "subsys/tire/ChPacejkaTire.h"
 #include "subsys/tire/ChPac2002_data.h"
+#include "subsys/tire/ChPacejkaParamFile.h"
+#include "subsys/ChPerfCounters.h"
+#include "subsys/ChTelemetryWriter.h"
+#include "subsys/ChThreadSlot.h"
 
 namespace chrono {
 
@@ -48,6 +55,25 @@ static double gammaP_thresh = 0.05;
 static double phiP_thresh = 99;
 static double phiT_thresh = 99;
 
+// Inner term of the Magic Formula: atan(B*x - E*(B*x - atan(B*x)))
+static inline double MF_atan(double B, double E, double x)
+{
+  double Bx = B * x;
+  return std::atan(Bx - E * (Bx - std::atan(Bx)));
+}
+
+// cos(atan(x)), without transcendental calls
+static inline double cos_atan(double x)
+{
+  return 1.0 / std::sqrt(1.0 + x * x);
+}
+
+// cos(C*atan(x))
+static inline double cos_C_atan(double C, double x)
+{
+  return (C == 1.0) ? cos_atan(x) : std::cos(C * std::atan(x));
+}
+
 // -----------------------------------------------------------------------------
 // Constructors
 // -----------------------------------------------------------------------------
@@ -56,10 +82,16 @@ ChPacejkaTire::ChPacejkaTire(const std::string& name,
                              const ChTerrain&   terrain)
 : ChTire(name, terrain),
   m_paramFile(pacTire_paramFile),
+  m_out_writer(NULL),
+  m_out_stream(-1),
   m_params_defined(false),
   m_use_transient_slip(true),
   m_use_Fz_override(false),
-  m_step_size(default_step_size)
+  m_step_size(default_step_size),
+  m_combined_only(false),
+  m_coef_Fz_tol(0),
+  m_coef_gamma_tol(0),
+  m_use_table(false)
 {
 
 }
@@ -72,11 +104,17 @@ ChPacejkaTire::ChPacejkaTire(const std::string& name,
                              bool               use_transient_slip)
 : ChTire(name, terrain),
   m_paramFile(pacTire_paramFile),
+  m_out_writer(NULL),
+  m_out_stream(-1),
   m_params_defined(false),
   m_use_transient_slip(use_transient_slip),
   m_use_Fz_override(Fz_override > 0),
   m_Fz_override(Fz_override),
-  m_step_size(default_step_size)
+  m_step_size(default_step_size),
+  m_combined_only(false),
+  m_coef_Fz_tol(0),
+  m_coef_gamma_tol(0),
+  m_use_table(false)
 {
 
 }
@@ -100,6 +138,7 @@ ChPacejkaTire::~ChPacejkaTire()
   delete m_zeta;
   delete m_relaxation;
   delete m_bessel;
+  delete m_loadCoefs;
 }
 
 
@@ -126,6 +165,9 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
   m_zeta = new zetaCoefs;
   m_relaxation = new relaxationL;
   m_bessel = new bessel;
+  m_loadCoefs = new loadCoefs;
+  m_loadCoefs->valid = false;
+  m_loadCoefs->valid_relax = false;
 
   // negative number indicates no steps have been taken yet
   m_time_since_last_step = 0;
@@ -134,6 +176,8 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
   m_sum_ODE_time = 0.0;
   m_num_Advance_calls = 0;
   m_sum_Advance_time = 0.0;
+  m_num_coef_hits = 0;
+  m_num_coef_misses = 0;
 
   // load all the empirical tire parameters from *.tir file
   loadPacTireParamFile();
@@ -178,6 +222,15 @@ void ChPacejkaTire::Initialize(ChVehicleSide side, bool driven)
 
   m_combinedTorque->alpha_r_eq = 0.0;
   m_pureLat->D_y = m_params->vertical.fnomin;  // initial approximation
+
+  // get the Magic Formula lookup table, if requested (shared with all other
+  // tires using the same parameter file and table settings)
+  m_table = ChSharedPtr<ChPacejkaTable>();
+  if (m_use_table) {
+    m_table = GetSharedTable(m_paramFile, *m_params, m_table_settings);
+    if (m_table.IsNull())
+      GetLog() << " couldn't build the Pacejka lookup table, using the Magic Formula equations \n";
+  }
   m_C_Fx =  161000;   // calibrated, sigma_kappa = sigma_kappa_ref = 1.29
   m_C_Fy = 144000;    // calibrated, sigma_alpha = sigma_alpha_ref = 0.725
 
@@ -283,6 +336,8 @@ void ChPacejkaTire::Update(double               time,
 // -----------------------------------------------------------------------------
 void ChPacejkaTire::Advance(double step)
 {
+  CH_PERF_SCOPE("ChPacejkaTire::Advance");
+
   // increment the counter
   ChTimer<double> advance_time;
   m_num_Advance_calls++;
@@ -363,15 +418,21 @@ void ChPacejkaTire::Advance(double step)
     slip_kinematic();
   }
 
-  // Calculate the force and moment reaction, pure slip case
-  pureSlipReactions( );
-
-  // Update m_FM_combined.forces, m_FM_combined.moment.z
-  combinedSlipReactions( );
+  if (!m_table.IsNull() && m_slip->V_cx >= 0) {
+    // Interpolate the pure and combined slip reactions. The table assumes
+    // forward rolling, so the exact equations are used when rolling backwards.
+    tableSlipReactions( );
+  } else {
+    // Calculate the pure and combined slip reactions, m_FM_pure and
+    // m_FM_combined forces and moment.z
+    fusedSlipReactions( );
+  }
 
   // Update M_x, apply to both m_FM and m_FM_combined
   // gamma should already be corrected for L/R side, so need to swap Fy if on opposite side
-  double Mx = m_sameSide * calc_Mx(m_sameSide * m_FM_combined.force.y, m_slip->gammaP);
+  // Note: the arguments were previously passed as (Fy, gamma), which changed
+  // Mx (and the Mx/MX columns of the tire output files) for any Fy != 0.
+  double Mx = m_sameSide * calc_Mx(m_slip->gammaP, m_sameSide * m_FM_combined.force.y);
   m_FM_pure.moment.x = Mx;
   m_FM_combined.moment.x = Mx;
 
@@ -840,19 +901,6 @@ double ChPacejkaTire::ODE_RK_uv(double V_s,
   return delta_x;
 }
 
-double ChPacejkaTire::get_dFy_dtan_alphaP(double x_curr)
-{
-  // I suppose I could do a diff(Fx_c, alphaP) w/ a symbolic toolkit.
-  // for now, just use forward differencing
-  double dx = 0.01; // x_curr is tan(alpha'), range (-1,1) over x < (-pi/2,pi/2)
-  // changing tan(alpha') has no effect on kappa', gamma'
-  double Fy_x_dx = Fy_combined(m_slip->alphaP + dx, m_slip->gammaP, m_slip->kappaP, m_FM_combined.force.y);
-  // dFy_dx = (f(x+dx) - f(x)) / dx
-  double d_Fy = Fy_x_dx - m_FM_combined.force.y;
-
-  return d_Fy / dx;
-}
-
 // non-linear model, just use alphaP = alpha'
 // small alpha, use Eq. 7.37
 // here, we integrate d[tan(alphaP)]/dt for the step size
@@ -864,7 +912,6 @@ double ChPacejkaTire::ODE_RK_kappaAlpha(double V_s,
                                      double x_curr)
 {
   double V_cx_abs = std::abs(V_cx);
-  // double sigma_alpha = get_dFy_dtan_alphaP(x_curr) / C_Fy;
   double k1 = (-V_s - V_cx_abs * x_curr) / sigma;
   double k2 = (-V_s - V_cx_abs  * (x_curr + 0.5 * step_size * k1) ) / sigma;
   double k3 = (-V_s - V_cx_abs * (x_curr + 0.5 * step_size * k2) ) / sigma;
@@ -992,49 +1039,189 @@ void ChPacejkaTire::slip_from_uv(bool use_besselink,
 // -----------------------------------------------------------------------------
 // Calculate tire reactions.
 // -----------------------------------------------------------------------------
-// pure slip reactions, if the tire is in contact with the ground, in the TYDEX W-Axis system.
-// calcFx               alphaP ~= 0
-// calcFy and calcMz    kappaP ~= 0
+// pure and combined slip reactions, if the tire is in contact with the ground,
+// in the TYDEX W-Axis system, evaluated in a single pass.
+// The combined slip reactions share their common factors with the pure slip
+// reactions: the pure forces scaled by the combined slip weighting functions,
+// the pure torque factors D_r, D_t, E_t reused with the equivalent slips, and
+// cos(atan(x)) = 1/sqrt(1+x^2). The intermediate coefficient structs are
+// updated for output (see WriteOutData).
+// If m_combined_only, the pure slip aligning moment is skipped and the pure
+// slip reactions are set to zero. The pure forces F_x0 and F_y0 are needed by
+// the combined forces, so this only saves the trail t0 (3 of 27 sin/cos/atan
+// calls per step; M_zr0 has none when C_r = 1).
 // NOTE: alphaP, gammaP and kappaP defined with respect to tire side specified from *.tir input file.
 // e.g., positive alpha = turn wheel toward vehicle centerline
 // e.g., positive gamma = wheel vertical axis top pointing toward vehicle center
-void ChPacejkaTire::pureSlipReactions()
+void ChPacejkaTire::fusedSlipReactions( )
 {
-  if(m_in_contact)
-  {
-    // calculate Fx, pure long. slip condition
-    m_FM_pure.force.x = Fx_pureLong(m_slip->gammaP, m_slip->kappaP);
+  if(!m_in_contact)
+    return;
 
-    // calc. Fy, pure lateral slip.
-    m_FM_pure.force.y = m_sameSide * Fy_pureLat(m_slip->alphaP, m_slip->gammaP);
+  // load and camber dependent coefficients
+  update_loadCoefs(m_slip->gammaP);
+  const loadCoefs& c = *m_loadCoefs;
 
-    // calc Mz, pure lateral slip. Negative y-input force, and also the output Mz.
-    m_FM_pure.moment.z = m_sameSide * Mz_pureLat(m_slip->alphaP, m_slip->gammaP, m_sameSide * m_FM_pure.force.y);
+  const longitudinal_coefficients& lon = m_params->longitudinal;
+  const lateral_coefficients& lat = m_params->lateral;
+  const aligning_coefficients& al = m_params->aligning;
+  const scaling_coefficients& sc = m_params->scaling;
+
+  double kappa = m_slip->kappaP;
+  double alpha = m_slip->alphaP;
+  double cosPrime_alpha = m_slip->cosPrime_alpha;
+  int sign_Vx = (m_slip->V_cx >= 0) ? 1 : -1;
+
+  // pure longitudinal force
+  double kappa_x = kappa + c.S_Hx;
+  double sign_kap = (kappa_x >= 0) ? 1 : -1;
+  double E_x = c.E_x0 * (1.0 - lon.pex4*sign_kap)*sc.lex;
+  double F_x0 = c.D_x * std::sin(c.C_x * MF_atan(c.B_x, E_x, kappa_x)) - c.S_Vx;
+
+  // pure lateral force
+  double alpha_y = alpha + c.S_Hy;
+  int sign_alpha = (alpha_y >=0) ? 1 : -1;
+  double E_y = c.E_y0 * (1.0 - c.E_y1 * sign_alpha) * sc.ley;
+  double F_y0 = c.D_y * std::sin(c.C_y * MF_atan(c.B_y, E_y, alpha_y)) + c.S_Vy;
+
+  // aligning moment factors, shared by the pure and combined slip moments
+  double alpha_r = alpha + c.S_Hf;
+  double alpha_t = alpha + c.S_Ht;
+  double D_r = c.D_r0*cosPrime_alpha*sign_Vx + m_zeta->z8 - 1.0;
+  double D_t0 = c.D_t0 * sign_Vx;
+  double D_t = D_t0 * c.D_tGamma * m_zeta->z5*sc.ltr;
+  double E_t = c.E_t0 * (1.0 + c.E_t1*(2.0/chrono::CH_C_PI)*std::atan(c.B_t*c.C_t*alpha_t) );
+
+  // pure slip aligning moment
+  double t0 = 0;
+  double MP_z = 0;
+  double M_zr0 = 0;
+  if (!m_combined_only) {
+    t0 = D_t * std::cos(c.C_t * MF_atan(c.B_t, E_t, alpha_t)) * cosPrime_alpha;
+    MP_z = -t0 * F_y0;
+    M_zr0 = D_r * cos_C_atan(c.C_r, c.B_r*alpha_r);
+  }
+
+  // combined slip longitudinal force
+  double S_HxAlpha = lon.rhx1;
+  double alpha_S = alpha + S_HxAlpha;
+  double B_xAlpha = c.B_xAlpha0 * cos_atan(lon.rbx2 * kappa) * sc.lxal;
+  double C_xAlpha = lon.rcx1;
+  double G_xAlpha0 = std::cos(C_xAlpha * MF_atan(B_xAlpha, c.E_xAlpha, S_HxAlpha));
+  double G_xAlpha = std::cos(C_xAlpha * MF_atan(B_xAlpha, c.E_xAlpha, alpha_S)) / G_xAlpha0;
+  double F_x = G_xAlpha * F_x0;
+
+  // combined slip lateral force
+  double kappa_S = kappa + c.S_HyKappa;
+  double B_yKappa = c.B_yKappa0 * cos_atan(lat.rby2 * (alpha - lat.rby3))*sc.lyka;
+  double C_yKappa = lat.rcy1;
+  double D_VyKappa = c.D_VyKappa0 * cos_atan(lat.rvy4 * alpha) * m_zeta->z2;
+  double S_VyKappa = D_VyKappa * std::sin(lat.rvy5 * std::atan(lat.rvy6 * kappa)) * sc.lvyka;
+  double G_yKappa0 = std::cos(C_yKappa * MF_atan(B_yKappa, c.E_yKappa, c.S_HyKappa));
+  double G_yKappa = std::cos(C_yKappa * MF_atan(B_yKappa, c.E_yKappa, kappa_S)) / G_yKappa0;
+  double F_y = G_yKappa * F_y0 + S_VyKappa;
+
+  // combined slip aligning moment, pure torque factors at the equivalent slips
+  double FP_y = F_y - S_VyKappa;
+  double s = m_R0 * (al.ssz1 + al.ssz2*(F_y/m_params->vertical.fnomin) + c.s_gamma)*sc.ls;
+  int sign_alpha_t = (alpha_t >= 0) ? 1 : -1;
+  int sign_alpha_r = (alpha_r >=0) ? 1 : -1;
+  double kappa_eq2 = c.K_xy2*pow(kappa,2);
+  double alpha_t_eq = sign_alpha_t * sqrt(pow(alpha_t,2) + kappa_eq2);
+  double alpha_r_eq = sign_alpha_r * sqrt(pow(alpha_r,2) + kappa_eq2);
+  double M_zr = D_r * cos_C_atan(c.C_r, c.B_r * alpha_r_eq) * cosPrime_alpha;
+  double t = D_t * std::cos(c.C_t * MF_atan(c.B_t, E_t, alpha_t_eq)) * cosPrime_alpha;
+  double M_z_y = -t * FP_y;
+  double M_z_x = s * F_x;
+  double M_z = M_z_y + M_zr + M_z_x;
+
+  // outputs, Fy and Mz flipped if on the other side of the vehicle
+  if (!m_combined_only) {
+    m_FM_pure.force.x = F_x0;
+    m_FM_pure.force.y = m_sameSide * F_y0;
+    m_FM_pure.moment.z = m_sameSide * (MP_z + M_zr0);
+  } else {
+    m_FM_pure.force.x = 0;
+    m_FM_pure.force.y = 0;
+    m_FM_pure.moment.z = 0;
+  }
+  m_FM_combined.force.x = F_x;
+  m_FM_combined.force.y = m_sameSide * F_y;
+  m_FM_combined.moment.z = m_sameSide * M_z;
+
+  // hold onto coefs
+  {
+    pureLongCoefs tmp = { c.S_Hx, kappa_x, c.mu_x, c.K_x, c.B_x, c.C_x, c.D_x, E_x, F_x0, c.S_Vx };
+    *m_pureLong = tmp;
+  }
+  {
+    pureLatCoefs tmp = { c.S_Hy, alpha_y, c.mu_y, c.K_y, c.S_Vy, c.B_y, c.C_y, c.D_y, E_y };
+    *m_pureLat = tmp;
+  }
+  {
+    pureTorqueCoefs tmp = {
+      c.S_Hf, alpha_r, c.S_Ht, alpha_t, cosPrime_alpha, c.K_y,
+      c.B_r, c.C_r, D_r,
+      c.B_t, c.C_t, D_t0, D_t, E_t, t0,
+      MP_z, M_zr0 };
+    *m_pureTorque = tmp;
+  }
+  {
+    combinedLongCoefs tmp = { S_HxAlpha, alpha_S, B_xAlpha, C_xAlpha, c.E_xAlpha, G_xAlpha0, G_xAlpha };
+    *m_combinedLong = tmp;
+  }
+  {
+    combinedLatCoefs tmp = { c.S_HyKappa, kappa_S, B_yKappa, C_yKappa, c.E_yKappa, D_VyKappa, S_VyKappa, G_yKappa0, G_yKappa };
+    *m_combinedLat = tmp;
+  }
+  {
+    combinedTorqueCoefs tmp = { cosPrime_alpha, FP_y, s, alpha_t_eq, alpha_r_eq, M_zr, t, M_z_x, M_z_y };
+    *m_combinedTorque = tmp;
   }
 }
 
-// combined slip reactions, if the tire is in contact with the ground
-// MUST call pureSlipReactions() first, as these functions rely on intermediate values
-// NOTE: alphaP and gammaP have already been modified for being on the L/R side
-// e.g., positive alpha = turn wheel toward vehicle centerline
-// e.g., positive gamma = wheel vertical axis top pointing toward vehicle center
-void ChPacejkaTire::combinedSlipReactions( )
+// pure and combined slip reactions, interpolated in the lookup table.
+// Also sets the intermediate values needed by advance_slip_transient().
+// NOTE: the table is in the tire side convention of the *.tir file, as are
+// alphaP, gammaP and kappaP
+void ChPacejkaTire::tableSlipReactions( )
 {
   if(m_in_contact)
   {
-    // calculate Fx for combined slip
-    m_FM_combined.force.x = Fx_combined(m_slip->alphaP, m_slip->gammaP, m_slip->kappaP, m_FM_pure.force.x);
+    double v[ChPacejkaTable::NUM_CHANNELS];
+    m_table->Evaluate(m_slip->kappaP, m_slip->alphaP, m_slip->gammaP, m_Fz, v);
 
-    // calc Fy for combined slip.
-    m_FM_combined.force.y = m_sameSide * Fy_combined(m_slip->alphaP, m_slip->gammaP, m_slip->kappaP, m_sameSide * m_FM_pure.force.y);
+    if (!m_combined_only) {
+      m_FM_pure.force.x = v[ChPacejkaTable::FX_PURE];
+      m_FM_pure.force.y = m_sameSide * v[ChPacejkaTable::FY_PURE];
+      m_FM_pure.moment.z = m_sameSide * v[ChPacejkaTable::MZ_PURE];
+    } else {
+      m_FM_pure.force.x = 0;
+      m_FM_pure.force.y = 0;
+      m_FM_pure.moment.z = 0;
+    }
 
-    // calc Mz for combined slip
-    m_FM_combined.moment.z = m_sameSide * Mz_combined(m_pureTorque->alpha_r, m_pureTorque->alpha_t, m_slip->gammaP, m_slip->kappaP, m_FM_combined.force.x, m_sameSide * m_FM_combined.force.y);
+    m_FM_combined.force.x = v[ChPacejkaTable::FX];
+    m_FM_combined.force.y = m_sameSide * v[ChPacejkaTable::FY];
+    m_FM_combined.moment.z = m_sameSide * v[ChPacejkaTable::MZ];
+
+    m_pureLat->D_y = v[ChPacejkaTable::D_Y];
+    double alpha_r = m_slip->alphaP + v[ChPacejkaTable::S_HF];
+    double kappa_r = v[ChPacejkaTable::K_XY] * m_slip->kappaP;
+    int sign_alpha_r = (alpha_r >= 0) ? 1 : -1;
+    m_pureTorque->alpha_r = alpha_r;
+    m_combinedTorque->alpha_r_eq = sign_alpha_r * std::sqrt(alpha_r * alpha_r + kappa_r * kappa_r);
   }
 }
 
 void ChPacejkaTire::relaxationLengths()
 {
+  // these only depend on the vertical load
+  if (m_loadCoefs->valid_relax && std::abs(m_Fz - m_loadCoefs->Fz_relax) <= m_coef_Fz_tol)
+    return;
+  m_loadCoefs->valid_relax = true;
+  m_loadCoefs->Fz_relax = m_Fz;
+
   double p_Ky4 = 2; // according to Pac2002 model
   double p_Ky5 = 0;
   double p_Ky6 = 2.5; // 0.92;
@@ -1065,183 +1252,84 @@ void ChPacejkaTire::relaxationLengths()
   }
 }
 
-double ChPacejkaTire::Fx_pureLong(double gamma, double kappa)
+// Evaluate the terms of the Magic Formula that only depend on the vertical
+// load and the camber. The previous values are reused if Fz and gamma are
+// within the cache tolerances of the values at which they were evaluated.
+void ChPacejkaTire::update_loadCoefs(double gamma)
 {
-  // double eps_Vx = 0.6;
-  double eps_x = 0;
-  // Fx, pure long slip
-  double S_Hx = (m_params->longitudinal.phx1 + m_params->longitudinal.phx2*m_dF_z)*m_params->scaling.lhx;
-  double kappa_x = kappa + S_Hx;  // * 0.1;
+  loadCoefs& c = *m_loadCoefs;
 
-  double mu_x = (m_params->longitudinal.pdx1 + m_params->longitudinal.pdx2*m_dF_z) * (1.0 - m_params->longitudinal.pdx3 * pow(gamma,2) ) * m_params->scaling.lmux;	// >0
-  double K_x = m_Fz * (m_params->longitudinal.pkx1 + m_params->longitudinal.pkx2 * m_dF_z) * exp(m_params->longitudinal.pkx3 * m_dF_z) * m_params->scaling.lkx;
-  double C_x = m_params->longitudinal.pcx1 * m_params->scaling.lcx;	// >0
-  double D_x = mu_x * m_Fz * m_zeta->z1;  // >0
-  double B_x = K_x / (C_x * D_x + eps_x);
-
-  double sign_kap = (kappa_x >= 0) ? 1 : -1;
-
-  double E_x = (m_params->longitudinal.pex1 + m_params->longitudinal.pex2 * m_dF_z + m_params->longitudinal.pex3 *  pow(m_dF_z,2) ) * (1.0 - m_params->longitudinal.pex4*sign_kap)*m_params->scaling.lex;
-  double S_Vx = m_Fz * (m_params->longitudinal.pvx1 + m_params->longitudinal.pvx2 * m_dF_z) * m_params->scaling.lvx * m_params->scaling.lmux * m_zeta->z1;
-  double F_x = D_x * std::sin(C_x * std::atan(B_x * kappa_x - E_x * (B_x * kappa_x - std::atan(B_x * kappa_x)))) - S_Vx;
-
-  // hold onto these coefs
-  {
-    pureLongCoefs tmp = { S_Hx, kappa_x, mu_x, K_x, B_x, C_x, D_x, E_x, F_x, S_Vx };
-    *m_pureLong = tmp;
+  if (c.valid && std::abs(m_Fz - c.Fz) <= m_coef_Fz_tol && std::abs(gamma - c.gamma) <= m_coef_gamma_tol) {
+    m_num_coef_hits++;
+    return;
   }
+  m_num_coef_misses++;
 
-  return F_x;
-}
+  c.valid = true;
+  c.Fz = m_Fz;
+  c.gamma = gamma;
 
-double ChPacejkaTire::Fy_pureLat(double alpha, double gamma)
-{
-  double C_y = m_params->lateral.pcy1 * m_params->scaling.lcy;  // > 0
-  double mu_y = (m_params->lateral.pdy1 + m_params->lateral.pdy2 * m_dF_z) * (1.0 - m_params->lateral.pdy3 * pow(gamma,2) ) * m_params->scaling.lmuy;	// > 0
-  double D_y = mu_y * m_Fz * m_zeta->z2;
+  const longitudinal_coefficients& lon = m_params->longitudinal;
+  const lateral_coefficients& lat = m_params->lateral;
+  const aligning_coefficients& al = m_params->aligning;
+  const scaling_coefficients& sc = m_params->scaling;
+  double dF_z2 = pow(m_dF_z, 2);
+  double gamma2 = pow(gamma, 2);
 
+  // pure longitudinal slip
+  double eps_x = 0;
+  c.S_Hx = (lon.phx1 + lon.phx2*m_dF_z)*sc.lhx;
+  c.mu_x = (lon.pdx1 + lon.pdx2*m_dF_z) * (1.0 - lon.pdx3 * gamma2) * sc.lmux;	// >0
+  c.K_x = m_Fz * (lon.pkx1 + lon.pkx2 * m_dF_z) * exp(lon.pkx3 * m_dF_z) * sc.lkx;
+  c.C_x = lon.pcx1 * sc.lcx;	// >0
+  c.D_x = c.mu_x * m_Fz * m_zeta->z1;  // >0
+  c.B_x = c.K_x / (c.C_x * c.D_x + eps_x);
+  c.E_x0 = lon.pex1 + lon.pex2 * m_dF_z + lon.pex3 * dF_z2;
+  c.S_Vx = m_Fz * (lon.pvx1 + lon.pvx2 * m_dF_z) * sc.lvx * sc.lmux * m_zeta->z1;
+
+  // pure lateral slip
+  c.C_y = lat.pcy1 * sc.lcy;  // > 0
+  c.mu_y = (lat.pdy1 + lat.pdy2 * m_dF_z) * (1.0 - lat.pdy3 * gamma2) * sc.lmuy;	// > 0
+  c.D_y = c.mu_y * m_Fz * m_zeta->z2;
   // doesn't make sense to ever have K_y be negative (it can be interpreted as lateral stiffnesss)
-  double K_y = m_params->lateral.pky1 * m_params->vertical.fnomin * std::sin(2.0 * std::atan(m_Fz / (m_params->lateral.pky2 * m_params->vertical.fnomin) ) ) * (1.0 - m_params->lateral.pky3 * std::abs(gamma) ) * m_zeta->z3 * m_params->scaling.lyka;
-  double B_y = K_y / (C_y * D_y);
-
-  // double S_Hy = (m_params->lateral.phy1 + m_params->lateral.phy2 * m_dF_z) * m_params->scaling.lhy + (K_yGamma_0 * m_slip->gammaP - S_VyGamma) * m_zeta->z0 / (K_yAlpha + 0.1) + m_zeta->z4 - 1.0;
+  c.K_y = lat.pky1 * m_params->vertical.fnomin * std::sin(2.0 * std::atan(m_Fz / (lat.pky2 * m_params->vertical.fnomin) ) ) * (1.0 - lat.pky3 * std::abs(gamma) ) * m_zeta->z3 * sc.lyka;
+  c.B_y = c.K_y / (c.C_y * c.D_y);
+  // double S_Hy = (lat.phy1 + lat.phy2 * m_dF_z) * sc.lhy + (K_yGamma_0 * m_slip->gammaP - S_VyGamma) * m_zeta->z0 / (K_yAlpha + 0.1) + m_zeta->z4 - 1.0;
   // Adasms S_Hy is a bit different
-  double S_Hy =  (m_params->lateral.phy1 + m_params->lateral.phy2 * m_dF_z) * m_params->scaling.lhy + (m_params->lateral.phy3 * gamma * m_zeta->z0) + m_zeta->z4 - 1;
-
-  double alpha_y = alpha + S_Hy;
-
-  int sign_alpha = (alpha_y >=0) ? 1 : -1;
-
-  double E_y = (m_params->lateral.pey1 + m_params->lateral.pey2 * m_dF_z) * (1.0 - (m_params->lateral.pey3 + m_params->lateral.pey4 *gamma) * sign_alpha) * m_params->scaling.ley;  // + p_Ey5 * pow(gamma,2)
-  double S_Vy = m_Fz * ((m_params->lateral.pvy1 + m_params->lateral.pvy2 * m_dF_z) * m_params->scaling.lvy + (m_params->lateral.pvy3 + m_params->lateral.pvy4 * m_dF_z) * gamma) * m_params->scaling.lmuy * m_zeta->z2;
-  
-  double F_y = D_y * std::sin(C_y * std::atan(B_y * alpha_y - E_y * (B_y * alpha_y - std::atan(B_y * alpha_y)))) + S_Vy;
-
-  // hold onto coefs
-  {
-    pureLatCoefs tmp = { S_Hy, alpha_y, mu_y, K_y, S_Vy, B_y, C_y, D_y, E_y };
-    *m_pureLat = tmp;
-  }
-
-  return F_y;
-}
-
-double ChPacejkaTire::Mz_pureLat(double alpha, double gamma, double Fy_pureSlip)
-{
-  // some constants
-  int sign_Vx = (m_slip->V_cx >= 0) ? 1 : -1;
-
-  double S_Hf = m_pureLat->S_Hy + m_pureLat->S_Vy / m_pureLat->K_y;
-  double alpha_r = alpha + S_Hf;
-  double S_Ht = m_params->aligning.qhz1 + m_params->aligning.qhz2*m_dF_z + (m_params->aligning.qhz3 + m_params->aligning.qhz4*m_dF_z) * gamma;
-  double alpha_t = alpha + S_Ht;
-
-  double B_r = (m_params->aligning.qbz9 * (m_params->scaling.lky / m_params->scaling.lmuy) + m_params->aligning.qbz10*m_pureLat->B_y*m_pureLat->C_y) * m_zeta->z6;
-  double C_r = m_zeta->z7;
+  c.S_Hy = (lat.phy1 + lat.phy2 * m_dF_z) * sc.lhy + (lat.phy3 * gamma * m_zeta->z0) + m_zeta->z4 - 1;
+  c.E_y0 = lat.pey1 + lat.pey2 * m_dF_z;  // + p_Ey5 * pow(gamma,2)
+  c.E_y1 = lat.pey3 + lat.pey4 * gamma;
+  c.S_Vy = m_Fz * ((lat.pvy1 + lat.pvy2 * m_dF_z) * sc.lvy + (lat.pvy3 + lat.pvy4 * m_dF_z) * gamma) * sc.lmuy * m_zeta->z2;
+
+  // pure slip aligning moment
+  c.S_Hf = c.S_Hy + c.S_Vy / c.K_y;
+  c.S_Ht = al.qhz1 + al.qhz2*m_dF_z + (al.qhz3 + al.qhz4*m_dF_z) * gamma;
+  c.B_r = (al.qbz9 * (sc.lky / sc.lmuy) + al.qbz10*c.B_y*c.C_y) * m_zeta->z6;
+  c.C_r = m_zeta->z7;
   // no terms (Dz10, Dz11) for gamma^2 term seen in Pacejka
-  // double D_r = m_Fz*m_R0 * ((m_params->aligning.qdz6 + m_params->aligning.qdz7 * m_dF_z)*m_params->scaling.lres*m_zeta->z2 + (m_params->aligning.qdz8 + m_params->aligning.qdz9 * m_dF_z)*gamma*m_params->scaling.lgaz*m_zeta->z0) * m_slip->cosPrime_alpha*m_params->scaling.lmuy*sign_Vx + m_zeta->z8 - 1.0;
+  // double D_r = m_Fz*m_R0 * ((al.qdz6 + al.qdz7 * m_dF_z)*sc.lres*m_zeta->z2 + (al.qdz8 + al.qdz9 * m_dF_z)*gamma*sc.lgaz*m_zeta->z0) * m_slip->cosPrime_alpha*sc.lmuy*sign_Vx + m_zeta->z8 - 1.0;
   // reference
-  double D_r = m_Fz*m_R0 * ((m_params->aligning.qdz6 + m_params->aligning.qdz7*m_dF_z)*m_params->scaling.lres + (m_params->aligning.qdz8 + m_params->aligning.qdz9*m_dF_z)*gamma) * m_params->scaling.lmuy*m_slip->cosPrime_alpha*sign_Vx + m_zeta->z8 - 1.0;
+  c.D_r0 = m_Fz*m_R0 * ((al.qdz6 + al.qdz7*m_dF_z)*sc.lres + (al.qdz8 + al.qdz9*m_dF_z)*gamma) * sc.lmuy;
   // qbz4 is not in Pacejka
-  double B_t = (m_params->aligning.qbz1 + m_params->aligning.qbz2*m_dF_z + m_params->aligning.qbz3*pow(m_dF_z,2)) * (1.0 + m_params->aligning.qbz4*gamma + m_params->aligning.qbz5*std::abs(gamma)) * m_params->scaling.lvyka/m_params->scaling.lmuy;
-  double C_t = m_params->aligning.qcz1;
-  double D_t0 = m_Fz * (m_R0/m_params->vertical.fnomin) * (m_params->aligning.qdz1 + m_params->aligning.qdz2*m_dF_z) * sign_Vx;
+  c.B_t = (al.qbz1 + al.qbz2*m_dF_z + al.qbz3*dF_z2) * (1.0 + al.qbz4*gamma + al.qbz5*std::abs(gamma)) * sc.lvyka/sc.lmuy;
+  c.C_t = al.qcz1;
+  c.D_t0 = m_Fz * (m_R0/m_params->vertical.fnomin) * (al.qdz1 + al.qdz2*m_dF_z);
   // no abs on qdz3 gamma in reference
-  double D_t = D_t0 * (1.0 + m_params->aligning.qdz3*std::abs(gamma) + m_params->aligning.qdz4 * pow(gamma,2)) * m_zeta->z5*m_params->scaling.ltr;
-  double E_t = (m_params->aligning.qez1 + m_params->aligning.qez2*m_dF_z + m_params->aligning.qez3*pow(m_dF_z,2)) * (1.0 + (m_params->aligning.qez4 + m_params->aligning.qez5*gamma)*(2.0/chrono::CH_C_PI)*std::atan(B_t*C_t*alpha_t) );
-  double t = D_t * std::cos(C_t * std::atan(B_t*alpha_t - E_t*(B_t*alpha_t - std::atan(B_t*alpha_t)))) * m_slip->cosPrime_alpha;
+  c.D_tGamma = 1.0 + al.qdz3*std::abs(gamma) + al.qdz4 * gamma2;
+  c.E_t0 = al.qez1 + al.qez2*m_dF_z + al.qez3*dF_z2;
+  c.E_t1 = al.qez4 + al.qez5*gamma;
 
-  double MP_z = -t * Fy_pureSlip;
-  double M_zr = D_r * std::cos(C_r*std::atan(B_r*alpha_r)); // this is in the D_r term: * m_slip->cosPrime_alpha;
-
-  double M_z = MP_z + M_zr;
-
-  // hold onto coefs
-  {
-    pureTorqueCoefs tmp = {
-      S_Hf, alpha_r, S_Ht, alpha_t, m_slip->cosPrime_alpha, m_pureLat->K_y,
-      B_r, C_r, D_r,
-      B_t, C_t, D_t0, D_t, E_t, t,
-      MP_z, M_zr };
-    *m_pureTorque = tmp;
-  }
-
-  return M_z;
-}
-
-double ChPacejkaTire::Fx_combined(double alpha, double gamma, double kappa, double Fx_pureSlip)
-{
+  // combined slip
   double rbx3 = 1.0;
-
-  double S_HxAlpha = m_params->longitudinal.rhx1;
-  double alpha_S = alpha + S_HxAlpha;
-  double B_xAlpha = (m_params->longitudinal.rbx1 + rbx3 * pow(gamma, 2)) * std::cos(std::atan(m_params->longitudinal.rbx2 * kappa)) * m_params->scaling.lxal;
-  double C_xAlpha = m_params->longitudinal.rcx1;
-  double E_xAlpha = m_params->longitudinal.rex1 + m_params->longitudinal.rex2 * m_dF_z;
-
-  // double G_xAlpha0 = std::cos(C_xAlpha * std::atan(B_xAlpha * S_HxAlpha - E_xAlpha * (B_xAlpha * S_HxAlpha - std::atan(B_xAlpha * S_HxAlpha)) ) );
-  double G_xAlpha0 = std::cos(C_xAlpha * std::atan(B_xAlpha * S_HxAlpha - E_xAlpha * (B_xAlpha * S_HxAlpha - std::atan(B_xAlpha * S_HxAlpha))));
-
-  // double G_xAlpha = std::cos(C_xAlpha * std::atan(B_xAlpha * alpha_S - E_xAlpha * (B_xAlpha * alpha_S - std::atan(B_xAlpha * alpha_S)) ) ) / G_xAlpha0;
-  double G_xAlpha = std::cos(C_xAlpha * std::atan(B_xAlpha * alpha_S - E_xAlpha * (B_xAlpha * alpha_S - std::atan(B_xAlpha * alpha_S)))) / G_xAlpha0;
-
-  double F_x = G_xAlpha * Fx_pureSlip;
-
-  {
-    combinedLongCoefs tmp = { S_HxAlpha, alpha_S, B_xAlpha, C_xAlpha, E_xAlpha, G_xAlpha0, G_xAlpha };
-    *m_combinedLong = tmp;
-  }
-
-  return F_x;
-}
-
-double ChPacejkaTire::Fy_combined(double alpha, double gamma, double kappa, double Fy_pureSlip)
-{
   double rby4 = 0;
-
-  double S_HyKappa = m_params->lateral.rhy1 + m_params->lateral.rhy2 * m_dF_z;
-  double kappa_S = kappa + S_HyKappa;
-  double B_yKappa = (m_params->lateral.rby1 + rby4 * pow(gamma,2) ) * std::cos( std::atan(m_params->lateral.rby2 * (alpha - m_params->lateral.rby3) ) )*m_params->scaling.lyka;
-  double C_yKappa = m_params->lateral.rcy1;
-  double E_yKappa = m_params->lateral.rey1 + m_params->lateral.rey2 * m_dF_z;
-  double D_VyKappa = m_pureLat->mu_y * m_Fz * (m_params->lateral.rvy1 + m_params->lateral.rvy2 * m_dF_z + m_params->lateral.rvy3 * gamma) * std::cos(std::atan(m_params->lateral.rvy4 * alpha)) * m_zeta->z2;
-  double S_VyKappa = D_VyKappa * std::sin(m_params->lateral.rvy5 * std::atan(m_params->lateral.rvy6 * kappa)) * m_params->scaling.lvyka;
-  double G_yKappa0 = std::cos(C_yKappa * std::atan(B_yKappa * S_HyKappa - E_yKappa * (B_yKappa * S_HyKappa - std::atan(B_yKappa * S_HyKappa))));
-  double G_yKappa = std::cos(C_yKappa * std::atan(B_yKappa * kappa_S - E_yKappa * (B_yKappa * kappa_S - std::atan(B_yKappa * kappa_S)))) / G_yKappa0;
-
-  double F_y = G_yKappa * Fy_pureSlip + S_VyKappa;
-
-  {
-    combinedLatCoefs tmp = { S_HyKappa, kappa_S, B_yKappa, C_yKappa, E_yKappa, D_VyKappa, S_VyKappa, G_yKappa0, G_yKappa };
-    *m_combinedLat = tmp;
-  }
-
-  return F_y;
-}
-
-double ChPacejkaTire::Mz_combined(double alpha_r, double alpha_t, double gamma, double kappa, double Fx_combined, double Fy_combined)
-{
-  double FP_y = Fy_combined - m_combinedLat->S_VyKappa;
-  double s = m_R0 * (m_params->aligning.ssz1 + m_params->aligning.ssz2*(Fy_combined/m_params->vertical.fnomin) + (m_params->aligning.ssz3 + m_params->aligning.ssz4*m_dF_z)*gamma)*m_params->scaling.ls;
-  int sign_alpha_t = (alpha_t >= 0) ? 1 : -1;
-  int sign_alpha_r = (alpha_r >=0) ? 1 : -1;
- 
-  double alpha_t_eq = sign_alpha_t * sqrt(pow(alpha_t,2) + pow(m_pureLong->K_x/m_pureTorque->K_y,2)*pow(kappa,2) );
-  double alpha_r_eq = sign_alpha_r * sqrt(pow(alpha_r,2) + pow(m_pureLong->K_x/m_pureTorque->K_y,2)*pow(kappa,2) );
-
-  double M_zr = m_pureTorque->D_r * std::cos(m_pureTorque->C_r * std::atan(m_pureTorque->B_r * alpha_r_eq)) * m_slip->cosPrime_alpha;
-  double t = m_pureTorque->D_t * std::cos(m_pureTorque->C_t * std::atan(m_pureTorque->B_t*alpha_t_eq - m_pureTorque->E_t * (m_pureTorque->B_t * alpha_t_eq - std::atan(m_pureTorque->B_t * alpha_t_eq)))) * m_slip->cosPrime_alpha;
-
-  double M_z_y = -t * FP_y;
-  double M_z_x = s * Fx_combined;
-  double M_z = M_z_y + M_zr  + M_z_x;
-
-  {
-    combinedTorqueCoefs tmp = { m_slip->cosPrime_alpha, FP_y, s, alpha_t_eq, alpha_r_eq, M_zr, t, M_z_x, M_z_y };
-    *m_combinedTorque = tmp;
-  }
-
-  return M_z;
+  c.B_xAlpha0 = lon.rbx1 + rbx3 * gamma2;
+  c.E_xAlpha = lon.rex1 + lon.rex2 * m_dF_z;
+  c.S_HyKappa = lat.rhy1 + lat.rhy2 * m_dF_z;
+  c.B_yKappa0 = lat.rby1 + rby4 * gamma2;
+  c.E_yKappa = lat.rey1 + lat.rey2 * m_dF_z;
+  c.D_VyKappa0 = c.mu_y * m_Fz * (lat.rvy1 + lat.rvy2 * m_dF_z + lat.rvy3 * gamma);
+  c.K_xy2 = pow(c.K_x / c.K_y, 2);
+  c.s_gamma = (al.ssz3 + al.ssz4*m_dF_z)*gamma;
 }
 
 double ChPacejkaTire::calc_Mx(double gamma, double Fy_combined)
@@ -1272,429 +1360,151 @@ double ChPacejkaTire::calc_My(double Fx_combined)
 }
 
 // -----------------------------------------------------------------------------
-// Load a PacTire specification file.
-//
-// For an example, see the file models/data/hmmwv/pactest.tir
+// Batch evaluation of the steady-state Magic Formula. This only depends on the
+// tire parameters, so it can be used for characterization sweeps on any
+// initialized tire. Without parameters, the outputs are set to zero.
 // -----------------------------------------------------------------------------
-void ChPacejkaTire::loadPacTireParamFile()
-{
-  // try to load the file
-  std::ifstream inFile(this->getPacTireParamFile().c_str(), std::ios::in);
-
-  // if not loaded, say something and exit
-  if (!inFile.is_open())
-  {
-    GetLog() << "\n\n !!!!!!! couldn't load the pac tire file: " << getPacTireParamFile().c_str() << "\n\n";
-    GetLog() << " pacTire param file opened in a text editor somewhere ??? \n\n\n";
-    return;
-  }
-
-  // success in opening file, load the data, broken down into sections
-  // according to what is found in the PacTire input file
-  readPacTireInput(inFile);
-
-  // this bool will allow you to query the pac tire for output
-  // Forces, moments based on wheel state info.
-  m_params_defined = true;
-}
-
-void ChPacejkaTire::readPacTireInput(std::ifstream& inFile)
+bool ChPacejkaTire::EvaluateBatch(int                             n,
+                                  const ChPacejkaBatch::Inputs&   in,
+                                  const ChPacejkaBatch::Outputs&  out) const
 {
-  // advance to the first part of the file with data we need to read
-  std::string tline;
-
-  while (std::getline(inFile, tline))
-  {
-    // first main break
-    if (tline[0] == '$')
-      break;
+  if (!m_params_defined) {
+    double* arrays[] = { out.Fx, out.Fy, out.Mx, out.My, out.Mz,
+                         out.Fx_pure, out.Fy_pure, out.Mz_pure,
+                         out.D_y, out.S_Hf, out.K_xy };
+    for (size_t k = 0; k < sizeof(arrays) / sizeof(arrays[0]); k++) {
+      if (arrays[k])
+        std::fill(arrays[k], arrays[k] + n, 0.0);
+    }
+    return false;
   }
 
-  // to keep things sane (and somewhat orderly), create a function to read 
-  // each subsection. there may be overlap between different PacTire versions,
-  // where these section read functions can be reused
-
-  // 0:  [UNITS], all token values are strings
-  readSection_UNITS(inFile);
-
-  // 1: [MODEL]
-  readSection_MODEL(inFile);
-
-  // 2: [DIMENSION]
-  readSection_DIMENSION(inFile);
-
-  // 3: [SHAPE]
-  readSection_SHAPE(inFile);
-
-  // 4: [VERTICAL]
-  readSection_VERTICAL(inFile);
-
-  // 5-8, ranges for: LONG_SLIP, SLIP_ANGLE, INCLINATION_ANGLE, VETRICAL_FORCE,
-  // in that order
-  readSection_RANGES(inFile);
-
-  // 9: [scaling]
-  readSection_scaling(inFile);
-
-  // 10: [longitudinal]
-  readSection_longitudinal(inFile);
-
-  // 11: [overturning]
-  readSection_overturning(inFile);
-
-  // 12: [lateral]
-  readSection_lateral(inFile);
-
-  // 13: [rolling]
-  readSection_rolling(inFile);
-
-  // 14: [aligning]
-  readSection_aligning(inFile);
+  ChPacejkaBatch batch(*m_params);
+  batch.Evaluate(n, in, out);
+  return true;
 }
 
-void ChPacejkaTire::readSection_UNITS(std::ifstream& inFile)
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::SetCoefCacheTolerance(double Fz_tol, double gamma_tol)
 {
-  // skip the first line
-  std::string tline;
-  std::getline(inFile, tline);
-
-  // string util stuff
-  std::string tok;    // name of token
-  std::string val_str; // temp for string token values
-  std::vector<std::string> split;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-  }
+  m_coef_Fz_tol = Fz_tol;
+  m_coef_gamma_tol = gamma_tol;
 }
 
-void ChPacejkaTire::readSection_MODEL(std::ifstream& inFile)
-{
-  // skip the first line
-  std::string tline;
-  std::getline(inFile, tline);
-
-  // string util stuff
-  std::vector<std::string> split;
-  std::string val_str; // string token values
-
-  // token value changes type in this section, do it manually
-  std::getline(inFile, tline);
-
-  // get the token / value
-  split = splitStr(tline, '=');
-  m_params->model.property_file_format = splitStr(split[1], '\'')[1];
-
-  std::getline(inFile, tline);
-  m_params->model.use_mode = fromTline<int>(tline);
-
-  std::getline(inFile, tline);
-  m_params->model.vxlow = fromTline<double>(tline);
-
-  std::getline(inFile, tline);
-  m_params->model.longvl = fromTline<double>(tline);
-
-  std::getline(inFile, tline);
-  split = splitStr(tline, '=');
-  m_params->model.tyreside = splitStr(split[1], '\'')[1];
-}
+// -----------------------------------------------------------------------------
+// Lookup tables are cached per parameter file and table settings, so that all
+// tires of a vehicle (or fleet) loading the same *.tir file share one table.
+// A table is built (and its error estimated) only the first time it is
+// requested. As for the parameter file cache (ChPacejkaParamFile::ReadCached),
+// the map is guarded by a spin lock, held while the cached handle is copied
+// (the ChSharedPtr reference count is not atomic). The table is built outside
+// the lock; if another thread cached the same table in the meantime, that one
+// is used instead.
+// -----------------------------------------------------------------------------
+typedef std::map<std::string, ChSharedPtr<ChPacejkaTable> > TableCache;
 
-void ChPacejkaTire::readSection_DIMENSION(std::ifstream& inFile)
+static TableCache& GetTableCache()
 {
-  // skip the first two lines
-  std::string tline;
-  std::getline(inFile, tline);
-  std::getline(inFile, tline);
-  // if all the data types are the same in a subsection, life is a little easier
-  // push each token value to this vector, check the # of items added, then 
-  // create the struct by hand only
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 5) {
-    GetLog() << " error reading DIMENSION section of pactire input file!!! \n\n";
-    return;
-  }
-  // right size, create the struct
-  struct dimension dim = { dat[0], dat[1], dat[2], dat[3], dat[4] };
-  m_params->dimension = dim;
+  static TableCache cache;
+  return cache;
 }
 
-void ChPacejkaTire::readSection_SHAPE(std::ifstream& inFile)
+static ChSpinLock& GetTableCacheLock()
 {
-  // skip the first two lines
-  std::string tline;
-  std::getline(inFile, tline);
-  std::getline(inFile, tline);
-  // if all the data types are the same in a subsection, life is a little easier
-  // push each token value to this vector, check the # of items added, then 
-  // create the struct by hand only
-  std::vector<double> rad;
-  std::vector<double> wid;
-  std::vector<std::string> split;
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    split = splitStr(tline, ' ');
-    rad.push_back(std::atof(split[1].c_str()));
-    wid.push_back(std::atof(split[5].c_str()));
-  }
-  m_params->shape.radial = rad;
-  m_params->shape.width = wid;
-}
-
-void ChPacejkaTire::readSection_VERTICAL(std::ifstream& inFile){
-  // skip the first line
-  std::string tline;
-  std::getline(inFile, tline);
-
-  // push each token value to this vector, check the # of items added
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 6) {
-    GetLog() << " error reading VERTICAL section of pactire input file!!! \n\n";
-    return;
-  }
-  // right size, create the struct
-  struct vertical vert = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5] };
-  m_params->vertical = vert;
+  static ChSpinLock lock;
+  return lock;
 }
 
-void ChPacejkaTire::readSection_RANGES(std::ifstream& inFile){
-  // skip the first line
-  std::string tline;
-  std::getline(inFile, tline);
-  // if all the data types are the same in a subsection, life is a little easier
-  // push each token value to this vector, check the # of items added, then 
-  // create the struct by hand only
-  std::vector<double> dat;
-
-  // LONG_SLIP_RANGE
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 2) {
-    GetLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
-    return;
-  }
-  // right size, create the struct
-  struct long_slip_range long_slip = { dat[0], dat[1] };
-  m_params->long_slip_range = long_slip;
-  dat.clear();
-  std::getline(inFile, tline);
-
-  // SLIP_ANGLE_RANGE
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 2) {
-    GetLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
-    return;
-  }
-  // right size, create the struct
-  struct slip_angle_range slip_ang = { dat[0], dat[1] };
-  m_params->slip_angle_range = slip_ang;
-  dat.clear();
-  std::getline(inFile, tline);
-
-  // INCLINATION_ANGLE_RANGE
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 2) {
-    GetLog() << " error reading INCLINATION_ANGLE_RANGE section of pactire input file!!! \n\n";
-    return;
-  }
-  struct inclination_angle_range incl_ang = { dat[0], dat[1] };
-  m_params->inclination_angle_range = incl_ang;
-  dat.clear();
-  std::getline(inFile, tline);
-
-  // VERTICAL_FORCE_RANGE
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 2) {
-    GetLog() << " error reading VERTICAL_FORCE_RANGE section of pactire input file!!! \n\n";
-    return;
-  }
-  struct vertical_force_range vert_range = { dat[0], dat[1] };
-  m_params->vertical_force_range = vert_range;
-}
-
-void ChPacejkaTire::readSection_scaling(std::ifstream& inFile)
+ChSharedPtr<ChPacejkaTable> ChPacejkaTire::GetSharedTable(const std::string&              paramFile,
+                                                          const Pac2002_data&             params,
+                                                          const ChPacejkaTable::Settings& settings)
 {
-  std::string tline;
-  std::getline(inFile, tline);
-  // if all the data types are the same in a subsection, life is a little easier
-  // push each token value to this vector, check the # of items added, then 
-  // create the struct by hand only
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 28) {
-    GetLog() << " error reading scaling section of pactire input file!!! \n\n";
-    return;
-  }
-  struct scaling_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
-    dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
-    dat[18], dat[19], dat[20], dat[21], dat[22], dat[23], dat[24], dat[25], dat[26], dat[27] };
-  m_params->scaling = coefs;
+  std::ostringstream key;
+  key.precision(17);
+  key << paramFile << "|" << settings.num_kappa << "," << settings.num_alpha << ","
+      << settings.num_gamma << "," << settings.num_Fz << "," << settings.kappa_scale << ","
+      << settings.alpha_scale << "," << settings.cubic << "," << settings.tolerance << ","
+      << settings.max_nodes;
+
+  TableCache& cache = GetTableCache();
+  ChSpinLock& lock = GetTableCacheLock();
+
+  ChSharedPtr<ChPacejkaTable> table;
+
+  lock.Lock();
+  TableCache::iterator it = cache.find(key.str());
+  if (it != cache.end())
+    table = it->second;
+  lock.Unlock();
+
+  if (!table.IsNull())
+    return table;
+
+  table = ChSharedPtr<ChPacejkaTable>(new ChPacejkaTable);
+  if (!table->Build(params, settings))
+    return ChSharedPtr<ChPacejkaTable>();
+
+  lock.Lock();
+  std::pair<TableCache::iterator, bool> ins = cache.insert(TableCache::value_type(key.str(), table));
+  bool inserted = ins.second;
+  if (!inserted)
+    table = ins.first->second;
+  lock.Unlock();
+
+  if (!inserted)
+    return table;
+
+  GetLog() << " Pacejka lookup table for " << paramFile.c_str() << ": "
+           << (double)table->GetMemorySize() / 1048576 << " MB\n";
+  ChPacejkaTable::LogError(table->EstimateError(params));
+
+  return table;
 }
 
-void ChPacejkaTire::readSection_longitudinal(std::ifstream& inFile)
+void ChPacejkaTire::ClearLookupTableCache()
 {
-  std::string tline;
-  std::getline(inFile, tline);
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 24) {
-    GetLog() << " error reading longitudinal section of pactire input file!!! \n\n";
-    return;
-  }
-  struct longitudinal_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
-    dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
-    dat[18], dat[19], dat[20], dat[21], dat[22], dat[23] };
-  m_params->longitudinal = coefs;
+  ChSpinLock& lock = GetTableCacheLock();
+  lock.Lock();
+  GetTableCache().clear();
+  lock.Unlock();
 }
 
-void ChPacejkaTire::readSection_overturning(std::ifstream& inFile)
-{
-  std::string tline;
-  std::getline(inFile, tline);
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
 
-  if (dat.size() != 3) {
-    GetLog() << " error reading  overturning section of pactire input file!!! \n\n";
-    return;
-  }
-  struct overturning_coefficients coefs = { dat[0], dat[1], dat[2] };
-  m_params->overturning = coefs;
-}
-
-void ChPacejkaTire::readSection_lateral(std::ifstream& inFile)
+// -----------------------------------------------------------------------------
+// The table is built in Initialize(), once the parameters are loaded.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::EnableLookupTable(const ChPacejkaTable::Settings& settings)
 {
-  std::string tline;
-  std::getline(inFile, tline);
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 34) {
-    GetLog() << " error reading lateral section of pactire input file!!! \n\n";
-    return;
-  }
-  struct lateral_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
-    dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
-    dat[18], dat[19], dat[20], dat[21], dat[22], dat[23], dat[24], dat[25], dat[26], dat[27],
-    dat[28], dat[29], dat[30], dat[31], dat[32], dat[33] };
-  m_params->lateral = coefs;
+  m_use_table = true;
+  m_table_settings = settings;
 }
 
-void ChPacejkaTire::readSection_rolling(std::ifstream& inFile)
+// -----------------------------------------------------------------------------
+// Load a PacTire specification file.
+//
+// For an example, see the file models/data/hmmwv/pactest.tir
+// The file can also be in the binary format created by the pacTire_compile
+// tool, which makes the (single) parse of the file cheaper.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::loadPacTireParamFile()
 {
-  std::string tline;
-  std::getline(inFile, tline);
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
-
-  if (dat.size() != 4) {
-    GetLog() << " error reading rolling section of pactire input file!!! \n\n";
+  // load the data, either from a PacTire input file or from its precompiled
+  // binary form (see ChPacejkaParamFile). The file is parsed only once; all
+  // tires using it get a copy of the cached parameters.
+  if (!ChPacejkaParamFile::ReadCached(getPacTireParamFile(), *m_params))
+  {
+    GetLog() << "\n\n !!!!!!! couldn't load the pac tire file: " << getPacTireParamFile().c_str() << "\n\n";
+    GetLog() << " pacTire param file opened in a text editor somewhere ??? \n\n\n";
     return;
   }
-  struct rolling_coefficients coefs = { dat[0], dat[1], dat[2], dat[3] };
-  m_params->rolling = coefs;
-}
-
-void ChPacejkaTire::readSection_aligning(std::ifstream& inFile)
-{
-  std::string tline;
-  std::getline(inFile, tline);
-  std::vector<double> dat;
-
-  while (std::getline(inFile, tline)) {
-    // made it to the next section
-    if (tline[0] == '$')
-      break;
-    dat.push_back(fromTline<double>(tline));
-  }
 
-  if (dat.size() != 31) {
-    GetLog() << " error reading LONG_SLIP_RANGE section of pactire input file!!! \n\n";
-    return;
-  }
-  struct aligning_coefficients coefs = { dat[0], dat[1], dat[2], dat[3], dat[4], dat[5], dat[6], dat[7],
-    dat[8], dat[9], dat[10], dat[11], dat[12], dat[13], dat[14], dat[15], dat[16], dat[17],
-    dat[18], dat[19], dat[20], dat[21], dat[22], dat[23], dat[24], dat[25], dat[26], dat[27],
-    dat[28], dat[29], dat[30] };
-  m_params->aligning = coefs;
+  // this bool will allow you to query the pac tire for output
+  // Forces, moments based on wheel state info.
+  m_params_defined = true;
 }
 
 
-
 // -----------------------------------------------------------------------------
 // Functions providing access to private structures
 // -----------------------------------------------------------------------------
@@ -1753,23 +1563,117 @@ double ChPacejkaTire::get_longvl() const
   return m_params->model.longvl;
 }
 
+// -----------------------------------------------------------------------------
+// Snapshot and restore the tire state: current wheel state and contact frame,
+// slips (including transient slip displacements), Bessel and relaxation terms,
+// the lateral peak and equivalent slip angle used by the low-speed transient
+// slip branch in the next step, and output forces. The vertical load and camber dependent coefficients cached
+// in m_loadCoefs (and the relaxation lengths derived from the cached load) are
+// not stored; Restore() invalidates them, so that they are recomputed for the
+// restored state rather than reused from a later one.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::Snapshot(ChStateBuffer& buffer) const
+{
+  buffer.Write(m_tireState);
+  buffer.Write(m_W_frame);
+  buffer.Write(m_simTime);
+  buffer.Write(m_in_contact);
+  buffer.Write(m_depth);
+  buffer.Write(m_R_eff);
+  buffer.Write(m_Fz);
+  buffer.Write(m_dF_z);
+  buffer.Write(m_time_since_last_step);
+  buffer.Write(m_initial_step);
+  buffer.Write(m_C_Fx);
+  buffer.Write(m_C_Fy);
+
+  buffer.Write(m_FM_pure);
+  buffer.Write(m_FM_combined);
+  buffer.Write(m_FM_pure_last);
+  buffer.Write(m_FM_combined_last);
+
+  buffer.Write(*m_slip);
+  buffer.Write(*m_relaxation);
+  buffer.Write(*m_bessel);
+  buffer.Write(*m_pureLat);
+  buffer.Write(*m_combinedTorque);
+}
+
+bool ChPacejkaTire::Restore(ChStateBuffer& buffer)
+{
+  m_loadCoefs->valid = false;
+  m_loadCoefs->valid_relax = false;
+
+  return buffer.Read(m_tireState) &&
+         buffer.Read(m_W_frame) &&
+         buffer.Read(m_simTime) &&
+         buffer.Read(m_in_contact) &&
+         buffer.Read(m_depth) &&
+         buffer.Read(m_R_eff) &&
+         buffer.Read(m_Fz) &&
+         buffer.Read(m_dF_z) &&
+         buffer.Read(m_time_since_last_step) &&
+         buffer.Read(m_initial_step) &&
+         buffer.Read(m_C_Fx) &&
+         buffer.Read(m_C_Fy) &&
+         buffer.Read(m_FM_pure) &&
+         buffer.Read(m_FM_combined) &&
+         buffer.Read(m_FM_pure_last) &&
+         buffer.Read(m_FM_combined_last) &&
+         buffer.Read(*m_slip) &&
+         buffer.Read(*m_relaxation) &&
+         buffer.Read(*m_bessel) &&
+         buffer.Read(*m_pureLat) &&
+         buffer.Read(*m_combinedTorque);
+}
+
+
+// -----------------------------------------------------------------------------
+// Reset the transient state. The next call to Advance() integrates the
+// transient slips (if enabled) starting from zero deflections.
+// -----------------------------------------------------------------------------
+void ChPacejkaTire::ResetState()
+{
+  zero_slips();
+
+  bessel zero_bessel = { 0, 0, 0, 0 };
+  *m_bessel = zero_bessel;
+
+  m_time_since_last_step = 0;
+  m_initial_step = false;
+}
+
+
 // -----------------------------------------------------------------------------
 // Write output file for post-processing with the Python pandas module.
+// If a telemetry writer was specified, the values are pushed to it and
+// formatted and written from its background thread.
 // -----------------------------------------------------------------------------
+static const char* pacTire_outHeader =
+  "time,kappa,alpha,gamma,kappaP,alphaP,gammaP,Vx,Vy,omega,Fx,Fy,Fz,Mx,My,Mz,Fxc,Fyc,Mzc,Mzx,Mzy,M_zrc,contact,m_Fz,m_dF_z,u,valpha,vgamma,vphi,du,dvalpha,dvgamma,dvphi,R0,R_l,Reff,MP_z,M_zr,t,s,FX,FY,FZ,MX,MY,MZ,u_Bessel,u_sigma,v_Bessel,v_sigma";
+
 void ChPacejkaTire::WriteOutData(double             time,
                                  const std::string& outFilename)
 {
   // first time thru, write headers
   if (m_Num_WriteOutData == 0) {
     m_outFilename = outFilename;
-    std::ofstream oFile(outFilename.c_str(), std::ios_base::out);
-    if (!oFile.is_open()) {
-      std::cout << " couldn't open file for writing: " << outFilename << " \n\n";
-      return;
+    if (m_out_writer) {
+      m_out_stream = m_out_writer->AddStream(outFilename, pacTire_outHeader, ',');
+      if (m_out_stream < 0) {
+        std::cout << " couldn't open file for writing: " << outFilename << " \n\n";
+        return;
+      }
+      m_Num_WriteOutData++;
     }
     else {
+      std::ofstream oFile(outFilename.c_str(), std::ios_base::out);
+      if (!oFile.is_open()) {
+        std::cout << " couldn't open file for writing: " << outFilename << " \n\n";
+        return;
+      }
       // write the headers, Fx, Fy are pure forces, Fxc and Fyc are the combined forces
-      oFile << "time,kappa,alpha,gamma,kappaP,alphaP,gammaP,Vx,Vy,omega,Fx,Fy,Fz,Mx,My,Mz,Fxc,Fyc,Mzc,Mzx,Mzy,M_zrc,contact,m_Fz,m_dF_z,u,valpha,vgamma,vphi,du,dvalpha,dvgamma,dvphi,R0,R_l,Reff,MP_z,M_zr,t,s,FX,FY,FZ,MX,MY,MZ,u_Bessel,u_sigma,v_Bessel,v_sigma" << std::endl;
+      oFile << pacTire_outHeader << std::endl;
       m_Num_WriteOutData++;
       oFile.close();
     }
@@ -1780,28 +1684,43 @@ void ChPacejkaTire::WriteOutData(double             time,
   }
   // ensure file was able to be opened, headers are written
   if (m_Num_WriteOutData > 0) {
-    // open file, append
-    std::ofstream appFile(outFilename.c_str(), std::ios_base::app);
     // global force/moments applied to wheel rigid body
     ChTireForce global_FM = GetTireForce_combinedSlip(false);
-    // write the slip info, reaction forces for pure & combined slip cases
-    appFile << time << "," << m_slip->kappa << "," << m_slip->alpha*180. / 3.14159 << "," << m_slip->gamma << ","
-      << m_slip->kappaP << "," << m_slip->alphaP << "," << m_slip->gammaP << ","
-      << m_slip->V_cx <<"," << m_slip->V_cy <<","<< m_tireState.omega << ","    // m_tireState.lin_vel.x <<","<< m_tireState.lin_vel.y <<"," 
-      << m_FM_pure.force.x << "," << m_FM_pure.force.y << "," << m_FM_pure.force.z << ","
-      << m_FM_pure.moment.x << "," << m_FM_pure.moment.y << "," << m_FM_pure.moment.z << ","
-      << m_FM_combined.force.x << "," << m_FM_combined.force.y << "," << m_FM_combined.moment.z <<","
-      << m_combinedTorque->M_z_x <<","<< m_combinedTorque->M_z_y <<","<< m_combinedTorque->M_zr <<","<< (int)m_in_contact <<","
-      << m_Fz <<","<< m_dF_z <<","
-      << m_slip->u <<","<< m_slip->v_alpha << "," << m_slip->v_gamma <<"," << m_slip->v_phi <<","
-      << m_slip->Idu_dt <<","<< m_slip->Idv_alpha_dt <<"," << m_slip->Idv_gamma_dt <<"," << m_slip->Idv_phi_dt<<","
-      << m_R0 <<","<< m_R_l << "," << m_R_eff <<","
-      << m_pureTorque->MP_z <<","<< m_pureTorque->M_zr <<"," << m_combinedTorque->t <<","<< m_combinedTorque->s<<","
-      << global_FM.force.x <<","<< global_FM.force.y <<","<< global_FM.force.z <<"," 
-      << global_FM.moment.x <<","<< global_FM.moment.y <<","<< global_FM.moment.z <<","
-      << m_bessel->u_Bessel <<","<<  m_bessel->u_sigma <<","
-      << m_bessel->v_Bessel <<","<< m_bessel->v_sigma
-      << std::endl;
+    // pure slip quantities are not calculated with SetCombinedSlipOnly(true)
+    bool pure = !m_combined_only;
+    double no_value = std::numeric_limits<double>::quiet_NaN();
+    // the slip info, reaction forces for pure & combined slip cases
+    double values[] = {
+      m_slip->kappa, m_slip->alpha*180. / 3.14159, m_slip->gamma,
+      m_slip->kappaP, m_slip->alphaP, m_slip->gammaP,
+      m_slip->V_cx, m_slip->V_cy, m_tireState.omega,
+      (pure ? m_FM_pure.force.x : no_value), (pure ? m_FM_pure.force.y : no_value), m_FM_pure.force.z,
+      m_FM_pure.moment.x, m_FM_pure.moment.y, (pure ? m_FM_pure.moment.z : no_value),
+      m_FM_combined.force.x, m_FM_combined.force.y, m_FM_combined.moment.z,
+      m_combinedTorque->M_z_x, m_combinedTorque->M_z_y, m_combinedTorque->M_zr, (double)(int)m_in_contact,
+      m_Fz, m_dF_z,
+      m_slip->u, m_slip->v_alpha, m_slip->v_gamma, m_slip->v_phi,
+      m_slip->Idu_dt, m_slip->Idv_alpha_dt, m_slip->Idv_gamma_dt, m_slip->Idv_phi_dt,
+      m_R0, m_R_l, m_R_eff,
+      (pure ? m_pureTorque->MP_z : no_value), (pure ? m_pureTorque->M_zr : no_value), m_combinedTorque->t, m_combinedTorque->s,
+      global_FM.force.x, global_FM.force.y, global_FM.force.z,
+      global_FM.moment.x, global_FM.moment.y, global_FM.moment.z,
+      m_bessel->u_Bessel, m_bessel->u_sigma,
+      m_bessel->v_Bessel, m_bessel->v_sigma
+    };
+    int num_values = (int)(sizeof(values) / sizeof(values[0]));
+
+    if (m_out_writer) {
+      m_out_writer->Push(m_out_stream, time, num_values, values);
+      return;
+    }
+
+    // open file, append
+    std::ofstream appFile(outFilename.c_str(), std::ios_base::app);
+    appFile << time;
+    for (int i = 0; i < num_values; i++)
+      appFile << "," << values[i];
+    appFile << std::endl;
     // close the file
     appFile.close();
   }
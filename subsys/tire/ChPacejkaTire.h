@@ -28,6 +28,8 @@
 
 #include "subsys/ChTire.h"
 #include "subsys/ChTerrain.h"
+#include "subsys/tire/ChPacejkaBatch.h"
+#include "subsys/tire/ChPacejkaTable.h"
 
 namespace chrono {
 
@@ -43,6 +45,8 @@ struct combinedTorqueCoefs;
 struct zetaCoefs;
 struct relaxationL;
 struct bessel;
+struct loadCoefs;
+class ChTelemetryWriter;
 
 ///
 /// Concrete tire class that implements the Pacejka tire model.
@@ -58,14 +62,14 @@ public:
   /// chrono can suggest a time step for use with the ODE slips
   ChPacejkaTire(
     const std::string& name,              ///< [in] name of this tire
-    const std::string& pacTire_paramFile, ///< [in] name of the parameter file
+    const std::string& pacTire_paramFile, ///< [in] name of the parameter file (.tir or compiled binary)
     const ChTerrain&   terrain            ///< [in] reference to the terrain system
     );
 
   /// Construct a Pacejka tire with specified vertical load, for testing purposes
   ChPacejkaTire(
     const std::string& name,                       ///< [in] name of this tire
-    const std::string& pacTire_paramFile,          ///< [in] name of the parameter file
+    const std::string& pacTire_paramFile,          ///< [in] name of the parameter file (.tir or compiled binary)
     const ChTerrain&   terrain,                    ///< [in] reference to the terrain system
     double             Fz_override,                ///< [in] prescribed vertical load
     bool               use_transient_slip = true   ///< [in] indicate if using transient slip model
@@ -101,12 +105,28 @@ public:
   /// time increment.
   virtual void Advance(double step);
 
+  /// Append the internal state of this tire (slips, transient slip and
+  /// relaxation quantities, current forces) to the specified buffer.
+  virtual void Snapshot(ChStateBuffer& buffer) const;
+
+  /// Restore the internal state of this tire from the specified buffer.
+  virtual bool Restore(ChStateBuffer& buffer);
+
+  /// Reset the slips (including the transient slip states) and the transient
+  /// integration timing, as after Initialize().
+  virtual void ResetState();
+
   /// Write output data to a file.
   void WriteOutData(
     double             time,
     const std::string& outFilename
     );
 
+  /// Record the output of WriteOutData() through the specified asynchronous
+  /// writer (NULL to write synchronously). Must be set before the first call
+  /// to WriteOutData().
+  void SetTelemetryWriter(ChTelemetryWriter* writer) { m_out_writer = writer; }
+
   /// Manually set the vertical wheel load as an input.
   void set_Fz_override(double Fz) { m_Fz_override = Fz; }
 
@@ -126,6 +146,26 @@ public:
   /// Get the average simulation time per step spent in calculating ODEs
   double get_average_ODE_time() { return m_sum_ODE_time/(double)m_num_ODE_calls; }
 
+  /// Set the tolerances within which the vertical load and camber dependent
+  /// Magic Formula coefficients (and relaxation lengths) from a previous
+  /// evaluation are reused, instead of being recomputed. With the default
+  /// zero tolerances, they are only reused if Fz and gamma are unchanged.
+  /// Nonzero tolerances trade accuracy for speed: the force error is of the
+  /// order of Fz_tol / Fz, but can be much larger for tires with a strong
+  /// camber dependence (e.g. large PEY4).
+  void SetCoefCacheTolerance(
+    double Fz_tol,     ///< [in] vertical load tolerance [N]
+    double gamma_tol   ///< [in] camber tolerance, on gammaP = sin(gamma)
+    );
+
+  /// Get the number of Magic Formula evaluations that reused the cached
+  /// coefficients (relaxation length evaluations are not counted).
+  int get_coef_cache_hits() const { return m_num_coef_hits; }
+
+  /// Get the number of Magic Formula evaluations that recomputed the cached
+  /// coefficients.
+  int get_coef_cache_misses() const { return m_num_coef_misses; }
+
   /// Get current wheel longitudinal slip.
   double get_kappa() const;
 
@@ -168,32 +208,57 @@ public:
   /// Get the current value of the integration step size.
   double GetStepsize() const { return m_step_size; }
 
+  /// Only calculate the combined slip reactions in Advance(). This skips the
+  /// pure slip aligning moment; the pure slip reactions returned by
+  /// GetTireForce_pureSlip() are then zero (except Mx and My, which are
+  /// shared with the combined slip reactions), and WriteOutData() writes
+  /// "nan" in the pure slip columns (Fx, Fy, Mz, MP_z, M_zr).
+  /// The saving is modest: the combined slip forces scale the pure slip forces,
+  /// which are still evaluated, so only 3 of the 27 sin/cos/atan evaluations
+  /// per step are skipped (about 10% of the slip reactions cost).
+  void SetCombinedSlipOnly(bool val) { m_combined_only = val; }
+
+  /// Evaluate the steady-state Magic Formula of this tire at n points of
+  /// (kappa, alpha, gamma, Fz), without modifying the tire state.
+  /// See ChPacejkaBatch for the conventions and the accuracy with respect to
+  /// the per-step evaluation in Advance().
+  /// Return false (with all requested outputs set to zero) if the tire
+  /// parameters could not be loaded.
+  bool EvaluateBatch(
+    int                             n,    ///< [in] number of points
+    const ChPacejkaBatch::Inputs&   in,   ///< [in] input arrays
+    const ChPacejkaBatch::Outputs&  out   ///< [out] output arrays
+    ) const;
+
+  /// Evaluate the steady-state reactions in Advance() by interpolation in a
+  /// precomputed table, instead of the Magic Formula equations. Must be called
+  /// before Initialize(), which gets the table. Tables are shared by all tires
+  /// using the same parameter file and settings; a table is built (and its
+  /// estimated error reported) only once. If the table cannot be built, the
+  /// exact equations are used. They are also used whenever the tire rolls
+  /// backwards (V_cx < 0), which the table does not cover.
+  /// Note that in this mode the intermediate coefficients reported by
+  /// WriteOutData() are not updated, and cos'(alpha) takes its steady-state
+  /// value 1 / sqrt(1 + alphaP^2).
+  void EnableLookupTable(
+    const ChPacejkaTable::Settings& settings = ChPacejkaTable::Settings()  ///< [in] table size and accuracy
+    );
+
+  /// Return the lookup table used in Advance() (NULL if the exact equations are used).
+  const ChPacejkaTable* GetLookupTable() const { return m_table.get_ptr(); }
+
+  /// Release all cached lookup tables. Tables still in use by existing tires
+  /// are released when these tires are destroyed.
+  static void ClearLookupTableCache();
+
 private:
 
   // where to find the input parameter file
   const std::string& getPacTireParamFile() const { return m_paramFile; }
 
-  // look for this data file
+  // load the model parameters from this data file (text or binary)
   virtual void loadPacTireParamFile();
 
-  // once Pac tire input text file has been succesfully opened, read the input
-  // data, and populate the data struct
-  virtual void readPacTireInput(std::ifstream& inFile);
-
-  // functions for reading each section in the paramter file
-  void readSection_UNITS(std::ifstream& inFile);
-  void readSection_MODEL(std::ifstream& inFile);
-  void readSection_DIMENSION(std::ifstream& inFile);
-  void readSection_SHAPE(std::ifstream& inFile);
-  void readSection_VERTICAL(std::ifstream& inFile);
-  void readSection_RANGES(std::ifstream& inFile);
-  void readSection_scaling(std::ifstream& inFile);
-  void readSection_longitudinal(std::ifstream& inFile);
-  void readSection_overturning(std::ifstream& inFile);
-  void readSection_lateral(std::ifstream& inFile);
-  void readSection_rolling(std::ifstream& inFile);
-  void readSection_aligning(std::ifstream& inFile);
-
   /// update the tire contact coordinate system, TYDEX W-Axis
   /// checks for contact, sets m_in_contact and m_depth
   void update_W_frame();
@@ -238,9 +303,6 @@ private:
     double step_size,    // the simulation timestep size
     double x_curr);      // f(x_curr)
 
-  // calculate the linearized slope of Fy vs. alphaP at the current value
-  double get_dFy_dtan_alphaP(double x_curr);
-
   // calculate v_alpha differently at low speeds
   // relaxation length is non-linear
   double ODE_RK_kappaAlpha(double V_sy,
@@ -279,45 +341,25 @@ private:
     double bessel_Cx = 350.0, double bessel_Cy = 200.0,
     double V_low = 5.0);
 
-  /// calculate the reaction forces and moments, pure slip cases
+  /// calculate the pure and combined slip reactions in a single pass
   /// assign longitudinal, lateral force, aligning moment:
-  /// Fx, Fy and Mz
-  void pureSlipReactions( );
-
-  /// calculate combined slip reactions
-  /// assign Fx, Fy, Mz
-  void combinedSlipReactions( );
-
-  /// longitudinal force, alpha ~= 0
-  /// assign to m_FM.force.x
-  /// assign m_pureLong, trionometric function calculated constants
-  double Fx_pureLong(double gamma, double kappa);
-
-  /// lateral force,  kappa ~= 0
-  /// assign to m_FM.force.y
-  /// assign m_pureLong, trionometric function calculated constants
-  double Fy_pureLat(double alpha, double gamma);
-
-  /// aligning moment,  kappa ~= 0
-  /// assign to m_FM.moment.z
-  /// assign m_pureLong, trionometric function calculated constants
-  double Mz_pureLat(double alpha, double gamma, double Fy_pureSlip);
-
-  /// longitudinal force, combined slip (general case)
-  /// assign m_FM_combined.force.x
-  /// assign m_combinedLong
-  double Fx_combined(double alpha, double gamma, double kappa, double Fx_pureSlip);
-
-  /// calculate lateral force, combined slip (general case)
-  /// assign m_FM_combined.force.y
-  /// assign m_combinedLat
-  double Fy_combined(double alpha, double gamma, double kappa, double Fy_pureSlip);
-
-  // calculate aligning torque, combined slip (gernal case)
-  /// assign m_FM_combined.moment.z
-  /// assign m_combinedTorque
-  double Mz_combined(double alpha_r, double alpha_t, double gamma, double kappa,
-    double Fx_combined, double Fy_combined);
+  /// Fx, Fy and Mz, and the intermediate coefficients
+  void fusedSlipReactions( );
+
+  /// update the vertical load and camber dependent coefficients in m_loadCoefs,
+  /// unless the cached values are within tolerance
+  void update_loadCoefs(double gamma);
+
+  /// calculate the pure and combined slip reactions from the lookup table
+  /// assign Fx, Fy, Mz, and the D_y, alpha_r_eq used by the transient slips
+  void tableSlipReactions( );
+
+  /// get the lookup table for the specified parameter file and settings from
+  /// the cache, building it if needed (empty handle if it cannot be built).
+  /// The cache is guarded by a spin lock, as the parameter file cache.
+  static ChSharedPtr<ChPacejkaTable> GetSharedTable(const std::string&              paramFile,
+                                                    const Pac2002_data&             params,
+                                                    const ChPacejkaTable::Settings& settings);
 
   /// calculate the overturning couple moment
   /// assign m_FM.moment.x and m_FM_combined.moment.x
@@ -350,6 +392,7 @@ private:
   double m_Fz_override;        // if manually inputting the vertical wheel load
 
   double m_step_size;          // integration step size
+  bool m_combined_only;        // skip the pure slip reactions in Advance()?
   double m_time_since_last_step; // init. to -1 in Initialize()
   bool m_initial_step;         // so Advance() gets called at time = 0
   int m_num_ODE_calls;
@@ -357,6 +400,11 @@ private:
   int m_num_Advance_calls;
   double m_sum_Advance_time;
 
+  double m_coef_Fz_tol;        // cache tolerance on Fz for m_loadCoefs
+  double m_coef_gamma_tol;     // cache tolerance on gammaP for m_loadCoefs
+  int m_num_coef_hits;         // number of evaluations that reused m_loadCoefs
+  int m_num_coef_misses;       // number of evaluations that recomputed m_loadCoefs
+
   ChTireForce m_FM_pure;            // output tire forces, based on pure slip
   ChTireForce m_FM_combined;   // output tire forces, based on combined slip
   // previous steps calculated reaction
@@ -372,9 +420,15 @@ private:
   std::string m_outFilename;   // output filename
 
   int m_Num_WriteOutData;      // number of times WriteOut was called
+  ChTelemetryWriter* m_out_writer;  // asynchronous writer for WriteOutData (may be NULL)
+  int m_out_stream;            // stream identifier in m_out_writer
 
   bool m_params_defined;       // indicates if model params. have been defined/loaded
 
+  bool m_use_table;                      // build a lookup table in Initialize()?
+  ChPacejkaTable::Settings m_table_settings;  // lookup table settings
+  ChSharedPtr<ChPacejkaTable> m_table;   // lookup table (empty if not used)
+
   // MODEL PARAMETERS
 
   // important slip quantities
@@ -398,42 +452,10 @@ private:
   relaxationL*         m_relaxation;
   bessel* m_bessel;
 
-};
-
-
-// -----------------------------------------------------------------------------
-// String manipulation utility functions.
-// -----------------------------------------------------------------------------
-
-std::vector<std::string>& splitStr(const std::string &s, char delim, std::vector<std::string> &elems){
-  std::stringstream ss(s);
-  std::string item;
-  while (getline(ss, item, delim)) {
-    elems.push_back(item);
-  }
-  return elems;
-}
-
-std::vector<std::string> splitStr(const std::string &s, char delim) {
-  std::vector<std::string> elems;
-  return splitStr(s, delim, elems);
-}
-
-
-// convert a string to another type
-template<class T> T fromString(const std::string& s){
-  std::istringstream stream(s);
-  T t;
-  stream >> t;
-  return t;
-}
-
-// read an input line from tm.config, return the number that matters
-template<class T> T fromTline(const std::string& tline){
-  T t = fromString<T>(splitStr(splitStr(tline, '/')[0], '=')[1]);
-  return t;
-}
+  // vertical load and camber dependent coefficients, cached between steps
+  loadCoefs*           m_loadCoefs;
 
+};
 
 
 } // end namespace chrono
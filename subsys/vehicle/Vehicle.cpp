@@ -17,12 +17,14 @@
 // =============================================================================
 
 #include <cstdio>
+#include <algorithm>
 
 #include "assets/ChSphereShape.h"
 #include "assets/ChCylinderShape.h"
 #include "assets/ChTriangleMeshShape.h"
 #include "assets/ChTexture.h"
 #include "assets/ChColorAsset.h"
+#include "core/ChLog.h"
 #include "physics/ChGlobal.h"
 
 #include "subsys/vehicle/Vehicle.h"
@@ -71,18 +73,38 @@ static ChQuaternion<> loadQuaternion(const Value& a)
 
 
 // -----------------------------------------------------------------------------
+// Return the parsed specification for the given subsystem file: either one of
+// the documents provided at construction, or the provided document 'd' after
+// parsing the file.
 // -----------------------------------------------------------------------------
-void Vehicle::LoadSteering(const std::string& filename)
+const Document& Vehicle::ReadSubsystem(const std::string& file_name,
+                                       Document&          d) const
 {
-  FILE* fp = fopen(filename.c_str(), "r");
+  if (m_subsystems) {
+    DocumentMap::const_iterator it = m_subsystems->find(file_name);
+    if (it != m_subsystems->end() && it->second)
+      return *it->second;
+  }
+
+  FILE* fp = fopen(vehicle::GetDataFile(file_name).c_str(), "r");
 
   char readBuffer[65536];
   FileReadStream is(fp, readBuffer, sizeof(readBuffer));
 
+  d.ParseStream(is);
+
   fclose(fp);
 
-  Document d;
-  d.ParseStream(is);
+  return d;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void Vehicle::LoadSteering(const std::string& file_name)
+{
+  Document local;
+  const Document& d = ReadSubsystem(file_name, local);
 
   // Check that the given file is a steering specification file.
   assert(d.HasMember("Type"));
@@ -108,17 +130,10 @@ void Vehicle::LoadSteering(const std::string& filename)
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
-void Vehicle::LoadDriveline(const std::string& filename)
+void Vehicle::LoadDriveline(const std::string& file_name)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  Document local;
+  const Document& d = ReadSubsystem(file_name, local);
 
   // Check that the given file is a driveline specification file.
   assert(d.HasMember("Type"));
@@ -146,18 +161,11 @@ void Vehicle::LoadDriveline(const std::string& filename)
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
-void Vehicle::LoadSuspension(const std::string& filename,
+void Vehicle::LoadSuspension(const std::string& file_name,
                              int                axle)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  Document local;
+  const Document& d = ReadSubsystem(file_name, local);
 
   // Check that the given file is a suspension specification file.
   assert(d.HasMember("Type"));
@@ -190,17 +198,10 @@ void Vehicle::LoadSuspension(const std::string& filename,
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
-void Vehicle::LoadWheel(const std::string& filename, int axle, int side)
+void Vehicle::LoadWheel(const std::string& file_name, int axle, int side)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  Document local;
+  const Document& d = ReadSubsystem(file_name, local);
 
   // Check that the given file is a wheel specification file.
   assert(d.HasMember("Type"));
@@ -214,24 +215,17 @@ void Vehicle::LoadWheel(const std::string& filename, int axle, int side)
   // Create the wheel using the appropriate template.
   if (subtype.compare("Wheel") == 0)
   {
-    m_wheels[2 * axle + side] = ChSharedPtr<ChWheel>(new Wheel(filename));
+    m_wheels[2 * axle + side] = ChSharedPtr<ChWheel>(new Wheel(d));
   }
 }
 
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
-void Vehicle::LoadBrake(const std::string& filename, int axle, int side)
+void Vehicle::LoadBrake(const std::string& file_name, int axle, int side)
 {
-  FILE* fp = fopen(filename.c_str(), "r");
-
-  char readBuffer[65536];
-  FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-  fclose(fp);
-
-  Document d;
-  d.ParseStream(is);
+  Document local;
+  const Document& d = ReadSubsystem(file_name, local);
 
   // Check that the given file is a wheel specification file.
   assert(d.HasMember("Type"));
@@ -245,7 +239,7 @@ void Vehicle::LoadBrake(const std::string& filename, int axle, int side)
   // Create the brake using the appropriate template.
   if (subtype.compare("BrakeSimple") == 0)
   {
-    m_brakes[2 * axle + side] = ChSharedPtr<ChBrake>(new BrakeSimple(filename));
+    m_brakes[2 * axle + side] = ChSharedPtr<ChBrake>(new BrakeSimple(d));
   }
 }
 
@@ -253,7 +247,8 @@ void Vehicle::LoadBrake(const std::string& filename, int axle, int side)
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 Vehicle::Vehicle(const std::string& filename)
-: m_chassisUseMesh(false)
+: m_subsystems(NULL),
+  m_chassisUseMesh(false)
 {
   Create(filename);
 }
@@ -261,11 +256,65 @@ Vehicle::Vehicle(const std::string& filename)
 Vehicle::Vehicle(ChSystem*          system,
                  const std::string& filename)
 : ChVehicle(system),
+  m_subsystems(NULL),
   m_chassisUseMesh(false)
 {
   Create(filename);
 }
 
+Vehicle::Vehicle(const rapidjson::Document& d)
+: m_subsystems(NULL),
+  m_chassisUseMesh(false)
+{
+  Create(d);
+}
+
+Vehicle::Vehicle(ChSystem*                  system,
+                 const rapidjson::Document& d)
+: ChVehicle(system),
+  m_subsystems(NULL),
+  m_chassisUseMesh(false)
+{
+  Create(d);
+}
+
+Vehicle::Vehicle(const rapidjson::Document& d,
+                 const DocumentMap&         subsystems)
+: m_subsystems(&subsystems),
+  m_chassisUseMesh(false)
+{
+  Create(d);
+  m_subsystems = NULL;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void Vehicle::GetSubsystemFiles(const rapidjson::Document& d,
+                                std::vector<std::string>&  files)
+{
+  static const char* axle_files[5] = {
+    "Suspension Input File",
+    "Left Wheel Input File",
+    "Right Wheel Input File",
+    "Left Brake Input File",
+    "Right Brake Input File"
+  };
+
+  std::vector<std::string> names;
+  names.push_back(d["Steering"]["Input File"].GetString());
+  names.push_back(d["Driveline"]["Input File"].GetString());
+  for (SizeType i = 0; i < d["Axles"].Size(); i++) {
+    for (int k = 0; k < 5; k++)
+      names.push_back(d["Axles"][i][axle_files[k]].GetString());
+  }
+
+  for (size_t i = 0; i < names.size(); i++) {
+    if (std::find(files.begin(), files.end(), names[i]) == files.end())
+      files.push_back(names[i]);
+  }
+}
+
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -284,6 +333,11 @@ void Vehicle::Create(const std::string& filename)
   Document d;
   d.ParseStream(is);
 
+  Create(d);
+}
+
+void Vehicle::Create(const rapidjson::Document& d)
+{
   // Read top-level data
   assert(d.HasMember("Type"));
   assert(d.HasMember("Template"));
@@ -357,7 +411,7 @@ void Vehicle::Create(const std::string& filename)
 
   {
     std::string file_name = d["Steering"]["Input File"].GetString();
-    LoadSteering(vehicle::GetDataFile(file_name));
+    LoadSteering(file_name);
     m_steeringLoc = loadVector(d["Steering"]["Location"]);
     m_steeringRot = loadQuaternion(d["Steering"]["Orientation"]);
     m_steer_susp = d["Steering"]["Suspension Index"].GetInt();
@@ -369,7 +423,7 @@ void Vehicle::Create(const std::string& filename)
 
   {
     std::string file_name = d["Driveline"]["Input File"].GetString();
-    LoadDriveline(vehicle::GetDataFile(file_name));
+    LoadDriveline(file_name);
     SizeType num_driven_susp = d["Driveline"]["Suspension Indexes"].Size();
     m_driven_susp.resize(num_driven_susp);
     for (SizeType i = 0; i < num_driven_susp; i++) {
@@ -386,21 +440,21 @@ void Vehicle::Create(const std::string& filename)
   for (int i = 0; i < m_num_axles; i++) {
     // Suspension
     std::string file_name = d["Axles"][i]["Suspension Input File"].GetString();
-    LoadSuspension(vehicle::GetDataFile(file_name), i);
+    LoadSuspension(file_name, i);
     m_suspLocations[i] = loadVector(d["Axles"][i]["Suspension Location"]);
 
     // Left and right wheels
     file_name = d["Axles"][i]["Left Wheel Input File"].GetString();
-    LoadWheel(vehicle::GetDataFile(file_name), i, 0);
+    LoadWheel(file_name, i, 0);
     file_name = d["Axles"][i]["Right Wheel Input File"].GetString();
-    LoadWheel(vehicle::GetDataFile(file_name), i, 1);
+    LoadWheel(file_name, i, 1);
 
     // Left and right brakes
     file_name = d["Axles"][i]["Left Brake Input File"].GetString();
-    LoadBrake(vehicle::GetDataFile(file_name), i, 0);
+    LoadBrake(file_name, i, 0);
 
     file_name = d["Axles"][i]["Right Brake Input File"].GetString();
-    LoadBrake(vehicle::GetDataFile(file_name), i, 1);
+    LoadBrake(file_name, i, 1);
   }
 
   // -----------------------
@@ -409,6 +463,32 @@ void Vehicle::Create(const std::string& filename)
 
   m_driverCsys.pos = loadVector(d["Driver Position"]["Location"]);
   m_driverCsys.rot = loadQuaternion(d["Driver Position"]["Orientation"]);
+
+  // --------------------------------------------
+  // Solver settings (optional; see ChSolverTuner)
+  // --------------------------------------------
+
+  if (d.HasMember("Solver"))
+  {
+    const Value& solver = d["Solver"];
+    SolverSettings settings = GetSolverSettings();
+
+    if (solver.HasMember("Type"))
+    {
+      // An unknown solver name is reported and the current solver type kept;
+      // the remaining settings still apply.
+      if (!GetSolverType(solver["Type"].GetString(), settings.type))
+        GetLog() << "Vehicle: unknown solver type '" << solver["Type"].GetString() << "' ignored\n";
+    }
+    if (solver.HasMember("Max Iterations Speed"))
+      settings.max_iters_speed = solver["Max Iterations Speed"].GetInt();
+    if (solver.HasMember("Max Iterations Stab"))
+      settings.max_iters_stab = solver["Max Iterations Stab"].GetInt();
+    if (solver.HasMember("Max Penetration Recovery Speed"))
+      settings.max_recovery_speed = solver["Max Penetration Recovery Speed"].GetDouble();
+
+    SetSolverSettings(settings);
+  }
 }
 
 
@@ -455,11 +535,11 @@ void Vehicle::Update(double              time,
   // Let the steering subsystem process the steering input.
   m_steering->Update(time, steering);
 
-  // Apply tire forces to spindle bodies and apply braking.
-  for (int i = 0; i < m_num_axles; i++) {
-    m_suspensions[i]->ApplyTireForce(LEFT, tire_forces[2 * i]);
-    m_suspensions[i]->ApplyTireForce(RIGHT, tire_forces[2 * i + 1]);
+  // Apply tire forces to spindle bodies.
+  ApplyTireForces(tire_forces);
 
+  // Apply braking.
+  for (int i = 0; i < m_num_axles; i++) {
     m_brakes[2 * i]->ApplyBrakeModulation(braking);
     m_brakes[2 * i + 1]->ApplyBrakeModulation(braking);
   }
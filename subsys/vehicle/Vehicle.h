@@ -19,24 +19,48 @@
 #ifndef VEHICLE_H
 #define VEHICLE_H
 
+#include <map>
+
 #include "core/ChCoordsys.h"
 #include "physics/ChSystem.h"
 
 #include "subsys/ChVehicle.h"
 
+#include "rapidjson/document.h"
+
 namespace chrono {
 
 class CH_SUBSYS_API Vehicle : public ChVehicle
 {
 public:
 
+  /// Parsed subsystem specification files, keyed by file name (as it appears
+  /// in the vehicle specification file).
+  typedef std::map<std::string, const rapidjson::Document*> DocumentMap;
+
   Vehicle(const std::string& filename);
 
   Vehicle(ChSystem*          system,
           const std::string& filename);
 
+  Vehicle(const rapidjson::Document& d);
+
+  Vehicle(ChSystem*                  system,
+          const rapidjson::Document& d);
+
+  /// Construct the vehicle from the specified JSON document, using the provided
+  /// parsed documents for the subsystem specification files they contain (all
+  /// other subsystem files are read from disk).
+  Vehicle(const rapidjson::Document& d,
+          const DocumentMap&         subsystems);
+
   ~Vehicle() {}
 
+  /// Collect the names of all subsystem specification files referenced by the
+  /// specified vehicle JSON document (each name is listed once).
+  static void GetSubsystemFiles(const rapidjson::Document& d,
+                                std::vector<std::string>&  files);
+
   virtual int GetNumberAxles() const { return m_num_axles; }
 
   virtual ChCoordsys<> GetLocalDriverCoordsys() const { return m_driverCsys; }
@@ -55,15 +79,20 @@ public:
 private:
 
   void Create(const std::string& filename);
+  void Create(const rapidjson::Document& d);
 
-  void LoadSteering(const std::string& filename);
-  void LoadDriveline(const std::string& filename);
-  void LoadSuspension(const std::string& filename, int axle);
-  void LoadWheel(const std::string& filename, int axle, int side);
-  void LoadBrake(const std::string& filename, int axle, int side);
+  const rapidjson::Document& ReadSubsystem(const std::string& file_name, rapidjson::Document& d) const;
+
+  void LoadSteering(const std::string& file_name);
+  void LoadDriveline(const std::string& file_name);
+  void LoadSuspension(const std::string& file_name, int axle);
+  void LoadWheel(const std::string& file_name, int axle, int side);
+  void LoadBrake(const std::string& file_name, int axle, int side);
 
 private:
 
+  const DocumentMap*       m_subsystems;      // parsed subsystem files (used only during construction)
+
   int                      m_num_axles;       // number of axles for this vehicle
 
   std::vector<ChVector<> > m_suspLocations;   // locations of the suspensions relative to chassis
@@ -0,0 +1,167 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A test program comparing the batch Magic Formula evaluation
+// (ChPacejkaTire::EvaluateBatch) with the per-step evaluation in Advance().
+//
+// A tire with prescribed vertical load and kinematic slips is advanced over a
+// grid of (kappa, alpha, gamma, Fz) points. The slips actually used by the
+// Magic Formula are then evaluated in a single batch call, and the reactions
+// must agree to within a relative error of 1e-12 (absolute 1e-9 N or N.m for
+// reactions near zero).
+//
+// =============================================================================
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "physics/ChGlobal.h"
+
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/terrain/FlatTerrain.h"
+
+#include "ChronoVehicle_config.h"
+
+using namespace chrono;
+using std::cout;
+using std::endl;
+
+const std::string pacParamFile = vehicle::GetDataFile("hmmwv/pactest.tir");
+
+static const double rel_tol = 1e-12;
+static const double abs_tol = 1e-9;
+
+// -----------------------------------------------------------------------------
+// Compare the scalar and batch values of one output and report the largest
+// relative difference. Return the number of points outside the tolerance.
+// -----------------------------------------------------------------------------
+int compare(const char*                name,
+            const std::vector<double>& scalar,
+            const std::vector<double>& batch)
+{
+  int num_fail = 0;
+  double max_rel = 0;
+
+  for (size_t i = 0; i < scalar.size(); i++) {
+    double err = std::abs(scalar[i] - batch[i]);
+    double mag = std::max(std::abs(scalar[i]), std::abs(batch[i]));
+    if (err > abs_tol && err > rel_tol * mag)
+      num_fail++;
+    if (mag > 0)
+      max_rel = std::max(max_rel, err / mag);
+  }
+
+  cout << "  " << name << ":  max. relative difference = " << max_rel;
+  if (num_fail > 0)
+    cout << "  (" << num_fail << " points out of tolerance)";
+  cout << endl;
+
+  return num_fail;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  const double step_size = 0.01;
+  const double Vx = 10;
+
+  // Flat rigid terrain, height = 0 for all (x,y)
+  FlatTerrain flat_terrain(0);
+
+  // Pacejka tire with prescribed vertical load and kinematic slips, on the same
+  // side as specified in the parameter file (so that no outputs are flipped).
+  ChPacejkaTire tire("BATCH", pacParamFile, flat_terrain, 5000, false);
+  tire.Initialize(LEFT, false);
+
+  // Advance the tire through the grid of points, recording the slips used in
+  // the Magic Formula and the resulting reactions.
+  std::vector<double> kappaP, alphaP, gammaP, Fz, V_r;
+  std::vector<double> Fx, Fy, Mx, My, Mz, Fx_pure, Fy_pure, Mz_pure;
+
+  for (int iF = 0; iF < 4; iF++) {
+    double F_z = 2000 + iF * 2500;
+    tire.set_Fz_override(F_z);
+
+    for (int ig = -2; ig <= 2; ig++) {
+      double gamma = ig * 2.5 * CH_C_PI / 180;
+
+      for (int ia = -10; ia <= 10; ia++) {
+        double alpha = ia * 0.03;
+
+        for (int ik = -10; ik <= 10; ik++) {
+          double kappa = ik * 0.05;
+
+          ChWheelState state = tire.getState_from_KAG(kappa, alpha, gamma, Vx);
+          tire.Update(0, state);
+          tire.Advance(step_size);
+
+          kappaP.push_back(tire.get_kappaPrime());
+          alphaP.push_back(tire.get_alphaPrime());
+          gammaP.push_back(tire.get_gammaPrime());
+          Fz.push_back(F_z);
+          V_r.push_back(state.omega * tire.get_tire_rolling_rad());
+
+          ChTireForce combined = tire.GetTireForce_combinedSlip(true);
+          ChTireForce pure = tire.GetTireForce_pureSlip(true);
+          Fx.push_back(combined.force.x);
+          Fy.push_back(combined.force.y);
+          Mx.push_back(combined.moment.x);
+          My.push_back(combined.moment.y);
+          Mz.push_back(combined.moment.z);
+          Fx_pure.push_back(pure.force.x);
+          Fy_pure.push_back(pure.force.y);
+          Mz_pure.push_back(pure.moment.z);
+        }
+      }
+    }
+  }
+
+  // Evaluate all points in one batch call.
+  int n = (int)kappaP.size();
+  std::vector<double> b_Fx(n), b_Fy(n), b_Mx(n), b_My(n), b_Mz(n), b_Fx_pure(n), b_Fy_pure(n), b_Mz_pure(n);
+
+  ChPacejkaBatch::Inputs in = { &kappaP[0], &alphaP[0], &gammaP[0], &Fz[0], &V_r[0] };
+  ChPacejkaBatch::Outputs out = { &b_Fx[0], &b_Fy[0], &b_Mx[0], &b_My[0], &b_Mz[0],
+                                  &b_Fx_pure[0], &b_Fy_pure[0], &b_Mz_pure[0],
+                                  NULL, NULL, NULL };
+
+  if (!tire.EvaluateBatch(n, in, out)) {
+    cout << "Batch evaluation failed (tire parameters not loaded)" << endl;
+    return 1;
+  }
+
+  // Compare.
+  cout << "Compared " << n << " points" << endl;
+
+  int num_fail = 0;
+  num_fail += compare("Fx     ", Fx, b_Fx);
+  num_fail += compare("Fy     ", Fy, b_Fy);
+  num_fail += compare("Mx     ", Mx, b_Mx);
+  num_fail += compare("My     ", My, b_My);
+  num_fail += compare("Mz     ", Mz, b_Mz);
+  num_fail += compare("Fx_pure", Fx_pure, b_Fx_pure);
+  num_fail += compare("Fy_pure", Fy_pure, b_Fy_pure);
+  num_fail += compare("Mz_pure", Mz_pure, b_Mz_pure);
+
+  cout << (num_fail == 0 ? "PASSED" : "FAILED") << endl;
+
+  return (num_fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// A test program for ChPacejkaTire::Snapshot and ChPacejkaTire::Restore.
+//
+// A tire with transient slips is advanced at low speed, its state is recorded,
+// and one reference step is taken. The tire is then advanced for a number of
+// steps with different kinematic slips and speeds, restored, and the same step
+// is repeated. The combined and pure slip reactions of the repeated step must
+// match the reference step exactly.
+//
+// =============================================================================
+
+#include <cmath>
+#include <iostream>
+
+#include "physics/ChGlobal.h"
+
+#include "subsys/ChStateBuffer.h"
+#include "subsys/ChVehicleModelData.h"
+#include "subsys/tire/ChPacejkaTire.h"
+#include "subsys/terrain/FlatTerrain.h"
+
+#include "ChronoVehicle_config.h"
+
+using namespace chrono;
+using std::cout;
+using std::endl;
+
+const std::string pacParamFile = vehicle::GetDataFile("hmmwv/pactest.tir");
+
+// -----------------------------------------------------------------------------
+// Compare two sets of reactions component-wise and report any difference.
+// Return the number of components that differ.
+// -----------------------------------------------------------------------------
+int compare(const char* name, const ChTireForce& ref, const ChTireForce& val)
+{
+  const double r[6] = { ref.force.x, ref.force.y, ref.force.z, ref.moment.x, ref.moment.y, ref.moment.z };
+  const double v[6] = { val.force.x, val.force.y, val.force.z, val.moment.x, val.moment.y, val.moment.z };
+
+  int num_fail = 0;
+  for (int i = 0; i < 6; i++) {
+    if (r[i] != v[i]) {
+      cout << "  " << name << "[" << i << "]:  " << r[i] << " != " << v[i] << endl;
+      num_fail++;
+    }
+  }
+
+  return num_fail;
+}
+
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  SetChronoDataPath(CHRONO_DATA_DIR);
+
+  const double step_size = 0.001;
+  const int    num_warmup = 200;
+  const int    num_advance = 500;
+
+  // Flat rigid terrain, height = 0 for all (x,y)
+  FlatTerrain flat_terrain(0);
+
+  // Pacejka tire with prescribed vertical load and transient slips.
+  ChPacejkaTire tire("SNAPSHOT", pacParamFile, flat_terrain, 5000, true);
+  tire.Initialize(LEFT, false);
+
+  // Warm up at low speed, so that the low-speed transient slip branch is active.
+  double time = 0;
+  for (int i = 0; i < num_warmup; i++) {
+    ChWheelState state = tire.getState_from_KAG(0.05, 0.1, 0.02, 0.5);
+    tire.Update(time, state);
+    tire.Advance(step_size);
+    time += step_size;
+  }
+
+  // Record the tire state and take the reference step.
+  ChStateBuffer buffer;
+  tire.Snapshot(buffer);
+
+  ChWheelState next_state = tire.getState_from_KAG(0.05, 0.12, 0.02, 0.5);
+
+  tire.Update(time, next_state);
+  tire.Advance(step_size);
+  ChTireForce ref_combined = tire.GetTireForce_combinedSlip(true);
+  ChTireForce ref_pure = tire.GetTireForce_pureSlip(true);
+
+  // Advance the tire away from the recorded state.
+  double t = time + step_size;
+  for (int i = 0; i < num_advance; i++) {
+    double alpha = 0.2 * std::sin(0.02 * i);
+    double Vx = 0.5 + 0.05 * i;
+    ChWheelState state = tire.getState_from_KAG(-0.1, alpha, 0.0, Vx);
+    tire.Update(t, state);
+    tire.Advance(step_size);
+    t += step_size;
+  }
+
+  // Restore and repeat the reference step.
+  buffer.Rewind();
+  if (!tire.Restore(buffer) || !buffer.AtEnd()) {
+    cout << "Restore failed (incompatible state buffer)" << endl;
+    cout << "FAILED" << endl;
+    return 1;
+  }
+
+  tire.Update(time, next_state);
+  tire.Advance(step_size);
+
+  int num_fail = 0;
+  num_fail += compare("combined", ref_combined, tire.GetTireForce_combinedSlip(true));
+  num_fail += compare("pure    ", ref_pure, tire.GetTireForce_pureSlip(true));
+
+  cout << (num_fail == 0 ? "PASSED" : "FAILED") << endl;
+
+  return (num_fail == 0) ? 0 : 1;
+}
@@ -21,6 +21,11 @@
 // we will run our vehicle with default rigid tires, but calculate the output
 // for the pacjeka tire in the background
 //
+// The overturning moment Mx in the output files changed once camber and
+// lateral force were no longer swapped in the call to calc_Mx. Output files
+// written before that fix (including those of demo_HMMWV9 with Pacejka tires)
+// should not be used as a reference for Mx. All other columns are unchanged.
+//
 // =============================================================================
 
 #include <vector>
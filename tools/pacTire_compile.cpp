@@ -0,0 +1,56 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Convert a Pac2002 tire property file (.tir) to the binary parameter format,
+// which can be used in place of the .tir file when constructing a
+// ChPacejkaTire.
+//
+// Usage:  pacTire_compile input.tir output
+//
+// =============================================================================
+
+#include <string>
+#include <vector>
+
+#include "core/ChLog.h"
+
+#include "subsys/tire/ChPac2002_data.h"
+#include "subsys/tire/ChPacejkaParamFile.h"
+
+using namespace chrono;
+
+
+int main(int argc, char* argv[])
+{
+  if (argc != 3) {
+    GetLog() << "Usage: pacTire_compile input.tir output \n";
+    return 1;
+  }
+
+  Pac2002_data params;
+
+  if (!ChPacejkaParamFile::Read(argv[1], params)) {
+    GetLog() << " could not load tire parameters from " << argv[1] << "\n";
+    return 1;
+  }
+
+  if (!ChPacejkaParamFile::WriteBinary(argv[2], params)) {
+    GetLog() << " could not write binary tire parameters to " << argv[2] << "\n";
+    return 1;
+  }
+
+  GetLog() << "Wrote " << argv[2] << "\n";
+
+  return 0;
+}
@@ -16,14 +16,406 @@
 //
 // =============================================================================
 
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
 #include "assets/ChColorAsset.h"
 
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/internal/dtoa.h"
+#include "rapidjson/internal/itoa.h"
+
 #include "utils/ChUtilsInputOutput.h"
 
 namespace chrono {
 namespace utils {
 
 
+// -----------------------------------------------------------------------------
+// CSV_writer
+// -----------------------------------------------------------------------------
+// Handshake between the producer and the background writer thread: a single
+// mutex protects m_pending and m_stop, and a single condition variable is
+// signaled whenever either of them changes.
+struct CSV_writer::ThreadData {
+#ifdef _WIN32
+  HANDLE             handle;
+  CRITICAL_SECTION   mutex;
+  CONDITION_VARIABLE cond;
+
+  ThreadData()  { InitializeCriticalSection(&mutex); InitializeConditionVariable(&cond); }
+  ~ThreadData() { DeleteCriticalSection(&mutex); }
+
+  void Lock()      { EnterCriticalSection(&mutex); }
+  void Unlock()    { LeaveCriticalSection(&mutex); }
+  void Wait()      { SleepConditionVariableCS(&cond, &mutex, INFINITE); }
+  void Broadcast() { WakeAllConditionVariable(&cond); }
+
+  static DWORD WINAPI Run(LPVOID arg) { CSV_writer::thread_func(arg); return 0; }
+#else
+  pthread_t          handle;
+  pthread_mutex_t    mutex;
+  pthread_cond_t     cond;
+
+  ThreadData()  { pthread_mutex_init(&mutex, NULL); pthread_cond_init(&cond, NULL); }
+  ~ThreadData() { pthread_cond_destroy(&cond); pthread_mutex_destroy(&mutex); }
+
+  void Lock()      { pthread_mutex_lock(&mutex); }
+  void Unlock()    { pthread_mutex_unlock(&mutex); }
+  void Wait()      { pthread_cond_wait(&cond, &mutex); }
+  void Broadcast() { pthread_cond_broadcast(&cond); }
+#endif
+};
+
+CSV_writer::CSV_writer(const std::string& delim)
+: m_delim(delim),
+  m_chunk_size(0),
+  m_pending(false),
+  m_stop(false),
+  m_background(false),
+  m_thread(new ThreadData)
+{
+}
+
+CSV_writer::CSV_writer(const CSV_writer& source)
+: m_delim(source.m_delim),
+  m_chunk_size(0),
+  m_pending(false),
+  m_stop(false),
+  m_background(false),
+  m_thread(new ThreadData)
+{
+  m_ss.copyfmt(source.m_ss);          // copy all formatting flags
+  m_ss.clear(source.m_ss.rdstate());  // copy the error state
+}
+
+CSV_writer::~CSV_writer()
+{
+  close();
+  delete m_thread;
+}
+
+void CSV_writer::write_to_file(const std::string& filename,
+                               const std::string& header)
+{
+  std::ofstream ofile(filename.c_str());
+  ofile << header;
+  ofile << m_buf;
+  ofile.close();
+}
+
+bool CSV_writer::open(const std::string& filename,
+                      const std::string& header,
+                      size_t             chunk_size,
+                      bool               background)
+{
+  close();
+
+  m_file.open(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!m_file)
+    return false;
+
+  m_file << header;
+
+  m_chunk_size = chunk_size;
+  m_buf.reserve(chunk_size + 256);
+  m_back.reserve(chunk_size + 256);
+  m_pending = false;
+  m_stop = false;
+
+  if (background) {
+#ifdef _WIN32
+    m_thread->handle = CreateThread(NULL, 0, ThreadData::Run, this, 0, NULL);
+    m_background = (m_thread->handle != NULL);
+#else
+    m_background = (pthread_create(&m_thread->handle, NULL, thread_func, this) == 0);
+#endif
+  }
+
+  // Output written before opening the file goes first.
+  if (!m_buf.empty() && m_buf.size() >= m_chunk_size)
+    write_chunk();
+
+  return true;
+}
+
+void CSV_writer::flush()
+{
+  if (!m_file.is_open())
+    return;
+
+  // Wait for the chunk currently handled by the background thread.
+  if (m_background) {
+    m_thread->Lock();
+    while (m_pending)
+      m_thread->Wait();
+    m_thread->Unlock();
+  }
+
+  m_file << m_buf;
+  m_file.flush();
+  m_buf.clear();
+}
+
+void CSV_writer::close()
+{
+  if (!m_file.is_open())
+    return;
+
+  if (m_background) {
+    m_thread->Lock();
+    while (m_pending)
+      m_thread->Wait();
+    m_stop = true;
+    m_thread->Broadcast();
+    m_thread->Unlock();
+#ifdef _WIN32
+    WaitForSingleObject(m_thread->handle, INFINITE);
+    CloseHandle(m_thread->handle);
+#else
+    pthread_join(m_thread->handle, NULL);
+#endif
+    m_background = false;
+  }
+
+  flush();
+  m_file.close();
+}
+
+// Hand over a full chunk. With a background thread, the producer only waits if
+// the previous chunk is still being written; the buffers are then swapped.
+void CSV_writer::write_chunk()
+{
+  if (!m_background) {
+    m_file << m_buf;
+    if (m_chunk_size == 0)
+      m_file.flush();
+    m_buf.clear();
+    return;
+  }
+
+  m_thread->Lock();
+  while (m_pending)
+    m_thread->Wait();
+  m_back.swap(m_buf);
+  m_pending = true;
+  m_thread->Broadcast();
+  m_thread->Unlock();
+
+  m_buf.clear();
+}
+
+void* CSV_writer::thread_func(void* arg)
+{
+  static_cast<CSV_writer*>(arg)->drain();
+  return NULL;
+}
+
+// Sleep until a chunk is handed over (or a stop is requested), and write it
+// to the file outside the lock, so that the producer can keep filling m_buf.
+void CSV_writer::drain()
+{
+  m_thread->Lock();
+
+  while (true) {
+    if (m_pending) {
+      m_thread->Unlock();
+      m_file << m_back;
+      if (m_chunk_size == 0)
+        m_file.flush();
+      m_thread->Lock();
+      m_pending = false;
+      m_thread->Broadcast();
+      continue;
+    }
+    if (m_stop)
+      break;
+    m_thread->Wait();
+  }
+
+  m_thread->Unlock();
+}
+
+void CSV_writer::append_delim()
+{
+  m_buf += m_delim;
+  if (m_chunk_size > 0 && m_file.is_open() && m_buf.size() >= m_chunk_size)
+    write_chunk();
+}
+
+void CSV_writer::append_formatted()
+{
+  // Manipulators taking arguments (e.g. std::setprecision) produce no output
+  // and are not followed by a delimiter.
+  if (m_ss.tellp() == std::streampos(0))
+    return;
+
+  m_buf += m_ss.str();
+  m_ss.str("");
+  append_delim();
+}
+
+// With a chunk size of 0, a row is written (and the file flushed) as soon as it
+// is ended.
+void CSV_writer::append_manip()
+{
+  m_buf += m_ss.str();
+  m_ss.str("");
+  if (!m_file.is_open() || m_buf.empty())
+    return;
+  if (m_chunk_size == 0 ? m_buf[m_buf.size() - 1] == '\n' : m_buf.size() >= m_chunk_size)
+    write_chunk();
+}
+
+// Floating point values are formatted with sprintf, using the conversion that
+// iostream would use for the current format flags and precision. The Grisu2
+// output (only used for round-trip precision) is adjusted to match the iostream
+// conventions for signed zero and integral values ("-0", "1"). A pending field
+// width, hexadecimal format, or a precision too large for the local buffer
+// fall back to iostream formatting, as do std::showpos and std::showpoint at
+// round-trip precision (which Grisu2 does not support).
+CSV_writer& CSV_writer::operator<<(double t)
+{
+  std::ios_base::fmtflags flags = m_ss.flags();
+  std::ios_base::fmtflags floatfield = flags & std::ios::floatfield;
+  std::streamsize precision = m_ss.precision();
+  bool shortest = (!floatfield && precision >= 17);
+
+  if (m_ss.width() != 0 || floatfield == std::ios::floatfield || precision > 160 ||
+      (shortest && (flags & (std::ios::showpos | std::ios::showpoint)))) {
+    m_ss << t;
+    append_formatted();
+    return *this;
+  }
+
+  if (!shortest) {
+    bool upper = (flags & std::ios::uppercase) != 0;
+    char format[8];
+    char* f = format;
+    *f++ = '%';
+    if (flags & std::ios::showpos)
+      *f++ = '+';
+    if (flags & std::ios::showpoint)
+      *f++ = '#';
+    *f++ = '.';
+    *f++ = '*';
+    if (floatfield == std::ios::fixed)
+      *f++ = 'f';
+    else if (floatfield == std::ios::scientific)
+      *f++ = upper ? 'E' : 'e';
+    else
+      *f++ = upper ? 'G' : 'g';
+    *f = 0;
+
+    // Large enough for fixed format: sign, 309 integral digits, point, and
+    // up to 160 decimals.
+    char buffer[512];
+    int len = sprintf(buffer, format, (int)precision, t);
+    m_buf.append(buffer, len);
+    append_delim();
+    return *this;
+  }
+
+  char buffer[32];
+  char* end;
+
+  if (t != t)
+    end = std::strcpy(buffer, "nan") + 3;
+  else if (t > (std::numeric_limits<double>::max)())
+    end = std::strcpy(buffer, "inf") + 3;
+  else if (t < -(std::numeric_limits<double>::max)())
+    end = std::strcpy(buffer, "-inf") + 4;
+  else if (t == 0)
+    end = (1 / t < 0) ? std::strcpy(buffer, "-0") + 2 : std::strcpy(buffer, "0") + 1;
+  else {
+    end = rapidjson::internal::dtoa(t, buffer);
+    if (end - buffer > 2 && end[-2] == '.' && end[-1] == '0')
+      end -= 2;
+  }
+
+  m_buf.append(buffer, end - buffer);
+  append_delim();
+  return *this;
+}
+
+// Integers are converted with rapidjson only in the default format (decimal,
+// no field width, no sign for positive values); otherwise iostream is used.
+bool CSV_writer::plain_integer() const
+{
+  std::ios_base::fmtflags base = m_ss.flags() & std::ios::basefield;
+  return m_ss.width() == 0 &&
+         (base == std::ios::dec || base == 0) &&
+         !(m_ss.flags() & std::ios::showpos);
+}
+
+CSV_writer& CSV_writer::operator<<(int t)
+{
+  if (!plain_integer()) {
+    m_ss << t;
+    append_formatted();
+    return *this;
+  }
+
+  char buffer[16];
+  char* end = rapidjson::internal::i32toa(t, buffer);
+  m_buf.append(buffer, end - buffer);
+  append_delim();
+  return *this;
+}
+
+CSV_writer& CSV_writer::operator<<(unsigned int t)
+{
+  if (!plain_integer()) {
+    m_ss << t;
+    append_formatted();
+    return *this;
+  }
+
+  char buffer[16];
+  char* end = rapidjson::internal::u32toa(t, buffer);
+  m_buf.append(buffer, end - buffer);
+  append_delim();
+  return *this;
+}
+
+CSV_writer& CSV_writer::operator<<(long t)
+{
+  if (!plain_integer()) {
+    m_ss << t;
+    append_formatted();
+    return *this;
+  }
+
+  char buffer[24];
+  char* end = rapidjson::internal::i64toa(t, buffer);
+  m_buf.append(buffer, end - buffer);
+  append_delim();
+  return *this;
+}
+
+CSV_writer& CSV_writer::operator<<(unsigned long t)
+{
+  if (!plain_integer()) {
+    m_ss << t;
+    append_formatted();
+    return *this;
+  }
+
+  char buffer[24];
+  char* end = rapidjson::internal::u64toa(t, buffer);
+  m_buf.append(buffer, end - buffer);
+  append_delim();
+  return *this;
+}
+
+
 // -----------------------------------------------------------------------------
 // WriteBodies
 //
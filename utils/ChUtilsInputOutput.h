@@ -39,42 +39,104 @@ namespace utils {
 // CSV_writer
 //
 // Simple class to output to a Comma-Separated Values file.
+//
+// By default, all output is accumulated in memory and written at once with
+// write_to_file(). Alternatively, open() switches the writer to streaming
+// mode, in which the output is appended to the open file in chunks of fixed
+// size, optionally from a background thread, so that memory use is bounded.
+//
+// Floating point values are formatted as with iostream (6 significant digits by
+// default), honouring std::setprecision, std::fixed, and std::scientific, but
+// converted directly with sprintf rather than through the string stream.
+// Inserting std::setprecision(17) (or higher) without a fixed or scientific
+// format selects the shortest round-trip representation, computed with the
+// (much faster) Grisu2 algorithm from rapidjson; this is the only case in which
+// floating point output is faster than with iostream. Integers are formatted
+// with the rapidjson integer conversion routines, unless a field width,
+// std::showpos, or a non-decimal base is set; all other types go through
+// iostream formatting.
 // -----------------------------------------------------------------------------
 class CH_UTILS_API CSV_writer {
 public:
-  explicit CSV_writer(const std::string& delim = ",") : m_delim(delim) {}
+  explicit CSV_writer(const std::string& delim = ",");
 
-  CSV_writer(const CSV_writer& source) : m_delim(source.m_delim)
-  {
-    // Note that we do not copy the stream buffer (as then it would be shared!)
-    m_ss.copyfmt(source.m_ss);          // copy all data
-    m_ss.clear(source.m_ss.rdstate());  // copy the error state
-  }
+  // Note that we do not copy the buffered output or the output file.
+  CSV_writer(const CSV_writer& source);
 
-  ~CSV_writer() {}
+  ~CSV_writer();
 
+  // Write the buffered output to the specified file (buffered mode only).
   void write_to_file(const std::string& filename,
-                     const std::string& header = "")
-  {
-    std::ofstream ofile(filename.c_str());
-    ofile << header;
-    ofile << m_ss.str();
-    ofile.close();
-  }
+                     const std::string& header = "");
+
+  // Switch to streaming mode: create the specified file, write the header,
+  // and from now on append the output whenever 'chunk_size' bytes have been
+  // accumulated. A 'chunk_size' of 0 writes and flushes each row as soon as it
+  // is ended with std::endl. If 'background' is true, the file writes are
+  // performed by a separate thread while the next chunk is being filled.
+  bool open(const std::string& filename,
+            const std::string& header = "",
+            size_t             chunk_size = 65536,
+            bool               background = false);
+
+  // Write all pending output to the file (streaming mode only).
+  void flush();
+
+  // Flush and close the output file, returning to buffered mode.
+  void close();
+
+  bool is_streaming() const { return m_file.is_open(); }
 
   const std::string&  delim() const { return m_delim; }
+
+  // Deprecated: the formatting stream. Output is no longer accumulated in it,
+  // so it should only be used to change the formatting state (e.g. precision);
+  // text inserted directly into it is not written. Use the insertion operators.
   std::ostringstream& stream() { return m_ss; }
 
   template <typename T>
-  CSV_writer& operator<< (const T& t)                          { m_ss << t << m_delim; return *this; }
-
-  CSV_writer& operator<<(std::ostream& (*t)(std::ostream&))    { m_ss << t; return *this; }
-  CSV_writer& operator<<(std::ios& (*t)(std::ios&))            { m_ss << t; return *this; }
-  CSV_writer& operator<<(std::ios_base& (*t)(std::ios_base&))  { m_ss << t; return *this; }
+  CSV_writer& operator<< (const T& t)                          { m_ss << t; append_formatted(); return *this; }
+
+  CSV_writer& operator<<(double t);
+  CSV_writer& operator<<(float t)                              { return *this << (double)t; }
+  CSV_writer& operator<<(int t);
+  CSV_writer& operator<<(unsigned int t);
+  CSV_writer& operator<<(long t);
+  CSV_writer& operator<<(unsigned long t);
+  CSV_writer& operator<<(bool t)                               { return *this << (int)t; }
+  CSV_writer& operator<<(char t)                               { m_buf += t; append_delim(); return *this; }
+  CSV_writer& operator<<(const char* t)                        { m_buf += t; append_delim(); return *this; }
+  CSV_writer& operator<<(const std::string& t)                 { m_buf += t; append_delim(); return *this; }
+
+  CSV_writer& operator<<(std::ostream& (*t)(std::ostream&))    { m_ss << t; append_manip(); return *this; }
+  CSV_writer& operator<<(std::ios& (*t)(std::ios&))            { m_ss << t; append_manip(); return *this; }
+  CSV_writer& operator<<(std::ios_base& (*t)(std::ios_base&))  { m_ss << t; append_manip(); return *this; }
 
 private:
-  std::string m_delim;
-  std::ostringstream m_ss;
+  struct ThreadData;
+
+  // Not implemented (a writer cannot share its output file or thread).
+  CSV_writer& operator=(const CSV_writer& source);
+
+  bool plain_integer() const;
+  void append_formatted();
+  void append_manip();
+  void append_delim();
+  void write_chunk();
+  void drain();
+  static void* thread_func(void* arg);
+
+  std::string         m_delim;
+  std::string         m_buf;          // pending output
+  std::ostringstream  m_ss;           // formatting of other types and manipulators
+
+  std::ofstream       m_file;         // output file (streaming mode)
+  size_t              m_chunk_size;   // chunk size (streaming mode)
+  std::string         m_back;         // chunk being written by the background thread
+  bool                m_pending;      // m_back contains a chunk to be written (guarded by m_thread)
+  bool                m_stop;         // request to stop the background thread (guarded by m_thread)
+  bool                m_background;   // background thread running?
+  ThreadData*         m_thread;       // platform-specific thread handle
 };
 
 inline CSV_writer& operator<< (CSV_writer& out, const ChVector<>& v)
@@ -0,0 +1,295 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Binary columnar time-series files.
+//
+// =============================================================================
+
+#include <cstring>
+
+#include "utils/ChUtilsTimeSeries.h"
+
+namespace chrono {
+namespace utils {
+
+
+static const char         TS_MAGIC[4] = { 'C', 'H', 'T', 'S' };
+static const char         TS_BLOCK[4] = { 'B', 'L', 'C', 'K' };
+static const unsigned int TS_VERSION = 1;
+
+
+// -----------------------------------------------------------------------------
+// Helpers for reading and writing binary values.
+// -----------------------------------------------------------------------------
+template <typename T>
+static void WriteValue(std::ostream& os, const T& val)
+{
+  os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template <typename T>
+static bool ReadValue(std::istream& is, T& val)
+{
+  is.read(reinterpret_cast<char*>(&val), sizeof(T));
+  return is.good();
+}
+
+static void WriteString(std::ostream& os, const std::string& str)
+{
+  unsigned short len = (unsigned short)str.size();
+  WriteValue(os, len);
+  os.write(str.c_str(), len);
+}
+
+static bool ReadString(std::istream& is, std::string& str)
+{
+  unsigned short len;
+  if (!ReadValue(is, len))
+    return false;
+  str.resize(len);
+  if (len > 0)
+    is.read(&str[0], len);
+  return is.good();
+}
+
+static size_t TypeSize(unsigned char type)
+{
+  return (type == ChTimeSeriesWriter::FLOAT32) ? sizeof(float) : sizeof(double);
+}
+
+
+// -----------------------------------------------------------------------------
+// ChTimeSeriesWriter
+// -----------------------------------------------------------------------------
+ChTimeSeriesWriter::ChTimeSeriesWriter(int block_size)
+: m_block_size(block_size > 0 ? block_size : 1),
+  m_block_rows(0),
+  m_num_rows(0)
+{
+}
+
+ChTimeSeriesWriter::~ChTimeSeriesWriter()
+{
+  Close();
+}
+
+int ChTimeSeriesWriter::AddChannel(const std::string& name,
+                                   const std::string& units,
+                                   DataType           type)
+{
+  if (m_file.is_open())
+    return -1;
+
+  m_names.push_back(name);
+  m_units.push_back(units);
+  m_types.push_back(type);
+
+  return (int)m_names.size() - 1;
+}
+
+bool ChTimeSeriesWriter::Open(const std::string& filename)
+{
+  m_file.open(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!m_file)
+    return false;
+
+  unsigned int num_channels = (unsigned int)m_names.size();
+
+  m_file.write(TS_MAGIC, 4);
+  WriteValue(m_file, TS_VERSION);
+  WriteValue(m_file, num_channels);
+
+  for (unsigned int i = 0; i < num_channels; i++) {
+    unsigned char type = (unsigned char)m_types[i];
+    WriteValue(m_file, type);
+    WriteString(m_file, m_names[i]);
+    WriteString(m_file, m_units[i]);
+  }
+
+  m_block.resize((size_t)m_block_size * num_channels);
+  m_float_buf.resize(m_block_size);
+  m_block_rows = 0;
+  m_num_rows = 0;
+
+  return m_file.good();
+}
+
+void ChTimeSeriesWriter::AppendRow(const double* values)
+{
+  if (!m_file.is_open())
+    return;
+
+  size_t num_channels = m_names.size();
+  for (size_t i = 0; i < num_channels; i++)
+    m_block[i * m_block_size + m_block_rows] = values[i];
+
+  m_num_rows++;
+
+  if (++m_block_rows == m_block_size)
+    Flush();
+}
+
+void ChTimeSeriesWriter::Flush()
+{
+  if (!m_file.is_open() || m_block_rows == 0)
+    return;
+
+  unsigned int num_rows = (unsigned int)m_block_rows;
+
+  m_file.write(TS_BLOCK, 4);
+  WriteValue(m_file, num_rows);
+
+  for (size_t i = 0; i < m_names.size(); i++) {
+    const double* column = &m_block[i * m_block_size];
+    if (m_types[i] == FLOAT32) {
+      for (int j = 0; j < m_block_rows; j++)
+        m_float_buf[j] = (float)column[j];
+      m_file.write(reinterpret_cast<const char*>(&m_float_buf[0]), m_block_rows * sizeof(float));
+    }
+    else {
+      m_file.write(reinterpret_cast<const char*>(column), m_block_rows * sizeof(double));
+    }
+  }
+
+  m_file.flush();
+  m_block_rows = 0;
+}
+
+void ChTimeSeriesWriter::Close()
+{
+  if (!m_file.is_open())
+    return;
+
+  Flush();
+  m_file.close();
+}
+
+
+// -----------------------------------------------------------------------------
+// Reading functions
+// -----------------------------------------------------------------------------
+bool IsTimeSeriesFile(const std::string& filename)
+{
+  std::ifstream ifile(filename.c_str(), std::ios::in | std::ios::binary);
+  char magic[4];
+
+  ifile.read(magic, 4);
+
+  return ifile.good() && std::memcmp(magic, TS_MAGIC, 4) == 0;
+}
+
+// The file is traversed twice: first the block headers are visited (seeking
+// over the column data) to find the total number of rows, then the columns are
+// read directly into the preallocated output vectors.
+size_t ReadTimeSeries(const std::string& filename,
+                      Headers&           headers,
+                      Headers&           units,
+                      Data&              data)
+{
+  std::ifstream ifile(filename.c_str(), std::ios::in | std::ios::binary);
+
+  char         magic[4];
+  unsigned int version;
+  unsigned int num_channels;
+
+  ifile.read(magic, 4);
+  if (!ifile.good() || std::memcmp(magic, TS_MAGIC, 4) != 0) {
+    std::cout << "ERROR: " << filename << " is not a time-series file" << std::endl;
+    return 0;
+  }
+
+  if (!ReadValue(ifile, version) || version > TS_VERSION || !ReadValue(ifile, num_channels)) {
+    std::cout << "ERROR: unsupported time-series file " << filename << std::endl;
+    return 0;
+  }
+
+  std::vector<unsigned char> types(num_channels);
+  size_t row_size = 0;
+
+  headers.resize(num_channels);
+  units.resize(num_channels);
+  for (unsigned int i = 0; i < num_channels; i++) {
+    if (!ReadValue(ifile, types[i]) || !ReadString(ifile, headers[i]) || !ReadString(ifile, units[i])) {
+      std::cout << "ERROR: corrupted header in " << filename << std::endl;
+      return 0;
+    }
+    row_size += TypeSize(types[i]);
+  }
+
+  std::streamoff data_start = ifile.tellg();
+
+  ifile.seekg(0, std::ios::end);
+  std::streamoff file_size = ifile.tellg();
+  ifile.seekg(data_start);
+
+  // First pass: count rows in complete blocks.
+  size_t total_rows = 0;
+  std::streamoff pos = data_start;
+  while (pos + 8 <= file_size) {
+    unsigned int num_rows;
+    ifile.read(magic, 4);
+    if (std::memcmp(magic, TS_BLOCK, 4) != 0 || !ReadValue(ifile, num_rows))
+      break;
+    std::streamoff end = pos + 8 + (std::streamoff)num_rows * (std::streamoff)row_size;
+    if (end > file_size)
+      break;
+    total_rows += num_rows;
+    pos = end;
+    ifile.seekg(pos);
+  }
+
+  data.resize(num_channels);
+  for (unsigned int i = 0; i < num_channels; i++)
+    data[i].resize(total_rows);
+
+  // Second pass: read the columns.
+  ifile.clear();
+  ifile.seekg(data_start);
+
+  std::vector<float> float_buf;
+  size_t row = 0;
+
+  while (row < total_rows) {
+    unsigned int num_rows;
+    ifile.read(magic, 4);
+    ReadValue(ifile, num_rows);
+    if (num_rows == 0)
+      continue;
+
+    for (unsigned int i = 0; i < num_channels; i++) {
+      if (types[i] == ChTimeSeriesWriter::FLOAT32) {
+        float_buf.resize(num_rows);
+        ifile.read(reinterpret_cast<char*>(&float_buf[0]), num_rows * sizeof(float));
+        for (unsigned int j = 0; j < num_rows; j++)
+          data[i][row + j] = float_buf[j];
+      }
+      else {
+        ifile.read(reinterpret_cast<char*>(&data[i][row]), num_rows * sizeof(double));
+      }
+    }
+
+    if (!ifile.good()) {
+      std::cout << "ERROR: truncated block in " << filename << std::endl;
+      break;
+    }
+
+    row += num_rows;
+  }
+
+  return row;
+}
+
+
+} // namespace utils
+} // namespace chrono
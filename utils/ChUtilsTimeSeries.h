@@ -0,0 +1,136 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All right reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Authors: Radu Serban
+// =============================================================================
+//
+// Binary columnar time-series files.
+//
+// File layout (all integers unsigned, in host byte order, i.e. little-endian
+// on all supported platforms):
+//
+//   Header
+//     char[4]    magic "CHTS"
+//     uint32     format version (currently 1)
+//     uint32     number of channels N
+//     N times:
+//       uint8    data type (0: float64, 1: float32)
+//       uint16   length of channel name, followed by the name characters
+//       uint16   length of channel units, followed by the units characters
+//
+//   Blocks (zero or more, appended until the end of the file)
+//     char[4]    magic "BLCK"
+//     uint32     number of rows R in this block
+//     N times:
+//       R values of the channel data type (one column)
+//
+// By convention, the first channel contains the time values. Since blocks are
+// self-contained, a file truncated after the last complete block is valid.
+//
+// =============================================================================
+
+#ifndef CH_UTILS_TIMESERIES_H
+#define CH_UTILS_TIMESERIES_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+
+#include "utils/ChApiUtils.h"
+#include "utils/ChUtilsValidation.h"
+
+
+namespace chrono {
+namespace utils {
+
+
+// -----------------------------------------------------------------------------
+// ChTimeSeriesWriter
+//
+// Streaming writer for binary time-series files. Rows are buffered and
+// written as one block whenever the buffer is full (and on Flush/Close).
+// -----------------------------------------------------------------------------
+class CH_UTILS_API ChTimeSeriesWriter {
+public:
+
+  /// Data type of a channel.
+  enum DataType {
+    FLOAT64 = 0,
+    FLOAT32 = 1
+  };
+
+  explicit ChTimeSeriesWriter(int block_size = 1024);
+  ~ChTimeSeriesWriter();
+
+  /// Add a channel. All channels must be added before opening the file.
+  /// Return the channel index, or -1 if the file is already open.
+  int AddChannel(
+    const std::string& name,               ///< [in] channel name
+    const std::string& units = "",         ///< [in] channel units
+    DataType           type = FLOAT64      ///< [in] data type in the file
+    );
+
+  /// Create the output file and write the header.
+  bool Open(const std::string& filename);
+
+  /// Append a row with one value for each channel.
+  void AppendRow(const double* values);
+
+  /// Write all buffered rows as a block.
+  void Flush();
+
+  /// Flush and close the output file.
+  void Close();
+
+  /// Return the number of channels.
+  int GetNumChannels() const { return (int)m_names.size(); }
+
+  /// Return the total number of rows appended so far.
+  size_t GetNumRows() const { return m_num_rows; }
+
+private:
+
+  std::vector<std::string>  m_names;
+  std::vector<std::string>  m_units;
+  std::vector<DataType>     m_types;
+
+  std::ofstream             m_file;
+  int                       m_block_size;   ///< number of rows per block
+  int                       m_block_rows;   ///< number of rows in the current block
+  std::vector<double>       m_block;        ///< block buffer (column-major)
+  std::vector<float>        m_float_buf;    ///< conversion buffer for float32 columns
+  size_t                    m_num_rows;
+};
+
+
+// -----------------------------------------------------------------------------
+// Free function declarations
+// -----------------------------------------------------------------------------
+
+/// Return true if the specified file is a binary time-series file.
+CH_UTILS_API
+bool IsTimeSeriesFile(const std::string& filename);
+
+/// Read a binary time-series file.
+/// On return, 'headers' contains the channel names, 'units' the channel units,
+/// and 'data' one column per channel. The return value is the number of rows.
+CH_UTILS_API
+size_t ReadTimeSeries(const std::string& filename,
+                      Headers&           headers,
+                      Headers&           units,
+                      Data&              data);
+
+
+} // namespace utils
+} // namespace chrono
+
+
+#endif
@@ -17,6 +17,7 @@
 // =============================================================================
 
 #include "utils/ChUtilsValidation.h"
+#include "utils/ChUtilsTimeSeries.h"
 
 namespace chrono {
 namespace utils {
@@ -128,6 +129,12 @@ size_t ChValidation::ReadDataFile(const std::string& filename,
                                   Headers&           headers,
                                   Data&              data)
 {
+  // Binary time-series files do not require any text parsing.
+  if (IsTimeSeriesFile(filename)) {
+    Headers units;
+    return ReadTimeSeries(filename, headers, units, data);
+  }
+
   std::ifstream ifile(filename.c_str());
   std::string   line;
 
@@ -114,7 +114,9 @@ public:
   const DataVector& GetINFnorms() const { return m_INF_norms; }
 
   /// Read the specified data file.
-  /// The file is assumed to be delimited by the specified character.
+  /// Binary time-series files (see ChUtilsTimeSeries.h) are detected and read
+  /// directly, in which case the delimiter is ignored. Otherwise, the file is
+  /// assumed to be delimited by the specified character.
   /// The return value is the actual number of data points read from the file.
   static size_t ReadDataFile(
     const std::string& filename,        ///< [in] name of the data file